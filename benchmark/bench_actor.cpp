@@ -7,11 +7,13 @@
 #include "td/utils/benchmark.h"
 
 #include "td/actor/actor.h"
+#include "td/actor/impl2/Scheduler.h"
 #include "td/actor/PromiseFuture.h"
 
 #include "td/utils/logging.h"
 
 #include <algorithm>
+#include <memory>
 
 #if TD_MSVC
 #pragma comment(linker, "/STACK:16777216")
@@ -266,6 +268,78 @@ class QueryBench : public td::Benchmark {
   td::ActorOwn<ServerActor> server_;
 };
 
+#if !TD_THREAD_UNSUPPORTED && !TD_EVENTFD_UNSUPPORTED
+// the same ring as RingBench, but on the work-stealing scheduler from td/actor/impl2
+class Ring2Bench : public td::Benchmark {
+ public:
+  struct PassActor : public td::actor2::Actor {
+    td::actor2::ActorId<PassActor> next_actor;
+
+    void set_next_actor(td::actor2::ActorId<PassActor> actor) {
+      next_actor = std::move(actor);
+    }
+
+    void pass(int n) {
+      if (n == 0) {
+        td::actor2::SchedulerContext::get()->stop();
+      } else {
+        send_closure(next_actor, &PassActor::pass, n - 1);
+      }
+    }
+  };
+
+  Ring2Bench(int actor_n, int thread_n) : actor_n_(actor_n), thread_n_(thread_n) {
+  }
+
+  std::string get_description() const override {
+    return PSTRING("Ring2 (send_closure) (cpu_threads_n = %d)", thread_n_);
+  }
+
+  void start_up() override {
+    group_info_ = std::make_shared<td::actor2::SchedulerGroupInfo>(1);
+    scheduler_ = std::make_unique<td::actor2::Scheduler>(group_info_, td::actor2::SchedulerId{0}, thread_n_);
+    scheduler_->start();
+
+    scheduler_->run_in_context([&] {
+      actor_array_ = std::vector<td::actor2::ActorId<PassActor>>(actor_n_);
+      for (auto &actor : actor_array_) {
+        auto options = td::actor2::ActorOptions().with_name("PassActor");
+        if (thread_n_ == 0) {
+          // there are no CPU workers, so all actors must be run by the IO worker
+          options.with_poll();
+        }
+        actor = td::actor2::create_actor<PassActor>(options).release();
+      }
+      for (int i = 0; i < actor_n_; i++) {
+        send_closure(actor_array_[i], &PassActor::set_next_actor, actor_array_[(i + 1) % actor_n_]);
+      }
+    });
+  }
+
+  void run(int n) override {
+    scheduler_->run_in_context([&] { send_closure(actor_array_[0], &PassActor::pass, std::max(n, 100)); });
+    while (scheduler_->run(10)) {
+      // empty
+    }
+  }
+
+  void tear_down() override {
+    // actor identifiers must be released in the scheduler context
+    scheduler_->run_in_context([&] { actor_array_.clear(); });
+    td::actor2::Scheduler::close_scheduler_group(*group_info_);
+    scheduler_.reset();
+    group_info_.reset();
+  }
+
+ private:
+  int actor_n_;
+  int thread_n_;
+  std::shared_ptr<td::actor2::SchedulerGroupInfo> group_info_;
+  std::unique_ptr<td::actor2::Scheduler> scheduler_;
+  std::vector<td::actor2::ActorId<PassActor>> actor_array_;
+};
+#endif
+
 int main() {
   SET_VERBOSITY_LEVEL(VERBOSITY_NAME(DEBUG));
   bench(RingBench<4>(504, 0));
@@ -286,5 +360,10 @@ int main() {
   bench(RingBench<0>(504, 2));
   bench(RingBench<1>(504, 2));
   bench(RingBench<2>(504, 2));
+#if !TD_THREAD_UNSUPPORTED && !TD_EVENTFD_UNSUPPORTED
+  bench(Ring2Bench(504, 0));
+  bench(Ring2Bench(504, 2));
+  bench(Ring2Bench(504, 10));
+#endif
   return 0;
 }
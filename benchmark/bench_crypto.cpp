@@ -6,12 +6,18 @@
 //
 #include "td/utils/benchmark.h"
 
+#include "td/mtproto/AuthKey.h"
+#include "td/mtproto/CryptoWorkerPool.h"
+#include "td/mtproto/Transport.h"
+
+#include "td/utils/buffer.h"
 #include "td/utils/crypto.h"
 #include "td/utils/int_types.h"
 #include "td/utils/logging.h"
 #include "td/utils/port/thread.h"
 #include "td/utils/Random.h"
 #include "td/utils/Slice.h"
+#include "td/utils/Storer.h"
 
 #include <openssl/sha.h>
 
@@ -19,6 +25,7 @@
 #include <atomic>
 #include <cstdint>
 #include <cstdlib>
+#include <memory>
 #include <random>
 #include <string>
 #include <vector>
@@ -55,7 +62,7 @@ class AESBench : public td::Benchmark {
   td::UInt256 iv;
 
   std::string get_description() const override {
-    return PSTRING("AES OpenSSL [%dKB]", DATA_SIZE >> 10);
+    return PSTRING("AES-IGE [%dKB]", DATA_SIZE >> 10);
   }
 
   void start_up() override {
@@ -74,6 +81,185 @@ class AESBench : public td::Benchmark {
   }
 };
 
+template <bool use_batch>
+class AesIgeBatchBench : public td::Benchmark {
+ public:
+  static constexpr int STREAM_COUNT = 16;
+  alignas(64) unsigned char data[STREAM_COUNT][DATA_SIZE];
+  td::UInt256 keys[STREAM_COUNT];
+  td::UInt256 ivs[STREAM_COUNT];
+  std::vector<td::AesIgeTask> tasks;
+
+  std::string get_description() const override {
+    return PSTRING("AES-IGE %d streams %s [%dKB]", STREAM_COUNT, use_batch ? "batched" : "one by one",
+                   DATA_SIZE >> 10);
+  }
+
+  void start_up() override {
+    tasks.clear();
+    for (int i = 0; i < STREAM_COUNT; i++) {
+      for (int j = 0; j < DATA_SIZE; j++) {
+        data[i][j] = 123;
+      }
+      td::Random::secure_bytes(keys[i].raw, sizeof(keys[i]));
+      td::Random::secure_bytes(ivs[i].raw, sizeof(ivs[i]));
+      td::MutableSlice data_slice(data[i], DATA_SIZE);
+      tasks.push_back(td::AesIgeTask{&keys[i], &ivs[i], data_slice, data_slice});
+    }
+  }
+
+  void run(int n) override {
+    for (int i = 0; i < n; i++) {
+      if (use_batch) {
+        td::aes_ige_encrypt_batch(tasks.data(), tasks.size());
+      } else {
+        for (auto &task : tasks) {
+          td::aes_ige_encrypt(*task.aes_key, task.aes_iv, task.from, task.to);
+        }
+      }
+    }
+  }
+};
+
+class AesCtrBench : public td::Benchmark {
+ public:
+  alignas(64) unsigned char data[DATA_SIZE];
+  td::AesCtrState state;
+
+  std::string get_description() const override {
+    return PSTRING("AES-CTR [%dKB]", DATA_SIZE >> 10);
+  }
+
+  void start_up() override {
+    for (int i = 0; i < DATA_SIZE; i++) {
+      data[i] = 123;
+    }
+    td::UInt256 key;
+    td::UInt128 iv;
+    td::Random::secure_bytes(key.raw, sizeof(key));
+    td::Random::secure_bytes(iv.raw, sizeof(iv));
+    state.init(key, iv);
+  }
+
+  void run(int n) override {
+    td::MutableSlice data_slice(data, DATA_SIZE);
+    for (int i = 0; i < n; i++) {
+      state.encrypt(data_slice, data_slice);
+    }
+  }
+};
+
+class SHA256Bench : public td::Benchmark {
+ public:
+  alignas(64) unsigned char data[DATA_SIZE];
+
+  std::string get_description() const override {
+    return PSTRING("SHA256 [%dKB]", DATA_SIZE >> 10);
+  }
+
+  void start_up() override {
+    for (int i = 0; i < DATA_SIZE; i++) {
+      data[i] = 123;
+    }
+  }
+
+  void run(int n) override {
+    unsigned char md[32];
+    for (int i = 0; i < n; i++) {
+      td::sha256(td::Slice(data, DATA_SIZE), td::MutableSlice(md, 32));
+    }
+    td::do_not_optimize_away(md[0]);
+  }
+};
+
+// the same input sizes as in KDF2
+template <bool use_batch>
+class SHA256PairBench : public td::Benchmark {
+ public:
+  unsigned char data[2][52];
+
+  std::string get_description() const override {
+    return PSTRING("SHA256 of 2 x 52 bytes %s", use_batch ? "batched" : "one by one");
+  }
+
+  void start_up() override {
+    td::Random::secure_bytes(data[0], sizeof(data[0]));
+    td::Random::secure_bytes(data[1], sizeof(data[1]));
+  }
+
+  void run(int n) override {
+    unsigned char md[2][32];
+    const td::Slice inputs[2] = {td::Slice(data[0], sizeof(data[0])), td::Slice(data[1], sizeof(data[1]))};
+    const td::MutableSlice outputs[2] = {td::MutableSlice(md[0], 32), td::MutableSlice(md[1], 32)};
+    for (int i = 0; i < n; i++) {
+      if (use_batch) {
+        td::sha256_batch(inputs, outputs, 2);
+      } else {
+        td::sha256(inputs[0], outputs[0]);
+        td::sha256(inputs[1], outputs[1]);
+      }
+      data[0][0] = md[0][0];
+    }
+  }
+};
+
+class CryptoWorkerPoolBench : public td::Benchmark {
+ public:
+  static constexpr int PACKET_COUNT = 16;
+  static constexpr int PACKET_SIZE = 32 << 10;
+
+  explicit CryptoWorkerPoolBench(int thread_count) : thread_count_(thread_count) {
+  }
+
+  std::string get_description() const override {
+    return PSTRING("Encrypt %d packets [%dKB] with %d crypto threads", PACKET_COUNT, PACKET_SIZE >> 10,
+                   thread_count_);
+  }
+
+  void start_up() override {
+    pool_ = std::make_unique<td::mtproto::CryptoWorkerPool>(thread_count_);
+
+    std::string key(256, '\0');
+    td::Random::secure_bytes(key);
+    auth_key_ = td::mtproto::AuthKey(static_cast<td::uint64>(td::Random::secure_int64()), std::move(key));
+
+    std::string data(PACKET_SIZE, 'a');
+    auto storer = td::create_storer(data);
+    packets_.clear();
+    infos_.clear();
+    for (int i = 0; i < PACKET_COUNT; i++) {
+      td::mtproto::PacketInfo info;
+      info.version = 2;
+      info.no_crypto_flag = false;
+      info.salt = 0;
+      info.session_id = 0;
+      td::BufferWriter packet(td::mtproto::Transport::write_unencrypted(storer, auth_key_, &info), 0, 0);
+      td::mtproto::Transport::write_unencrypted(storer, auth_key_, &info, packet.as_slice());
+      packets_.push_back(std::move(packet));
+      infos_.push_back(info);
+    }
+  }
+
+  void run(int n) override {
+    for (int i = 0; i < n; i++) {
+      pool_->run(packets_.size(), [&](size_t j) {
+        td::mtproto::Transport::encrypt_packet(auth_key_, &infos_[j], packets_[j].as_slice());
+      });
+    }
+  }
+
+  void tear_down() override {
+    pool_.reset();
+  }
+
+ private:
+  int thread_count_;
+  std::unique_ptr<td::mtproto::CryptoWorkerPool> pool_;
+  td::mtproto::AuthKey auth_key_;
+  std::vector<td::BufferWriter> packets_;
+  std::vector<td::mtproto::PacketInfo> infos_;
+};
+
 BENCH(Rand, "std_rand") {
   int res = 0;
   for (int i = 0; i < n; i++) {
@@ -152,7 +338,7 @@ class Crc32Bench : public td::Benchmark {
   alignas(64) unsigned char data[DATA_SIZE];
 
   std::string get_description() const override {
-    return PSTRING("Crc32 zlib [%dKB]", DATA_SIZE >> 10);
+    return PSTRING("Crc32 [%dKB]", DATA_SIZE >> 10);
   }
 
   void start_up() override {
@@ -171,12 +357,35 @@ class Crc32Bench : public td::Benchmark {
   }
 };
 
+class Crc32cBench : public td::Benchmark {
+ public:
+  alignas(64) unsigned char data[DATA_SIZE];
+
+  std::string get_description() const override {
+    return PSTRING("Crc32c [%dKB]", DATA_SIZE >> 10);
+  }
+
+  void start_up() override {
+    for (int i = 0; i < DATA_SIZE; i++) {
+      data[i] = 123;
+    }
+  }
+
+  void run(int n) override {
+    td::uint64 res = 0;
+    for (int i = 0; i < n; i++) {
+      res += td::crc32c(td::Slice(data, DATA_SIZE));
+    }
+    td::do_not_optimize_away(res);
+  }
+};
+
 class Crc64Bench : public td::Benchmark {
  public:
   alignas(64) unsigned char data[DATA_SIZE];
 
   std::string get_description() const override {
-    return PSTRING("Crc64 Anton [%dKB]", DATA_SIZE >> 10);
+    return PSTRING("Crc64 [%dKB]", DATA_SIZE >> 10);
   }
 
   void start_up() override {
@@ -207,7 +416,17 @@ int main() {
   td::bench(SslRandBufBench());
   td::bench(SHA1Bench());
   td::bench(AESBench());
+  td::bench(AesIgeBatchBench<false>());
+  td::bench(AesIgeBatchBench<true>());
+  td::bench(AesCtrBench());
+  td::bench(SHA256Bench());
+  td::bench(SHA256PairBench<false>());
+  td::bench(SHA256PairBench<true>());
   td::bench(Crc32Bench());
+  td::bench(Crc32cBench());
   td::bench(Crc64Bench());
+  for (int thread_count : {0, 1, 3, 7}) {
+    td::bench(CryptoWorkerPoolBench(thread_count));
+  }
   return 0;
 }
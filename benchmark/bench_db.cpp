@@ -7,15 +7,18 @@
 #include "td/actor/actor.h"
 
 #include "td/db/binlog/Binlog.h"
+#include "td/db/binlog/BinlogEvent.h"
 #include "td/db/BinlogKeyValue.h"
 #include "td/db/SeqKeyValue.h"
 #include "td/db/SqliteDb.h"
 #include "td/db/SqliteKeyValueAsync.h"
 
 #include "td/utils/benchmark.h"
+#include "td/utils/common.h"
 #include "td/utils/format.h"
 #include "td/utils/logging.h"
 #include "td/utils/Status.h"
+#include "td/utils/Storer.h"
 #include "td/utils/StringBuilder.h"
 
 #include <memory>
@@ -223,8 +226,58 @@ class BinlogKeyValueBench : public td::Benchmark {
   }
 };
 
+class BinlogLoadBench : public td::Benchmark {
+ public:
+  static constexpr size_t BINLOG_SIZE = 500 << 20;
+  static constexpr size_t EVENT_DATA_SIZE = 1000;
+
+  BinlogLoadBench() = default;
+  BinlogLoadBench(const BinlogLoadBench &) = delete;
+  BinlogLoadBench &operator=(const BinlogLoadBench &) = delete;
+  BinlogLoadBench(BinlogLoadBench &&) = delete;
+  BinlogLoadBench &operator=(BinlogLoadBench &&) = delete;
+  ~BinlogLoadBench() override {
+    td::Binlog::destroy(binlog_name_).ignore();
+  }
+
+  td::string get_description() const override {
+    return PSTRING() << "Binlog load " << td::format::as_size(BINLOG_SIZE);
+  }
+
+  void start_up() override {
+    if (is_created_) {
+      return;
+    }
+    is_created_ = true;
+
+    td::Binlog::destroy(binlog_name_).ignore();
+    td::Binlog binlog;
+    binlog.init(binlog_name_, [](const td::BinlogEvent &event) {}).ensure();
+    td::string data(EVENT_DATA_SIZE, 'a');
+    for (size_t size = 0; size < BINLOG_SIZE; size += EVENT_DATA_SIZE) {
+      binlog.add_raw_event(td::BinlogEvent::create_raw(binlog.next_id(), 1, 0, td::create_storer(data)));
+    }
+    binlog.close().ensure();
+  }
+
+  void run(int n) override {
+    for (int i = 0; i < n; i++) {
+      td::Binlog binlog;
+      size_t event_count = 0;
+      binlog.init(binlog_name_, [&](const td::BinlogEvent &event) { event_count++; }).ensure();
+      CHECK(event_count == (BINLOG_SIZE + EVENT_DATA_SIZE - 1) / EVENT_DATA_SIZE);
+      binlog.close(false).ensure();
+    }
+  }
+
+ private:
+  td::string binlog_name_ = "bench_binlog_load";
+  bool is_created_ = false;
+};
+
 int main() {
   SET_VERBOSITY_LEVEL(VERBOSITY_NAME(WARNING));
+  bench(BinlogLoadBench());
   bench(BinlogKeyValueBench<true>());
   bench(BinlogKeyValueBench<false>());
   bench(SqliteKVBench<false>());
@@ -79,6 +79,32 @@ class BufferBench : public td::Benchmark {
   }
 };
 
+class ChainBufferCycleBench : public td::Benchmark {
+  std::string get_description() const override {
+    return "ChainBufferCycleBench";
+  }
+
+  void run(int n) override {
+    const int chunks_n = 8;
+    size_t total_size = 0;
+    for (int i = 0; i < n; i++) {
+      td::ChainBufferWriter writer;
+      auto reader = writer.extract_reader();
+      for (int j = 0; j < chunks_n; j++) {
+        writer.append(chunk_);
+      }
+      reader.sync_with_writer();
+      total_size += reader.move_as_buffer_slice().size();
+    }
+    CHECK(total_size == static_cast<size_t>(n) * chunks_n * block_size);
+  }
+  std::string chunk_;
+
+  void start_up() override {
+    chunk_ = std::string(block_size, 'a');
+  }
+};
+
 class FindBoundaryBench : public td::Benchmark {
   std::string get_description() const override {
     return "FindBoundaryBench";
@@ -113,6 +139,7 @@ class FindBoundaryBench : public td::Benchmark {
 int main() {
   SET_VERBOSITY_LEVEL(VERBOSITY_NAME(WARNING));
   td::bench(BufferBench());
+  td::bench(ChainBufferCycleBench());
   td::bench(FindBoundaryBench());
   td::bench(HttpReaderBench());
 }
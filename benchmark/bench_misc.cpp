@@ -5,20 +5,38 @@
 // file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 //
 #include "td/utils/benchmark.h"
+#include "td/utils/buffer.h"
 #include "td/utils/common.h"
+#include "td/utils/FlatHashMap.h"
+#include "td/utils/Gzip.h"
+#include "td/utils/Heap.h"
+#include "td/utils/Hints.h"
+#include "td/utils/JsonBuilder.h"
 #include "td/utils/logging.h"
 #include "td/utils/port/Clocks.h"
 #include "td/utils/port/EventFd.h"
+#include "td/utils/port/Fd.h"
 #include "td/utils/port/FileFd.h"
 #include "td/utils/port/path.h"
 #include "td/utils/port/RwMutex.h"
 #include "td/utils/port/Stat.h"
 #include "td/utils/port/thread.h"
+#include "td/utils/Random.h"
 #include "td/utils/Slice.h"
+#include "td/utils/TimerWheel.h"
+#include "td/utils/tl_storers.h"
+#include "td/utils/utf8.h"
 
+#include "td/mtproto/utils.h"
+
+#include "td/telegram/MessageEntity.h"
+#include "td/telegram/td_api.h"
+#include "td/telegram/td_api_json.h"
 #include "td/telegram/telegram_api.h"
 #include "td/telegram/telegram_api.hpp"
 
+#include "td/tl/tl_json.h"
+
 #if !TD_WINDOWS
 #include <unistd.h>
 #include <utime.h>
@@ -30,6 +48,8 @@
 
 #include <atomic>
 #include <cstdint>
+#include <unordered_map>
+#include <utility>
 
 namespace td {
 
@@ -150,6 +170,64 @@ class PipeBench : public Benchmark {
     close(p[1]);
   }
 };
+
+// emulates flush of an MTProto packet, which consists of several buffers, to a socket
+template <bool use_writev>
+class ChainBufferFlushBench : public Benchmark {
+ public:
+  string get_description() const override {
+    return use_writev ? "flush ChainBuffer with writev" : "flush ChainBuffer with write per node";
+  }
+
+  void start_up() override {
+    int p[2];
+    pipe(p);
+    read_fd_ = p[0];
+    write_fd_ = Fd(p[1], Fd::Mode::Owner);
+    for (size_t i = 0; i < PARTS_N; i++) {
+      parts_[i] = BufferSlice(256 + 211 * i);
+    }
+  }
+
+  void run(int n) override {
+    char buf[1 << 14];
+    for (int i = 0; i < n; i++) {
+      ChainBufferWriter writer;
+      auto reader = writer.extract_reader();
+      size_t total_size = 0;
+      for (auto &part : parts_) {
+        writer.append(part.clone());
+        total_size += part.size();
+      }
+      reader.sync_with_writer();
+      while (!reader.empty()) {
+        if (use_writev) {
+          Slice slices[Fd::MAX_IO_SLICES];
+          auto slice_count = reader.prepare_readv(slices, Fd::MAX_IO_SLICES);
+          reader.advance(write_fd_.writev(slices, slice_count).move_as_ok());
+        } else {
+          reader.confirm_read(write_fd_.write(reader.prepare_read()).move_as_ok());
+        }
+      }
+      while (total_size > 0) {
+        auto read_size = read(read_fd_, buf, sizeof(buf));
+        CHECK(read_size > 0);
+        total_size -= static_cast<size_t>(read_size);
+      }
+    }
+  }
+
+  void tear_down() override {
+    close(read_fd_);
+    write_fd_.close();
+  }
+
+ private:
+  static constexpr size_t PARTS_N = 8;
+  BufferSlice parts_[PARTS_N];
+  int read_fd_ = -1;
+  Fd write_fd_;
+};
 #endif
 
 #if TD_LINUX || TD_ANDROID || TD_TIZEN
@@ -352,10 +430,520 @@ class RwMutexWriteBench : public Benchmark {
   }
 };
 #endif
+
+inline HeapNode *pop_expired(KHeap<double> &heap, double now) {
+  if (heap.empty() || heap.top_key() > now) {
+    return nullptr;
+  }
+  return heap.pop();
+}
+
+inline HeapNode *pop_expired(TimerWheel &wheel, double now) {
+  return wheel.pop_expired(now);
+}
+
+// emulates NetQuery-like timeouts: many pending timeouts, most of which are cancelled or postponed before expiration
+template <class QueueT>
+class TimeoutQueueBench : public Benchmark {
+ public:
+  explicit TimeoutQueueBench(string name) : name_(std::move(name)) {
+  }
+
+  string get_description() const override {
+    return PSTRING() << "Timeouts in " << name_;
+  }
+
+  void run(int n) override {
+    static constexpr int NODE_COUNT = 1 << 17;
+    std::vector<HeapNode> nodes(NODE_COUNT);
+    QueueT queue;
+    double now = 0;
+    uint64 expired_count = 0;
+    for (int i = 0; i < n; i++) {
+      now += 0.0001;
+      auto &node = nodes[Random::fast_uint32() % NODE_COUNT];
+      int action = Random::fast(0, 9);
+      if (action < 5) {
+        double timeout_at = now + Random::fast(1, 60000) * 0.001;
+        if (node.in_heap()) {
+          queue.fix(timeout_at, &node);
+        } else {
+          queue.insert(timeout_at, &node);
+        }
+      } else if (node.in_heap()) {
+        queue.erase(&node);
+      }
+      while (pop_expired(queue, now) != nullptr) {
+        expired_count++;
+      }
+    }
+    do_not_optimize_away(expired_count);
+  }
+
+ private:
+  string name_;
+};
+// emulates tables like ContactsManager::users_: many int32 identifiers mapped to small objects
+template <class MapT>
+class IdMapBench : public Benchmark {
+ public:
+  explicit IdMapBench(string name) : name_(std::move(name)) {
+  }
+
+  string get_description() const override {
+    return PSTRING() << "Lookup of random ids in " << name_;
+  }
+
+  void start_up() override {
+    static constexpr int32 ID_COUNT = 1000000;
+    ids_.clear();
+    for (int32 i = 0; i < ID_COUNT; i++) {
+      ids_.push_back(Random::fast(1, 1000000000));
+    }
+
+#if TD_PORT_POSIX
+    auto begin_mem = mem_stat();
+#endif
+    map_ = MapT();
+    for (auto id : ids_) {
+      map_[id] = id;
+    }
+#if TD_PORT_POSIX
+    auto end_mem = mem_stat();
+    if (!is_memory_reported_ && begin_mem.is_ok() && end_mem.is_ok()) {
+      is_memory_reported_ = true;
+      LOG(INFO) << name_ << " with " << map_.size() << " elements uses about "
+                << (static_cast<int64>(end_mem.ok().resident_size_) -
+                    static_cast<int64>(begin_mem.ok().resident_size_)) /
+                       1024
+                << " KB of additional resident memory";
+    }
+#endif
+  }
+
+  void run(int n) override {
+    uint64 sum = 0;
+    for (int i = 0; i < n; i++) {
+      auto id = ids_[Random::fast_uint32() % ids_.size()];
+      auto it = map_.find(id);
+      if (it != map_.end()) {
+        sum += it->second;
+      }
+      sum += map_.count(id + 1);
+    }
+    do_not_optimize_away(sum);
+  }
+
+  void tear_down() override {
+    map_ = MapT();
+  }
+
+ private:
+  string name_;
+  vector<int32> ids_;
+  MapT map_;
+  bool is_memory_reported_ = false;
+};
+
+// emulates a typical updates.getDifference result with new messages, users and chats
+template <class StorerT>
+void store_get_difference_result(StorerT &s) {
+  static constexpr int32 VECTOR_ID = 0x1cb5c415;
+  static constexpr int32 MESSAGE_COUNT = 100;
+  static constexpr int32 UPDATE_COUNT = 50;
+  static constexpr int32 CHAT_COUNT = 20;
+  static constexpr int32 USER_COUNT = 100;
+  string text(80, 'a');
+
+  s.store_int(telegram_api::updates_difference::ID);
+  s.store_int(VECTOR_ID);
+  s.store_int(MESSAGE_COUNT);
+  for (int32 i = 0; i < MESSAGE_COUNT; i++) {
+    s.store_int(telegram_api::message::ID);
+    s.store_int((1 << 7) | (1 << 8));  // from_id and entities
+    s.store_int(i + 1);
+    s.store_int(i + 1000);
+    s.store_int(telegram_api::peerUser::ID);
+    s.store_int(i + 2000);
+    s.store_int(1500000000 + i);
+    s.store_string(text);
+    s.store_int(VECTOR_ID);
+    s.store_int(2);
+    for (int32 j = 0; j < 2; j++) {
+      s.store_int(telegram_api::messageEntityBold::ID);
+      s.store_int(j * 10);
+      s.store_int(5);
+    }
+  }
+  s.store_int(VECTOR_ID);
+  s.store_int(0);
+  s.store_int(VECTOR_ID);
+  s.store_int(UPDATE_COUNT);
+  for (int32 i = 0; i < UPDATE_COUNT; i++) {
+    s.store_int(telegram_api::updateReadHistoryInbox::ID);
+    s.store_int(telegram_api::peerUser::ID);
+    s.store_int(i + 2000);
+    s.store_int(i + 1);
+    s.store_int(i + 10);
+    s.store_int(1);
+  }
+  s.store_int(VECTOR_ID);
+  s.store_int(CHAT_COUNT);
+  for (int32 i = 0; i < CHAT_COUNT; i++) {
+    s.store_int(telegram_api::chat::ID);
+    s.store_int(0);
+    s.store_int(i + 3000);
+    s.store_string(Slice("Chat title"));
+    s.store_int(telegram_api::chatPhotoEmpty::ID);
+    s.store_int(10);
+    s.store_int(1500000000);
+    s.store_int(1);
+  }
+  s.store_int(VECTOR_ID);
+  s.store_int(USER_COUNT);
+  for (int32 i = 0; i < USER_COUNT; i++) {
+    s.store_int(telegram_api::user::ID);
+    s.store_int(1 | 2 | 4 | 8 | 32 | 64);  // access_hash, names, username, photo and status
+    s.store_int(i + 1000);
+    s.store_long(i * 1234567);
+    s.store_string(Slice("First name"));
+    s.store_string(Slice("Last name"));
+    s.store_string(Slice("username"));
+    s.store_int(telegram_api::userProfilePhotoEmpty::ID);
+    s.store_int(telegram_api::userStatusOffline::ID);
+    s.store_int(1500000000);
+  }
+  s.store_int(telegram_api::updates_state::ID);
+  for (int32 i = 0; i < 5; i++) {
+    s.store_int(i);
+  }
+}
+
+template <bool use_arena>
+class TlFetchBench : public Benchmark {
+ public:
+  string get_description() const override {
+    return PSTRING() << "Fetch and destroy getDifference result" << (use_arena ? " using arena" : "");
+  }
+
+  void start_up() override {
+    TlStorerCalcLength calc_length;
+    store_get_difference_result(calc_length);
+    payload_ = BufferSlice(calc_length.get_length());
+    TlStorerUnsafe storer(payload_.as_slice().begin());
+    store_get_difference_result(storer);
+    CHECK(fetch_result<telegram_api::updates_getDifference>(payload_).is_ok());
+  }
+
+  void run(int n) override {
+    int32 sum = 0;
+    for (int i = 0; i < n; i++) {
+      auto r_result = use_arena ? fetch_result_in_arena<telegram_api::updates_getDifference>(payload_)
+                                : fetch_result<telegram_api::updates_getDifference>(payload_);
+      sum += r_result.ok()->get_id();
+    }
+    do_not_optimize_away(sum);
+  }
+
+ private:
+  BufferSlice payload_;
+};
+
+// message text mixing Latin, Cyrillic, CJK and emoji, in which ASCII runs are short
+static string gen_mixed_script_text(size_t size) {
+  const char *words[] = {"Hello", "world", "Привет", "мир", "你好", "世界", "\xF0\x9F\x98\x80",
+                         "\xF0\x9F\x91\x8D", "https://telegram.org", "сообщение", "テスト", "ok"};
+  string result;
+  while (result.size() < size) {
+    result += words[Random::fast(0, static_cast<int>(sizeof(words) / sizeof(*words)) - 1)];
+    result += Random::fast(0, 9) == 0 ? ",\n" : " ";
+  }
+  return result;
+}
+
+class Utf8Bench : public Benchmark {
+ public:
+  enum class Type : int32 { CheckUtf8, Utf8Length, Utf8Utf16Length, NaiveUtf8Utf16Length };
+
+  Utf8Bench(Type type, size_t text_size) : type_(type), text_size_(text_size) {
+  }
+
+  string get_description() const override {
+    const char *names[] = {"check_utf8", "utf8_length", "utf8_utf16_length", "naive utf8_utf16_length"};
+    return PSTRING() << names[static_cast<int32>(type_)] << " of " << text_size_ << " bytes of mixed-script text";
+  }
+
+  void start_up() override {
+    text_ = gen_mixed_script_text(text_size_);
+    CHECK(check_utf8(text_));
+  }
+
+  void run(int n) override {
+    size_t sum = 0;
+    for (int i = 0; i < n; i++) {
+      switch (type_) {
+        case Type::CheckUtf8:
+          sum += check_utf8(text_);
+          break;
+        case Type::Utf8Length:
+          sum += utf8_length(text_);
+          break;
+        case Type::Utf8Utf16Length:
+          sum += utf8_utf16_length(text_);
+          break;
+        case Type::NaiveUtf8Utf16Length:
+          for (auto c : text_) {
+            auto code_unit = static_cast<unsigned char>(c);
+            sum += is_utf8_character_first_code_unit(code_unit) + (code_unit >= 0xf0);
+          }
+          break;
+      }
+    }
+    do_not_optimize_away(sum);
+  }
+
+ private:
+  Type type_;
+  size_t text_size_;
+  string text_;
+};
+
+class FindEntitiesBench : public Benchmark {
+ public:
+  FindEntitiesBench(size_t text_size, bool with_entities) : text_size_(text_size), with_entities_(with_entities) {
+  }
+
+  string get_description() const override {
+    return PSTRING() << "find_entities in " << text_size_ << " bytes of text" << (with_entities_ ? " with" : " without")
+                     << " entities";
+  }
+
+  void start_up() override {
+    text_ = gen_mixed_script_text(text_size_);
+    if (with_entities_) {
+      text_ += " Join @telegram, send /start and read https://telegram.org/blog #news. Questions to mail@example.com.";
+    } else {
+      for (auto &c : text_) {
+        if (c == '.' || c == '/' || c == ':') {  // remove URLs
+          c = ' ';
+        }
+      }
+    }
+  }
+
+  void run(int n) override {
+    size_t sum = 0;
+    for (int i = 0; i < n; i++) {
+      sum += find_entities(text_, false).size();
+    }
+    do_not_optimize_away(sum);
+  }
+
+ private:
+  size_t text_size_;
+  bool with_entities_;
+  string text_;
+};
+
+template <bool use_pull_parser>
+class JsonRequestParseBench : public Benchmark {
+ public:
+  string get_description() const override {
+    return PSTRING() << "Parse sendMessage JSON request"
+                     << (use_pull_parser ? " using pull parser" : " using JsonValue");
+  }
+
+  void start_up() override {
+    request_ = PSTRING() << "{\"@type\":\"sendMessage\",\"chat_id\":\"123456789012\",\"reply_to_message_id\":0,"
+                            "\"disable_notification\":false,\"from_background\":false,\"reply_markup\":null,"
+                            "\"input_message_content\":{\"@type\":\"inputMessageText\",\"text\":"
+                         << JsonRawString(gen_mixed_script_text(200))
+                         << ",\"disable_web_page_preview\":false,\"clear_draft\":true,\"entities\":[{\"@type\":"
+                            "\"textEntity\",\"offset\":0,\"length\":5,\"type\":{\"@type\":\"textEntityTypeBold\"}}]},"
+                            "\"@extra\":{\"request_id\":12345}}";
+  }
+
+  void run(int n) override {
+    int32 sum = 0;
+    for (int i = 0; i < n; i++) {
+      auto request = request_;
+      td_api::object_ptr<td_api::Function> function;
+      if (use_pull_parser) {
+        JsonPullParser parser(request);
+        from_json(function, parser).ensure();
+        parser.finish().ensure();
+      } else {
+        auto value = json_decode(request).move_as_ok();
+        from_json(function, value).ensure();
+      }
+      sum += function->get_id();
+    }
+    do_not_optimize_away(sum);
+  }
+
+ private:
+  string request_;
+};
+
+template <bool reuse_buffer>
+class JsonResponseSerializeBench : public Benchmark {
+ public:
+  string get_description() const override {
+    return PSTRING() << "Serialize updateNewMessage to JSON"
+                     << (reuse_buffer ? " into reused buffer" : " using json_encode");
+  }
+
+  void start_up() override {
+    auto message = td_api::make_object<td_api::message>();
+    message->id_ = 123456789012;
+    message->sender_user_id_ = 12345678;
+    message->chat_id_ = -1001234567890;
+    message->date_ = 1500000000;
+    message->can_be_deleted_only_for_self_ = true;
+    message->media_album_id_ = 1234567890123456789;
+    auto content = td_api::make_object<td_api::messageText>();
+    content->text_ = gen_mixed_script_text(200);
+    content->entities_.push_back(
+        td_api::make_object<td_api::textEntity>(0, 5, td_api::make_object<td_api::textEntityTypeBold>()));
+    message->content_ = std::move(content);
+    update_ = td_api::make_object<td_api::updateNewMessage>(std::move(message), false, false);
+    buffer_.resize(1 << 12);
+  }
+
+  void run(int n) override {
+    size_t sum = 0;
+    for (int i = 0; i < n; i++) {
+      if (reuse_buffer) {
+        JsonBuilder jb(StringBuilder(MutableSlice(&buffer_[0], buffer_.size())));
+        jb.enter_value() << ToJson(static_cast<const td_api::Object &>(*update_));
+        CHECK(!jb.string_builder().is_error());
+        sum += jb.string_builder().as_cslice().size();
+      } else {
+        sum += json_encode<string>(ToJson(static_cast<const td_api::Object &>(*update_))).size();
+      }
+    }
+    do_not_optimize_away(sum);
+  }
+
+ private:
+  td_api::object_ptr<td_api::updateNewMessage> update_;
+  string buffer_;
+};
+
+class HintsSearchBench : public Benchmark {
+ public:
+  static constexpr int32 KEY_COUNT = 1000000;
+
+  string get_description() const override {
+    return PSTRING() << "Search for top 10 of " << KEY_COUNT << " hints";
+  }
+
+  void start_up() override {
+    if (hints_.size() != 0) {
+      return;
+    }
+    for (int32 key = 0; key < KEY_COUNT; key++) {
+      hints_.add(key, gen_word() + ' ' + gen_word());
+      hints_.set_rating(key, Random::fast(0, KEY_COUNT));
+    }
+    for (int i = 0; i < 100; i++) {
+      auto query = gen_word().substr(0, Random::fast(1, 4));
+      if (i % 4 == 0) {
+        query += ' ' + gen_word().substr(0, Random::fast(1, 2));
+      }
+      queries_.push_back(std::move(query));
+    }
+    hints_.search(queries_[0], 10);
+  }
+
+  void run(int n) override {
+    size_t sum = 0;
+    for (int i = 0; i < n; i++) {
+      sum += hints_.search(queries_[i % queries_.size()], 10).first;
+    }
+    do_not_optimize_away(sum);
+  }
+
+ private:
+  Hints hints_;
+  vector<string> queries_;
+
+  // letters have non-uniform frequencies like in real names
+  static string gen_word() {
+    string word;
+    auto length = Random::fast(3, 9);
+    for (int i = 0; i < length; i++) {
+      word += static_cast<char>('a' + Random::fast(0, 25) * Random::fast(0, 25) / 25);
+    }
+    return word;
+  }
+};
+
+template <bool is_encode>
+class GzipBench : public Benchmark {
+ public:
+  explicit GzipBench(size_t size) : size_(size) {
+  }
+
+  string get_description() const override {
+    return PSTRING() << (is_encode ? "gzencode" : "gzdecode") << " of " << size_ << " bytes";
+  }
+
+  void start_up() override {
+    data_.clear();
+    while (data_.size() < size_) {
+      data_ += to_string(Random::fast(0, 1000000)) + (Random::fast(0, 3) == 0 ? "\n" : " ");
+    }
+    data_.resize(size_);
+    gzip_ = gzencode(data_).as_slice().str();
+  }
+
+  void run(int n) override {
+    size_t sum = 0;
+    for (int i = 0; i < n; i++) {
+      if (is_encode) {
+        sum += gzencode(data_).size();
+      } else {
+        sum += gzdecode(gzip_).size();
+      }
+    }
+    do_not_optimize_away(sum);
+  }
+
+ private:
+  size_t size_;
+  string data_;
+  string gzip_;
+};
 }  // namespace td
 
 int main() {
   SET_VERBOSITY_LEVEL(VERBOSITY_NAME(DEBUG));
+  for (size_t text_size : {100, 4096}) {
+    td::bench(td::Utf8Bench(td::Utf8Bench::Type::CheckUtf8, text_size));
+    td::bench(td::Utf8Bench(td::Utf8Bench::Type::Utf8Length, text_size));
+    td::bench(td::Utf8Bench(td::Utf8Bench::Type::Utf8Utf16Length, text_size));
+    td::bench(td::Utf8Bench(td::Utf8Bench::Type::NaiveUtf8Utf16Length, text_size));
+  }
+  for (size_t text_size : {100, 4096}) {
+    td::bench(td::FindEntitiesBench(text_size, false));
+    td::bench(td::FindEntitiesBench(text_size, true));
+  }
+  td::bench(td::JsonRequestParseBench<false>());
+  td::bench(td::JsonRequestParseBench<true>());
+  td::bench(td::JsonResponseSerializeBench<false>());
+  td::bench(td::JsonResponseSerializeBench<true>());
+  td::bench(td::HintsSearchBench());
+  for (size_t size : {100, 10000, 1000000}) {
+    td::bench(td::GzipBench<false>(size));
+    td::bench(td::GzipBench<true>(size));
+  }
+  td::bench(td::TlFetchBench<false>());
+  td::bench(td::TlFetchBench<true>());
+  td::bench(td::IdMapBench<td::FlatHashMap<td::int32, td::int64>>("FlatHashMap"));
+  td::bench(td::IdMapBench<std::unordered_map<td::int32, td::int64>>("std::unordered_map"));
+  td::bench(td::TimeoutQueueBench<td::KHeap<double>>("KHeap"));
+  td::bench(td::TimeoutQueueBench<td::TimerWheel>("TimerWheel"));
 #if !TD_THREAD_UNSUPPORTED
   td::bench(td::AtomicReleaseIncBench<1>());
   td::bench(td::AtomicReleaseIncBench<2>());
@@ -384,6 +972,8 @@ int main() {
   td::bench(td::NewIntBench());
 #if !TD_WINDOWS
   td::bench(td::PipeBench());
+  td::bench(td::ChainBufferFlushBench<false>());
+  td::bench(td::ChainBufferFlushBench<true>());
 #endif
 #if TD_LINUX || TD_ANDROID || TD_TIZEN
   td::bench(td::SemBench());
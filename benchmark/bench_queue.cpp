@@ -695,6 +695,94 @@ class QueueBenchmark2 : public td::Benchmark {
   }
 };
 
+// several writers put values into one queue, which is read by one reader
+template <class QueueT>
+class MpscQueueBenchmark : public td::Benchmark {
+  QueueT queue;
+  int writers_n;
+  int queries_n;
+  int batch_size;
+
+  struct WriterArg {
+    MpscQueueBenchmark *self;
+    int writer_id;
+  };
+
+ public:
+  explicit MpscQueueBenchmark(int writers_n, int batch_size = 1) : writers_n(writers_n), batch_size(batch_size) {
+  }
+
+  std::string get_description() const override {
+    return "MpscQueueBenchmark";
+  }
+
+  void start_up() override {
+    queue.init();
+  }
+
+  void tear_down() override {
+    queue.destroy();
+  }
+
+  void *writer_run(int writer_id) {
+    vector<qvalue_t> batch;
+    for (int i = 0; i < queries_n; i++) {
+      qvalue_t value = (static_cast<qvalue_t>(writer_id) << 24) | (i & 0x00FFFFFF);
+      if (batch_size == 1) {
+        queue.writer_put(value);
+      } else {
+        batch.push_back(value);
+        if (static_cast<int>(batch.size()) == batch_size || i + 1 == queries_n) {
+          queue.writer_put_batch(batch);
+          batch.clear();
+        }
+      }
+    }
+    return nullptr;
+  }
+
+  void reader_run() {
+    vector<int> next(writers_n);
+    td::int64 left = static_cast<td::int64>(queries_n) * writers_n;
+    while (left > 0) {
+      int cnt = queue.reader_wait();
+      left -= cnt;
+      while (cnt-- > 0) {
+        qvalue_t value = queue.reader_get_unsafe();
+        int no = value & 0x00FFFFFF;
+        int wo = static_cast<int>(static_cast<unsigned int>(value) >> 24);
+        if (wo < 0 || wo >= writers_n || no != (next[wo]++ & 0x00FFFFFF)) {
+          std::fprintf(stderr, "Reader BUG %d %d\n", wo, no);
+          std::exit(0);
+        }
+      }
+      queue.reader_flush();
+    }
+  }
+
+  static void *writer_run_gateway(void *arg) {
+    auto writer_arg = static_cast<WriterArg *>(arg);
+    return writer_arg->self->writer_run(writer_arg->writer_id);
+  }
+
+  void run(int n) override {
+    queries_n = (n + writers_n - 1) / writers_n;
+
+    vector<pthread_t> writer_thread_ids(writers_n);
+    vector<WriterArg> writer_args(writers_n);
+    for (int i = 0; i < writers_n; i++) {
+      writer_args[i] = WriterArg{this, i};
+      pthread_create(&writer_thread_ids[i], nullptr, writer_run_gateway, &writer_args[i]);
+    }
+
+    reader_run();
+
+    for (int i = 0; i < writers_n; i++) {
+      pthread_join(writer_thread_ids[i], nullptr);
+    }
+  }
+};
+
 template <class QueueT>
 class QueueBenchmark : public td::Benchmark {
   QueueT client, server;
@@ -915,6 +1003,19 @@ int main() {
   BENCH_Q2(td::MpscPollableQueue<qvalue_t>, 100);
   BENCH_Q2(td::PollQueue<qvalue_t>, 10);
   BENCH_Q2(td::MpscPollableQueue<qvalue_t>, 10);
+  BENCH_Q2(td::MpscPollableLinkQueue<qvalue_t>, 1);
+  BENCH_Q2(td::MpscPollableLinkQueue<qvalue_t>, 100);
+  BENCH_Q2(td::MpscPollableLinkQueue<qvalue_t>, 10);
+
+#define BENCH_MPSC(Q, N, B)                                      \
+  std::fprintf(stderr, "!%s %d writers, batch %d:\t", #Q, N, B); \
+  td::bench(MpscQueueBenchmark<Q>(N, B));
+  for (int writers_n : {1, 4, 16}) {
+    for (int batch_size : {1, 16}) {
+      BENCH_MPSC(td::MpscPollableQueue<qvalue_t>, writers_n, batch_size);
+      BENCH_MPSC(td::MpscPollableLinkQueue<qvalue_t>, writers_n, batch_size);
+    }
+  }
 
   BENCH_Q(VarQueue, 1);
   // BENCH_Q(FdQueue, 1);
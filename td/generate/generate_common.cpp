@@ -19,18 +19,20 @@
 
 static void generate_cpp(const std::string &directory, const std::string &tl_name, const std::string &string_type,
                          const std::string &bytes_type, const std::vector<std::string> &ext_cpp_includes,
-                         const std::vector<std::string> &ext_h_includes) {
+                         const std::vector<std::string> &ext_h_includes, bool use_arena = false) {
   std::string path = directory + "/" + tl_name;
   td::tl::tl_config config = td::tl::read_tl_config_from_file("scheme/" + tl_name + ".tlo");
   td::tl::write_tl_to_file(config, path + ".cpp",
                            td::TD_TL_writer_cpp(tl_name, string_type, bytes_type, ext_cpp_includes));
-  td::tl::write_tl_to_file(config, path + ".h", td::TD_TL_writer_h(tl_name, string_type, bytes_type, ext_h_includes));
+  td::tl::write_tl_to_file(config, path + ".h",
+                           td::TD_TL_writer_h(tl_name, string_type, bytes_type, ext_h_includes, use_arena));
   td::tl::write_tl_to_file(config, path + ".hpp", td::TD_TL_writer_hpp(tl_name, string_type, bytes_type));
 }
 
 int main() {
   generate_cpp("auto/td/telegram", "telegram_api", "std::string", "BufferSlice",
-               {"\"td/tl/tl_object_parse.h\"", "\"td/tl/tl_object_store.h\""}, {"\"td/utils/buffer.h\""});
+               {"\"td/tl/tl_object_parse.h\"", "\"td/tl/tl_object_store.h\""},
+               {"\"td/utils/Arena.h\"", "\"td/utils/buffer.h\""}, true);
 
   generate_cpp("auto/td/telegram", "secret_api", "std::string", "BufferSlice",
                {"\"td/tl/tl_object_parse.h\"", "\"td/tl/tl_object_store.h\""}, {"\"td/utils/buffer.h\""});
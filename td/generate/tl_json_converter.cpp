@@ -103,20 +103,63 @@ void gen_from_json_constructor(StringBuilder &sb, const T *constructor, bool is_
   }
 }
 
+template <class T>
+void gen_from_json_pull_constructor(StringBuilder &sb, const T *constructor, bool is_header) {
+  sb << "Status from_json(td_api::" << tl::simple::gen_cpp_name(constructor->name) << " &to, JsonPullParser &from)";
+  if (is_header) {
+    sb << ";\n";
+    return;
+  }
+  sb << " {\n";
+  sb << "  MutableSlice field_name;\n";
+  sb << "  while (true) {\n";
+  sb << "    TRY_RESULT(has_field, from.next_field(field_name));\n";
+  sb << "    if (!has_field) {\n";
+  sb << "      return Status::OK();\n";
+  sb << "    }\n";
+  if (constructor->args.empty()) {
+    sb << "    TRY_STATUS(from.skip_value());\n";
+    sb << "  }\n";
+    sb << "}\n";
+    return;
+  }
+  sb << "    if (from.peek_type() == JsonValue::Type::Null) {\n";
+  sb << "      TRY_STATUS(from.read_null());\n";
+  sb << "      continue;\n";
+  sb << "    }\n";
+  sb << "    ";
+  for (auto &arg : constructor->args) {
+    sb << "if (field_name == Slice(\"" << tl::simple::gen_cpp_name(arg.name) << "\")) {\n";
+    if (arg.type->type == tl::simple::Type::Bytes) {
+      sb << "      TRY_STATUS(from_json_bytes(to." << tl::simple::gen_cpp_field_name(arg.name) << ", from));\n";
+    } else {
+      sb << "      TRY_STATUS(from_json(to." << tl::simple::gen_cpp_field_name(arg.name) << ", from));\n";
+    }
+    sb << "    } else ";
+  }
+  sb << "{\n";
+  sb << "      TRY_STATUS(from.skip_value());\n";
+  sb << "    }\n";
+  sb << "  }\n";
+  sb << "}\n";
+}
+
 void gen_from_json(StringBuilder &sb, const tl::simple::Schema &schema, bool is_header) {
   for (auto *custom_type : schema.custom_types) {
     for (auto *constructor : custom_type->constructors) {
       gen_from_json_constructor(sb, constructor, is_header);
+      gen_from_json_pull_constructor(sb, constructor, is_header);
     }
   }
   for (auto *function : schema.functions) {
     gen_from_json_constructor(sb, function, is_header);
+    gen_from_json_pull_constructor(sb, function, is_header);
   }
 }
 
 using Vec = std::vector<std::pair<int32, std::string>>;
 void gen_tl_constructor_from_string(StringBuilder &sb, Slice name, const Vec &vec, bool is_header) {
-  sb << "Result<int32> tl_constructor_from_string(td_api::" << name << " *object, const std::string &str)";
+  sb << "Result<int32> tl_constructor_from_string(td_api::" << name << " *object, Slice str)";
   if (is_header) {
     sb << ";\n";
     return;
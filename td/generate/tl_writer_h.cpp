@@ -207,9 +207,20 @@ std::string TD_TL_writer_h::gen_forward_class_declaration(const std::string &cla
 
 std::string TD_TL_writer_h::gen_class_begin(const std::string &class_name, const std::string &base_class_name,
                                             bool is_proxy) const {
+  std::string allocation_functions;
+  if (use_arena && is_proxy && class_name == gen_base_type_class_name(0)) {
+    allocation_functions =
+        "  static void *operator new(std::size_t size) {\n"
+        "    return ::td::Arena::allocate(size);\n"
+        "  }\n"
+        "  static void operator delete(void *ptr) {\n"
+        "    ::td::Arena::deallocate(ptr);\n"
+        "  }\n";
+  }
   return "class " + class_name + (!is_proxy ? " final " : "") + ": public " + base_class_name +
          " {\n"
-         " public:\n";
+         " public:\n" +
+         allocation_functions;
 }
 
 std::string TD_TL_writer_h::gen_class_end() const {
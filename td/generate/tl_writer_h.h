@@ -17,13 +17,14 @@ namespace td {
 class TD_TL_writer_h : public TD_TL_writer {
  protected:
   const std::vector<std::string> ext_include;
+  const bool use_arena;  // allocate objects with td::Arena, which must be declared in one of ext_include
 
   static std::string forward_declaration(std::string type);
 
  public:
   TD_TL_writer_h(const std::string &tl_name, const std::string &string_type, const std::string &bytes_type,
-                 const std::vector<std::string> &ext_include)
-      : TD_TL_writer(tl_name, string_type, bytes_type), ext_include(ext_include) {
+                 const std::vector<std::string> &ext_include, bool use_arena = false)
+      : TD_TL_writer(tl_name, string_type, bytes_type), ext_include(ext_include), use_arena(use_arena) {
   }
 
   std::string gen_output_begin() const override;
@@ -93,6 +93,9 @@ std::vector<std::string> TD_TL_writer::get_storers() const {
     storers.push_back("TlStorerCalcLength");
     storers.push_back("TlStorerUnsafe");
   }
+  if (tl_name == "telegram_api") {
+    storers.push_back("TlStorerToBufferSlice");
+  }
   storers.push_back("TlStorerToString");
   return storers;
 }
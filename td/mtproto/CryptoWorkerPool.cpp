@@ -0,0 +1,96 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2018
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/mtproto/CryptoWorkerPool.h"
+
+#include "td/utils/logging.h"
+
+#include <algorithm>
+
+namespace td {
+namespace mtproto {
+
+CryptoWorkerPool::CryptoWorkerPool(size_t thread_count) {
+#if !TD_THREAD_UNSUPPORTED
+  thread_count_ = thread_count;
+  threads_.reserve(thread_count);
+  for (size_t i = 0; i < thread_count; i++) {
+    threads_.push_back(td::thread([this] { run_loop(); }));
+  }
+#endif
+}
+
+CryptoWorkerPool::~CryptoWorkerPool() {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    CHECK(batches_.empty());
+    is_closed_ = true;
+  }
+  has_jobs_.notify_all();
+#if !TD_THREAD_UNSUPPORTED
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+#endif
+}
+
+size_t CryptoWorkerPool::assign_job(Batch *batch) {
+  CHECK(batch->next_job < batch->job_count);
+  auto job_id = batch->next_job++;
+  if (batch->next_job == batch->job_count) {
+    batches_.erase(std::find(batches_.begin(), batches_.end(), batch));
+  }
+  return job_id;
+}
+
+void CryptoWorkerPool::run(size_t job_count, const std::function<void(size_t)> &func) {
+  if (thread_count_ == 0 || job_count <= 1) {
+    for (size_t i = 0; i < job_count; i++) {
+      func(i);
+    }
+    return;
+  }
+
+  Batch batch;
+  batch.func = &func;
+  batch.job_count = job_count;
+  batch.unfinished_job_count = job_count;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  batches_.push_back(&batch);
+  has_jobs_.notify_all();
+  while (batch.next_job < batch.job_count) {
+    auto job_id = assign_job(&batch);
+    lock.unlock();
+    func(job_id);
+    lock.lock();
+    batch.unfinished_job_count--;
+  }
+  // workers don't access the batch after the last job is marked as finished
+  has_finished_batch_.wait(lock, [&batch] { return batch.unfinished_job_count == 0; });
+}
+
+void CryptoWorkerPool::run_loop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    has_jobs_.wait(lock, [this] { return is_closed_ || !batches_.empty(); });
+    if (is_closed_) {
+      return;
+    }
+
+    auto *batch = batches_.front();
+    auto job_id = assign_job(batch);
+    lock.unlock();
+    (*batch->func)(job_id);
+    lock.lock();
+    if (--batch->unfinished_job_count == 0) {
+      has_finished_batch_.notify_all();
+    }
+  }
+}
+
+}  // namespace mtproto
+}  // namespace td
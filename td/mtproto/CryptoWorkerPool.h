@@ -0,0 +1,64 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2018
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/common.h"
+#include "td/utils/port/thread.h"
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
+namespace td {
+namespace mtproto {
+
+// Threads, which encrypt and decrypt packets of several connections in parallel.
+// A caller of run blocks until all of its jobs are done and takes part in their execution,
+// so results can be used in the original order right after the call.
+class CryptoWorkerPool {
+ public:
+  explicit CryptoWorkerPool(size_t thread_count);
+  CryptoWorkerPool(const CryptoWorkerPool &) = delete;
+  CryptoWorkerPool &operator=(const CryptoWorkerPool &) = delete;
+  CryptoWorkerPool(CryptoWorkerPool &&) = delete;
+  CryptoWorkerPool &operator=(CryptoWorkerPool &&) = delete;
+  ~CryptoWorkerPool();
+
+  size_t get_thread_count() const {
+    return thread_count_;
+  }
+
+  // calls func(i) for all i in [0, job_count); can be called simultaneously from different threads
+  void run(size_t job_count, const std::function<void(size_t)> &func);
+
+ private:
+  struct Batch {
+    const std::function<void(size_t)> *func = nullptr;
+    size_t job_count = 0;
+    size_t next_job = 0;
+    size_t unfinished_job_count = 0;
+  };
+
+  std::mutex mutex_;
+  std::condition_variable has_jobs_;
+  std::condition_variable has_finished_batch_;
+  vector<Batch *> batches_;
+  bool is_closed_ = false;
+
+  size_t thread_count_ = 0;
+#if !TD_THREAD_UNSUPPORTED
+  vector<td::thread> threads_;
+#endif
+
+  void run_loop();
+
+  // must be called with locked mutex_ only for a batch with unassigned jobs
+  size_t assign_job(Batch *batch);
+};
+
+}  // namespace mtproto
+}  // namespace td
@@ -6,11 +6,11 @@
 //
 #include "td/mtproto/RawConnection.h"
 
-#include "td/mtproto/AuthKey.h"
-#include "td/mtproto/Transport.h"
+#include "td/mtproto/CryptoWorkerPool.h"
 
 #include "td/utils/format.h"
 #include "td/utils/logging.h"
+#include "td/utils/misc.h"
 #include "td/utils/Slice.h"
 #include "td/utils/Status.h"
 
@@ -19,6 +19,21 @@
 namespace td {
 namespace mtproto {
 
+struct RawConnection::ReceivedPacket {
+  BufferSlice packet;
+  uint32 quick_ack = 0;
+
+  PacketInfo info;
+  MutableSlice data;
+  int32 error_code = 0;
+  Status status;
+};
+
+void RawConnection::set_crypto_worker_pool(std::shared_ptr<CryptoWorkerPool> crypto_worker_pool) {
+  CHECK(transport_->get_type() != TransportType::Http);
+  crypto_worker_pool_ = std::move(crypto_worker_pool);
+}
+
 void RawConnection::send_crypto(const Storer &storer, int64 session_id, int64 salt, const AuthKey &auth_key,
                                 uint64 quick_ack_token) {
   mtproto::PacketInfo info;
@@ -27,9 +42,28 @@ void RawConnection::send_crypto(const Storer &storer, int64 session_id, int64 sa
   info.salt = salt;
   info.session_id = session_id;
 
+  if (crypto_worker_pool_ != nullptr) {
+    if (!pending_packets_.empty() && pending_auth_key_.id() != auth_key.id()) {
+      encrypt_pending_packets();
+    }
+    if (pending_packets_.empty()) {
+      pending_auth_key_ = auth_key;
+    }
+
+    // the storer is serialized right away, but encryption is delayed till flush
+    auto packet =
+        BufferWriter{mtproto::Transport::write_unencrypted(storer, auth_key, &info), transport_->max_prepend_size(), 0};
+    mtproto::Transport::write_unencrypted(storer, auth_key, &info, packet.as_slice());
+    pending_packets_.push_back(PendingPacket{std::move(packet), info, quick_ack_token});
+    return;
+  }
+
   auto packet = BufferWriter{mtproto::Transport::write(storer, auth_key, &info), transport_->max_prepend_size(), 0};
   mtproto::Transport::write(storer, auth_key, &info, packet.as_slice());
+  write_packet(std::move(packet), info, quick_ack_token);
+}
 
+void RawConnection::write_packet(BufferWriter &&packet, const PacketInfo &info, uint64 quick_ack_token) {
   bool use_quick_ack = false;
   if (quick_ack_token != 0 && transport_->support_quick_ack()) {
     auto tmp = quick_ack_to_token_.insert(std::make_pair(info.message_ack, quick_ack_token));
@@ -43,7 +77,24 @@ void RawConnection::send_crypto(const Storer &storer, int64 session_id, int64 sa
   transport_->write(std::move(packet), use_quick_ack);
 }
 
+void RawConnection::encrypt_pending_packets() {
+  if (pending_packets_.empty()) {
+    return;
+  }
+
+  crypto_worker_pool_->run(pending_packets_.size(), [&](size_t i) {
+    auto &pending_packet = pending_packets_[i];
+    mtproto::Transport::encrypt_packet(pending_auth_key_, &pending_packet.info, pending_packet.packet.as_slice());
+  });
+  for (auto &pending_packet : pending_packets_) {
+    write_packet(std::move(pending_packet.packet), pending_packet.info, pending_packet.quick_ack_token);
+  }
+  pending_packets_.clear();
+}
+
 uint64 RawConnection::send_no_crypto(const Storer &storer) {
+  encrypt_pending_packets();
+
   mtproto::PacketInfo info;
 
   info.no_crypto_flag = true;
@@ -55,66 +106,126 @@ uint64 RawConnection::send_no_crypto(const Storer &storer) {
   return info.message_id;
 }
 
+void RawConnection::on_quick_ack(uint32 quick_ack, Callback &callback) {
+  auto it = quick_ack_to_token_.find(quick_ack);
+  if (it == quick_ack_to_token_.end()) {
+    LOG(WARNING) << Status::Error(PSLICE() << "Unknown " << tag("quick_ack", quick_ack));
+    return;
+    // TODO: return Status::Error(PSLICE() << "Unknown " << tag("quick_ack", quick_ack));
+  }
+  auto token = it->second;
+  quick_ack_to_token_.erase(it);
+  callback.on_quick_ack(token);
+}
+
+void RawConnection::decrypt_packet(const AuthKey &auth_key, ReceivedPacket *packet) {
+  packet->data = packet->packet.as_slice();
+  packet->info.version = 2;
+  packet->status =
+      mtproto::Transport::read(packet->data, auth_key, &packet->info, &packet->data, &packet->error_code);
+}
+
+Status RawConnection::on_decrypted_packet(const AuthKey &auth_key, ReceivedPacket &packet, Callback &callback) {
+  TRY_STATUS(std::move(packet.status));
+
+  auto error_code = packet.error_code;
+  if (error_code) {
+    if (error_code == -429) {
+      if (stats_callback_) {
+        stats_callback_->on_mtproto_error();
+      }
+      return Status::Error(500, PSLICE() << "Mtproto error: " << error_code);
+    }
+    if (error_code == -404) {
+      return Status::Error(-404, PSLICE() << "Mtproto error: " << error_code);
+    }
+    return Status::Error(PSLICE() << "Mtproto error: " << error_code);
+  }
+
+  // If a packet was successfully decrypted, then it is ok to assume that the connection is alive
+  if (!auth_key.empty()) {
+    if (stats_callback_) {
+      stats_callback_->on_pong();
+    }
+  }
+
+  return callback.on_raw_packet(packet.info, packet.packet.from_slice(packet.data));
+}
+
 Status RawConnection::flush_read(const AuthKey &auth_key, Callback &callback) {
   auto r = socket_fd_.flush_read();
   if (r.is_ok() && stats_callback_) {
     stats_callback_->on_read(r.ok());
   }
+  if (crypto_worker_pool_ != nullptr) {
+    TRY_STATUS(flush_read_parallel(auth_key, callback));
+    TRY_STATUS(std::move(r));
+    return Status::OK();
+  }
+
   while (transport_->can_read()) {
-    BufferSlice packet;
-    uint32 quick_ack = 0;
-    TRY_RESULT(wait_size, transport_->read_next(&packet, &quick_ack));
+    ReceivedPacket packet;
+    TRY_RESULT(wait_size, transport_->read_next(&packet.packet, &packet.quick_ack));
     if (wait_size != 0) {
       break;
     }
 
-    if (quick_ack != 0) {
-      auto it = quick_ack_to_token_.find(quick_ack);
-      if (it == quick_ack_to_token_.end()) {
-        LOG(WARNING) << Status::Error(PSLICE() << "Unknown " << tag("quick_ack", quick_ack));
-        continue;
-        // TODO: return Status::Error(PSLICE() << "Unknown " << tag("quick_ack", quick_ack));
-      }
-      auto token = it->second;
-      quick_ack_to_token_.erase(it);
-      callback.on_quick_ack(token);
+    if (packet.quick_ack != 0) {
+      on_quick_ack(packet.quick_ack, callback);
       continue;
     }
 
-    MutableSlice data = packet.as_slice();
-    PacketInfo info;
-    info.version = 2;
+    if (!is_aligned_pointer<4>(packet.packet.as_slice().begin())) {
+      // the packet is parsed in place and its bytes fields reference the packet buffer, so it must be aligned
+      packet.packet = BufferSlice(packet.packet.as_slice());
+    }
 
-    int32 error_code = 0;
-    TRY_STATUS(mtproto::Transport::read(data, auth_key, &info, &data, &error_code));
+    decrypt_packet(auth_key, &packet);
+    TRY_STATUS(on_decrypted_packet(auth_key, packet, callback));
+  }
+  TRY_STATUS(std::move(r));
+  return Status::OK();
+}
 
-    if (error_code) {
-      if (error_code == -429) {
-        if (stats_callback_) {
-          stats_callback_->on_mtproto_error();
-        }
-        return Status::Error(500, PSLICE() << "Mtproto error: " << error_code);
-      }
-      if (error_code == -404) {
-        return Status::Error(-404, PSLICE() << "Mtproto error: " << error_code);
-      }
-      return Status::Error(PSLICE() << "Mtproto error: " << error_code);
+Status RawConnection::flush_read_parallel(const AuthKey &auth_key, Callback &callback) {
+  // all received packets are decrypted at once and then handled in the original order
+  vector<ReceivedPacket> packets;
+  Status read_status;
+  while (transport_->can_read()) {
+    ReceivedPacket packet;
+    auto r_wait_size = transport_->read_next(&packet.packet, &packet.quick_ack);
+    if (r_wait_size.is_error()) {
+      read_status = r_wait_size.move_as_error();
+      break;
+    }
+    if (r_wait_size.ok() != 0) {
+      break;
     }
 
-    // If a packet was successfully decrypted, then it is ok to assume that the connection is alive
-    if (!auth_key.empty()) {
-      if (stats_callback_) {
-        stats_callback_->on_pong();
-      }
+    if (packet.quick_ack == 0 && !is_aligned_pointer<4>(packet.packet.as_slice().begin())) {
+      packet.packet = BufferSlice(packet.packet.as_slice());
     }
+    packets.push_back(std::move(packet));
+  }
+
+  crypto_worker_pool_->run(packets.size(), [&](size_t i) {
+    if (packets[i].quick_ack == 0) {
+      decrypt_packet(auth_key, &packets[i]);
+    }
+  });
 
-    TRY_STATUS(callback.on_raw_packet(info, packet.from_slice(data)));
+  for (auto &packet : packets) {
+    if (packet.quick_ack != 0) {
+      on_quick_ack(packet.quick_ack, callback);
+      continue;
+    }
+    TRY_STATUS(on_decrypted_packet(auth_key, packet, callback));
   }
-  TRY_STATUS(std::move(r));
-  return Status::OK();
+  return read_status;
 }
 
 Status RawConnection::flush_write() {
+  encrypt_pending_packets();
   TRY_RESULT(size, socket_fd_.flush_write());
   if (size > 0 && stats_callback_) {
     stats_callback_->on_write(size);
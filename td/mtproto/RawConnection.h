@@ -5,7 +5,9 @@
 // file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 //
 #pragma once
+#include "td/mtproto/AuthKey.h"
 #include "td/mtproto/IStreamTransport.h"
+#include "td/mtproto/Transport.h"
 
 #include "td/utils/buffer.h"
 #include "td/utils/BufferedFd.h"
@@ -17,12 +19,12 @@
 #include "td/telegram/StateManager.h"
 
 #include <map>
+#include <memory>
 
 namespace td {
 class Storer;
 namespace mtproto {
-class AuthKey;
-struct PacketInfo;
+class CryptoWorkerPool;
 }  // namespace mtproto
 }  // namespace td
 
@@ -52,6 +54,11 @@ class RawConnection {
     connection_token_ = std::move(connection_token);
   }
 
+  // Packets will be encrypted and decrypted using the pool. Outgoing packets are encrypted in flush,
+  // all of them at once, and incoming packets are decrypted in batches, but their order is preserved.
+  // Must not be used with HTTP transport, which can't send more than one packet at a time.
+  void set_crypto_worker_pool(std::shared_ptr<CryptoWorkerPool> crypto_worker_pool);
+
   bool can_send() const {
     return transport_->can_write();
   }
@@ -101,6 +108,7 @@ class RawConnection {
   }
 
   void close() {
+    pending_packets_.clear();
     transport_.reset();
     socket_fd_.close();
   }
@@ -115,11 +123,30 @@ class RawConnection {
   std::map<uint32, uint64> quick_ack_to_token_;
   bool has_error_{false};
 
+  struct PendingPacket {
+    BufferWriter packet;
+    PacketInfo info;
+    uint64 quick_ack_token;
+  };
+  struct ReceivedPacket;
+
+  std::shared_ptr<CryptoWorkerPool> crypto_worker_pool_;
+  vector<PendingPacket> pending_packets_;
+  AuthKey pending_auth_key_;
+
   std::unique_ptr<StatsCallback> stats_callback_;
 
   StateManager::ConnectionToken connection_token_;
 
+  void write_packet(BufferWriter &&packet, const PacketInfo &info, uint64 quick_ack_token);
+  void encrypt_pending_packets();
+
+  void on_quick_ack(uint32 quick_ack, Callback &callback);
+  static void decrypt_packet(const AuthKey &auth_key, ReceivedPacket *packet);
+  Status on_decrypted_packet(const AuthKey &auth_key, ReceivedPacket &packet, Callback &callback);
+
   Status flush_read(const AuthKey &auth_key, Callback &callback);
+  Status flush_read_parallel(const AuthKey &auth_key, Callback &callback);
   Status flush_write();
 
   Status do_flush(const AuthKey &auth_key, Callback &callback) TD_WARN_UNUSED_RESULT {
@@ -12,6 +12,7 @@
 #include "td/utils/crypto.h"
 #include "td/utils/format.h"
 #include "td/utils/logging.h"
+#include "td/utils/misc.h"
 #include "td/utils/Random.h"
 #include "td/utils/Status.h"
 
@@ -199,7 +200,7 @@ size_t Transport::write_no_crypto(const Storer &storer, PacketInfo *info, Mutabl
 
 template <class HeaderT>
 void Transport::write_crypto_impl(int X, const Storer &storer, const AuthKey &auth_key, PacketInfo *info,
-                                  HeaderT *header, size_t data_size) {
+                                  HeaderT *header, size_t data_size, bool need_encrypt) {
   storer.store(header->data);
   VLOG(raw_mtproto) << "SEND" << format::as_hex_dump<4>(Slice(header->data, data_size));
   // LOG(ERROR) << "SEND" << format::as_hex_dump<4>(Slice(header->data, data_size)) << info->version;
@@ -214,8 +215,15 @@ void Transport::write_crypto_impl(int X, const Storer &storer, const AuthKey &au
   size_t pad_size = size - (sizeof(HeaderT) + data_size);
   MutableSlice pad(header->data + data_size, pad_size);
   Random::secure_bytes(pad.ubegin(), pad.size());
-  MutableSlice to_encrypt = MutableSlice(header->encrypt_begin(), pad.uend());
 
+  if (need_encrypt) {
+    encrypt_crypto_impl(X, auth_key, info, header, data_size, MutableSlice(header->encrypt_begin(), pad.uend()));
+  }
+}
+
+template <class HeaderT>
+void Transport::encrypt_crypto_impl(int X, const AuthKey &auth_key, PacketInfo *info, HeaderT *header, size_t data_size,
+                                    MutableSlice to_encrypt) {
   if (info->version == 1) {
     std::tie(info->message_ack, info->message_key) = calc_message_ack_and_key(*header, data_size);
   } else {
@@ -235,7 +243,8 @@ void Transport::write_crypto_impl(int X, const Storer &storer, const AuthKey &au
   aes_ige_encrypt(aes_key, &aes_iv, to_encrypt, to_encrypt);
 }
 
-size_t Transport::write_crypto(const Storer &storer, const AuthKey &auth_key, PacketInfo *info, MutableSlice dest) {
+size_t Transport::write_crypto(const Storer &storer, const AuthKey &auth_key, PacketInfo *info, MutableSlice dest,
+                               bool need_encrypt) {
   size_t data_size = storer.size();
   size_t size;
   if (info->version == 1) {
@@ -252,12 +261,13 @@ size_t Transport::write_crypto(const Storer &storer, const AuthKey &auth_key, Pa
   header.salt = info->salt;
   header.session_id = info->session_id;
 
-  write_crypto_impl(0, storer, auth_key, info, &header, data_size);
+  write_crypto_impl(0, storer, auth_key, info, &header, data_size, need_encrypt);
 
   return size;
 }
 
-size_t Transport::write_e2e_crypto(const Storer &storer, const AuthKey &auth_key, PacketInfo *info, MutableSlice dest) {
+size_t Transport::write_e2e_crypto(const Storer &storer, const AuthKey &auth_key, PacketInfo *info, MutableSlice dest,
+                                   bool need_encrypt) {
   size_t data_size = storer.size();
   size_t size;
   if (info->version == 1) {
@@ -272,7 +282,8 @@ size_t Transport::write_e2e_crypto(const Storer &storer, const AuthKey &auth_key
   auto &header = as<EndToEndHeader>(dest.begin());
   header.auth_key_id = auth_key.id();
 
-  write_crypto_impl(info->is_creator || info->version == 1 ? 0 : 8, storer, auth_key, info, &header, data_size);
+  write_crypto_impl(info->is_creator || info->version == 1 ? 0 : 8, storer, auth_key, info, &header, data_size,
+                    need_encrypt);
 
   return size;
 }
@@ -286,6 +297,7 @@ Result<uint64> Transport::read_auth_key_id(Slice message) {
 
 Status Transport::read(MutableSlice message, const AuthKey &auth_key, PacketInfo *info, MutableSlice *data,
                        int32 *error_code) {
+  CHECK(is_aligned_pointer<4>(message.begin()));
   if (message.size() < 8) {
     if (message.size() == 4) {
       *error_code = as<int32>(message.begin());
@@ -309,14 +321,40 @@ Status Transport::read(MutableSlice message, const AuthKey &auth_key, PacketInfo
 }
 
 size_t Transport::write(const Storer &storer, const AuthKey &auth_key, PacketInfo *info, MutableSlice dest) {
+  return write_impl(storer, auth_key, info, dest, true);
+}
+
+size_t Transport::write_unencrypted(const Storer &storer, const AuthKey &auth_key, PacketInfo *info,
+                                    MutableSlice dest) {
+  CHECK(info->version != 1);
+  return write_impl(storer, auth_key, info, dest, false);
+}
+
+void Transport::encrypt_packet(const AuthKey &auth_key, PacketInfo *info, MutableSlice packet) {
+  CHECK(info->version != 1);
+  if (info->type == PacketInfo::EndToEnd) {
+    auto &header = as<EndToEndHeader>(packet.begin());
+    encrypt_crypto_impl(info->is_creator ? 0 : 8, auth_key, info, &header, 0,
+                        MutableSlice(header.encrypt_begin(), packet.uend()));
+    return;
+  }
+  if (info->no_crypto_flag) {
+    return;
+  }
+  auto &header = as<CryptoHeader>(packet.begin());
+  encrypt_crypto_impl(0, auth_key, info, &header, 0, MutableSlice(header.encrypt_begin(), packet.uend()));
+}
+
+size_t Transport::write_impl(const Storer &storer, const AuthKey &auth_key, PacketInfo *info, MutableSlice dest,
+                             bool need_encrypt) {
   if (info->type == PacketInfo::EndToEnd) {
-    return write_e2e_crypto(storer, auth_key, info, dest);
+    return write_e2e_crypto(storer, auth_key, info, dest, need_encrypt);
   }
   if (info->no_crypto_flag) {
     return write_no_crypto(storer, info, dest);
   } else {
     CHECK(!auth_key.empty());
-    return write_crypto(storer, auth_key, info, dest);
+    return write_crypto(storer, auth_key, info, dest, need_encrypt);
   }
 }
 }  // namespace mtproto
@@ -142,6 +142,7 @@ class Transport {
   // Reads mtproto packet from [message] and saves into [data].
   // If message is encrypted, [auth_key] is used.
   // Decryption and unpacking is made inplace, so [data] will be subslice of [message].
+  // [message] must be aligned to 4 bytes, so [data] is aligned too and can be parsed in place.
   // Returns size of mtproto packet.
   // If dest.size() >= size, the packet is also written into [dest].
   // If auth_key is nonempty, encryption will be used.
@@ -151,6 +152,13 @@ class Transport {
   static size_t write(const Storer &storer, const AuthKey &auth_key, PacketInfo *info,
                       MutableSlice dest = MutableSlice());
 
+  // Same as write, but the packet is left unencrypted, and encrypt_packet must be called on it before it is sent.
+  // Encryption depends only on the packet and the key, so it can be done later from another thread.
+  // Supported only for version 2 of the protocol. message_ack and message_key are set by encrypt_packet.
+  static size_t write_unencrypted(const Storer &storer, const AuthKey &auth_key, PacketInfo *info,
+                                  MutableSlice dest = MutableSlice());
+  static void encrypt_packet(const AuthKey &auth_key, PacketInfo *info, MutableSlice packet);
+
  private:
   template <class HeaderT>
   static std::tuple<uint32, UInt128> calc_message_ack_and_key(const HeaderT &head, size_t data_size);
@@ -177,11 +185,19 @@ class Transport {
 
   static size_t write_no_crypto(const Storer &storer, PacketInfo *info, MutableSlice dest);
 
-  static size_t write_crypto(const Storer &storer, const AuthKey &auth_key, PacketInfo *info, MutableSlice dest);
-  static size_t write_e2e_crypto(const Storer &storer, const AuthKey &auth_key, PacketInfo *info, MutableSlice dest);
+  static size_t write_crypto(const Storer &storer, const AuthKey &auth_key, PacketInfo *info, MutableSlice dest,
+                             bool need_encrypt);
+  static size_t write_e2e_crypto(const Storer &storer, const AuthKey &auth_key, PacketInfo *info, MutableSlice dest,
+                                 bool need_encrypt);
   template <class HeaderT>
   static void write_crypto_impl(int X, const Storer &storer, const AuthKey &auth_key, PacketInfo *info, HeaderT *header,
-                                size_t data_size);
+                                size_t data_size, bool need_encrypt);
+  template <class HeaderT>
+  static void encrypt_crypto_impl(int X, const AuthKey &auth_key, PacketInfo *info, HeaderT *header, size_t data_size,
+                                  MutableSlice to_encrypt);
+
+  static size_t write_impl(const Storer &storer, const AuthKey &auth_key, PacketInfo *info, MutableSlice dest,
+                           bool need_encrypt);
 };
 }  // namespace mtproto
 }  // namespace td
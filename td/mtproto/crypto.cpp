@@ -408,23 +408,28 @@ void tmp_KDF(const UInt128 &server_nonce, const UInt256 &new_nonce, UInt256 *tmp
 // msg_key = substr (msg_key_large, 8, 16);
 
 void KDF2(Slice auth_key, const UInt128 &msg_key, int X, UInt256 *aes_key, UInt256 *aes_iv) {
-  uint8 buf_raw[36 + 16];
-  MutableSlice buf(buf_raw, 36 + 16);
+  uint8 buf_a_raw[16 + 36];
+  uint8 buf_b_raw[36 + 16];
+  MutableSlice buf_a(buf_a_raw, sizeof(buf_a_raw));
+  MutableSlice buf_b(buf_b_raw, sizeof(buf_b_raw));
   Slice msg_key_slice(msg_key.raw, sizeof(msg_key.raw));
 
   // sha256_a = SHA256 (msg_key + substr (auth_key, x, 36));
-  buf.copy_from(msg_key_slice);
-  buf.substr(16, 36).copy_from(auth_key.substr(X, 36));
+  buf_a.copy_from(msg_key_slice);
+  buf_a.substr(16).copy_from(auth_key.substr(X, 36));
   uint8 sha256_a_raw[32];
   MutableSlice sha256_a(sha256_a_raw, 32);
-  sha256(buf, sha256_a);
 
   // sha256_b = SHA256 (substr (auth_key, 40+x, 36) + msg_key);
-  buf.copy_from(auth_key.substr(40 + X, 36));
-  buf.substr(36).copy_from(msg_key_slice);
+  buf_b.copy_from(auth_key.substr(40 + X, 36));
+  buf_b.substr(36).copy_from(msg_key_slice);
   uint8 sha256_b_raw[32];
   MutableSlice sha256_b(sha256_b_raw, 32);
-  sha256(buf, sha256_b);
+
+  // both hashes are independent, so they can be computed simultaneously
+  const Slice data[2] = {buf_a, buf_b};
+  const MutableSlice output[2] = {sha256_a, sha256_b};
+  sha256_batch(data, output, 2);
 
   // aes_key = substr (sha256_a, 0, 8) + substr (sha256_b, 8, 16) + substr (sha256_a, 24, 8);
   MutableSlice aes_key_slice(aes_key->raw, sizeof(aes_key->raw));
@@ -6,6 +6,7 @@
 //
 #pragma once
 
+#include "td/utils/Arena.h"
 #include "td/utils/buffer.h"
 #include "td/utils/format.h"
 #include "td/utils/logging.h"
@@ -60,6 +61,14 @@ Result<typename T::ReturnType> fetch_result(const BufferSlice &message) {
   return std::move(result);
 }
 
+// for big results with many objects, which are destroyed soon after the result is processed;
+// all objects are allocated from one arena, which is released after the last of them is destroyed
+template <class T>
+Result<typename T::ReturnType> fetch_result_in_arena(const BufferSlice &message) {
+  Arena::Guard guard;
+  return fetch_result<T>(message);
+}
+
 template <class T>
 using TLStorer = DefaultStorer<T>;
 
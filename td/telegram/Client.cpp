@@ -10,13 +10,20 @@
 
 #include "td/utils/crypto.h"
 #include "td/utils/logging.h"
+#include "td/utils/misc.h"
 #include "td/utils/MpscPollableQueue.h"
 #include "td/utils/Observer.h"
+#include "td/utils/port/cpu.h"
 #include "td/utils/port/Fd.h"
 #include "td/utils/port/Poll.h"
 #include "td/utils/port/thread.h"
+#include "td/utils/Time.h"
 
+#include <algorithm>
+#include <atomic>
 #include <deque>
+#include <memory>
+#include <mutex>
 
 namespace td {
 
@@ -28,6 +35,14 @@ class Client::Impl final {
     init();
   }
 
+  static void enable_shared_scheduler(int thread_count) {
+    // all instances already run in the threads calling Client::receive
+  }
+
+  static void enable_low_latency_mode(double spin_duration) {
+    // there is nothing to wait for, all instances already run in the threads calling Client::receive
+  }
+
   void send(Request request) {
     if (request.id == 0 || request.function == nullptr) {
       LOG(ERROR) << "Drop wrong request " << request.id;
@@ -109,13 +124,14 @@ using InputQueue = MpscPollableQueue<Client::Request>;
 using OutputQueue = MpscPollableQueue<Client::Response>;
 class TdProxy : public Actor {
  public:
-  TdProxy(std::shared_ptr<InputQueue> input_queue, std::shared_ptr<OutputQueue> output_queue)
-      : input_queue_(std::move(input_queue)), output_queue_(std::move(output_queue)) {
+  TdProxy(std::shared_ptr<InputQueue> input_queue, std::shared_ptr<OutputQueue> output_queue, ActorShared<> parent)
+      : input_queue_(std::move(input_queue)), output_queue_(std::move(output_queue)), parent_(std::move(parent)) {
   }
 
  private:
   std::shared_ptr<InputQueue> input_queue_;
   std::shared_ptr<OutputQueue> output_queue_;
+  ActorShared<> parent_;  // empty if the scheduler is owned by the TdProxy
   bool is_td_closed_ = false;
   bool was_hangup_ = false;
   ActorOwn<Td> td_;
@@ -144,7 +160,7 @@ class TdProxy : public Actor {
       ActorId<TdProxy> parent_;
       std::shared_ptr<OutputQueue> output_queue_;
     };
-    td_ = create_actor<Td>("Td", make_unique<Callback>(actor_id(this), std::move(output_queue_)));
+    td_ = create_actor<Td>("Td", make_unique<Callback>(actor_id(this), output_queue_), !parent_.empty());
     yield();
   }
 
@@ -157,7 +173,12 @@ class TdProxy : public Actor {
     if (!is_td_closed_ || !was_hangup_) {
       return;
     }
-    Scheduler::instance()->finish();
+    if (parent_.empty()) {
+      Scheduler::instance()->finish();
+    } else {
+      // an empty response notifies the Client that the Td is closed
+      output_queue_->writer_put({0, nullptr});
+    }
     stop();
   }
 
@@ -190,6 +211,153 @@ class TdProxy : public Actor {
   }
 };
 
+/*** TdProxyCreator ***/
+struct NewClient {
+  std::shared_ptr<InputQueue> input_queue;
+  std::shared_ptr<OutputQueue> output_queue;
+};
+using NewClientQueue = MpscPollableQueue<NewClient>;
+class TdProxyCreator : public Actor {
+ public:
+  explicit TdProxyCreator(std::shared_ptr<NewClientQueue> new_client_queue)
+      : new_client_queue_(std::move(new_client_queue)) {
+  }
+
+ private:
+  std::shared_ptr<NewClientQueue> new_client_queue_;
+  std::vector<int32> td_count_;
+
+  void start_up() override {
+    td_count_.resize(Scheduler::instance()->sched_count(), 0);
+
+    auto &fd = new_client_queue_->reader_get_event_fd();
+    fd.get_fd().set_observer(this);
+    ::td::subscribe(fd.get_fd(), Fd::Read);
+    yield();
+  }
+
+  int32 choose_scheduler() const {
+    int32 best_sched_id = 0;
+    for (int32 sched_id = 1; sched_id < static_cast<int32>(td_count_.size()); sched_id++) {
+      if (td_count_[sched_id] < td_count_[best_sched_id]) {
+        best_sched_id = sched_id;
+      }
+    }
+    return best_sched_id;
+  }
+
+  void loop() override {
+    while (true) {
+      int size = new_client_queue_->reader_wait_nonblock();
+      if (size == 0) {
+        return;
+      }
+      for (int i = 0; i < size; i++) {
+        auto client = new_client_queue_->reader_get_unsafe();
+        if (client.input_queue == nullptr) {
+          Scheduler::instance()->finish();
+          return stop();
+        }
+
+        auto sched_id = choose_scheduler();
+        td_count_[sched_id]++;
+        VLOG(td_requests) << "Create TdProxy on scheduler " << sched_id << " with " << td_count_[sched_id]
+                          << " instances";
+        create_actor_on_scheduler<TdProxy>("TdProxy", sched_id, std::move(client.input_queue),
+                                           std::move(client.output_queue), actor_shared(this, sched_id))
+            .release();
+      }
+    }
+  }
+
+  void hangup_shared() override {
+    auto sched_id = narrow_cast<int32>(get_link_token());
+    CHECK(td_count_[sched_id] > 0);
+    td_count_[sched_id]--;
+  }
+
+  void hangup() override {
+    UNREACHABLE();
+  }
+
+  void tear_down() override {
+    auto &fd = new_client_queue_->reader_get_event_fd();
+    ::td::unsubscribe(fd.get_fd());
+    fd.get_fd().set_observer(nullptr);
+  }
+};
+
+// maximum time for which Client::receive and TDLib threads busy-wait for new data; 0 if low-latency mode is disabled
+static std::atomic<double> low_latency_spin_duration{0.0};
+
+/*** SharedScheduler ***/
+class SharedScheduler {
+ public:
+  explicit SharedScheduler(int32 thread_count) {
+    new_client_queue_ = std::make_shared<NewClientQueue>();
+    new_client_queue_->init();
+
+    auto scheduler = std::make_shared<ConcurrentScheduler>();
+    scheduler->init(thread_count - 1);
+    scheduler->set_spin_poll_duration(low_latency_spin_duration.load(std::memory_order_relaxed));
+    scheduler->create_actor_unsafe<TdProxyCreator>(0, "TdProxyCreator", new_client_queue_).release();
+    scheduler->start();
+
+    scheduler_thread_ = thread([scheduler = std::move(scheduler)] {
+      while (scheduler->run_main(10)) {
+      }
+      scheduler->finish();
+    });
+  }
+  SharedScheduler(const SharedScheduler &) = delete;
+  SharedScheduler &operator=(const SharedScheduler &) = delete;
+  SharedScheduler(SharedScheduler &&) = delete;
+  SharedScheduler &operator=(SharedScheduler &&) = delete;
+
+  ~SharedScheduler() {
+    new_client_queue_->writer_put({nullptr, nullptr});
+    scheduler_thread_.join();
+  }
+
+  void add_client(std::shared_ptr<InputQueue> input_queue, std::shared_ptr<OutputQueue> output_queue) {
+    new_client_queue_->writer_put({std::move(input_queue), std::move(output_queue)});
+  }
+
+  static void enable(int32 thread_count) {
+    if (thread_count <= 0) {
+      thread_count = std::max(static_cast<int32>(thread::hardware_concurrency()), 4);
+    }
+    std::lock_guard<std::mutex> guard(mutex_);
+    thread_count_ = thread_count;
+  }
+
+  // returns nullptr if the shared scheduler isn't enabled
+  static std::shared_ptr<SharedScheduler> get() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (thread_count_ == 0) {
+      return nullptr;
+    }
+    auto result = instance_.lock();
+    if (result == nullptr) {
+      result = std::make_shared<SharedScheduler>(thread_count_);
+      instance_ = result;
+    }
+    return result;
+  }
+
+ private:
+  std::shared_ptr<NewClientQueue> new_client_queue_;
+  thread scheduler_thread_;
+
+  static std::mutex mutex_;
+  static int32 thread_count_;
+  static std::weak_ptr<SharedScheduler> instance_;
+};
+
+std::mutex SharedScheduler::mutex_;
+int32 SharedScheduler::thread_count_ = 0;
+std::weak_ptr<SharedScheduler> SharedScheduler::instance_;
+
 /*** Client::Impl ***/
 class Client::Impl final : ObserverBase {
  public:
@@ -197,6 +365,14 @@ class Client::Impl final : ObserverBase {
     init();
   }
 
+  static void enable_shared_scheduler(int thread_count) {
+    SharedScheduler::enable(thread_count);
+  }
+
+  static void enable_low_latency_mode(double spin_duration) {
+    low_latency_spin_duration.store(std::max(spin_duration, 0.0), std::memory_order_relaxed);
+  }
+
   void send(Request request) {
     if (request.id == 0 || request.function == nullptr) {
       LOG(ERROR) << "Drop wrong request " << request.id;
@@ -215,6 +391,13 @@ class Client::Impl final : ObserverBase {
       return output_queue_->reader_get_unsafe();
     }
     if (timeout != 0) {
+      if (spin_duration_ > 0) {
+        auto spin_duration = std::min(timeout, spin_duration_);
+        if (spin_output_queue(spin_duration)) {
+          return receive(0);
+        }
+        timeout -= spin_duration;
+      }
       poll_.run(static_cast<int>(timeout * 1000));
       return receive(0);
     }
@@ -223,7 +406,25 @@ class Client::Impl final : ObserverBase {
 
   ~Impl() {
     input_queue_->writer_put({0, nullptr});
-    scheduler_thread_.join();
+    if (shared_scheduler_ == nullptr) {
+      scheduler_thread_.join();
+      return;
+    }
+
+    // wait until TdProxy reports that the Td is closed, dropping all remaining updates
+    while (true) {
+      if (output_queue_ready_cnt_ == 0) {
+        output_queue_ready_cnt_ = output_queue_->reader_wait_nonblock();
+      }
+      if (output_queue_ready_cnt_ == 0) {
+        poll_.run(10000);
+        continue;
+      }
+      output_queue_ready_cnt_--;
+      if (output_queue_->reader_get_unsafe().object == nullptr) {
+        break;
+      }
+    }
   }
 
  private:
@@ -231,25 +432,50 @@ class Client::Impl final : ObserverBase {
   std::shared_ptr<InputQueue> input_queue_;
   std::shared_ptr<OutputQueue> output_queue_;
   std::shared_ptr<ConcurrentScheduler> scheduler_;
+  std::shared_ptr<SharedScheduler> shared_scheduler_;
   int output_queue_ready_cnt_{0};
   thread scheduler_thread_;
   bool notify_flag_{false};
+  double spin_duration_{0};
+
+  bool spin_output_queue(double spin_duration) {
+    double end_time = Time::now() + spin_duration;
+    while (true) {
+      for (int i = 0; i < 64; i++) {
+        if (output_queue_->reader_has_values()) {
+          return true;
+        }
+        cpu_relax();
+      }
+      if (Time::now() >= end_time) {
+        return false;
+      }
+    }
+  }
 
   void init() {
+    spin_duration_ = low_latency_spin_duration.load(std::memory_order_relaxed);
     input_queue_ = std::make_shared<InputQueue>();
     input_queue_->init();
     output_queue_ = std::make_shared<OutputQueue>();
     output_queue_->init();
-    scheduler_ = std::make_shared<ConcurrentScheduler>();
-    scheduler_->init(3);
-    scheduler_->create_actor_unsafe<TdProxy>(0, "TdProxy", input_queue_, output_queue_).release();
-    scheduler_->start();
 
-    scheduler_thread_ = thread([scheduler = scheduler_] {
-      while (scheduler->run_main(10)) {
-      }
-      scheduler->finish();
-    });
+    shared_scheduler_ = SharedScheduler::get();
+    if (shared_scheduler_ != nullptr) {
+      shared_scheduler_->add_client(input_queue_, output_queue_);
+    } else {
+      scheduler_ = std::make_shared<ConcurrentScheduler>();
+      scheduler_->init(3);
+      scheduler_->set_spin_poll_duration(spin_duration_);
+      scheduler_->create_actor_unsafe<TdProxy>(0, "TdProxy", input_queue_, output_queue_, ActorShared<>()).release();
+      scheduler_->start();
+
+      scheduler_thread_ = thread([scheduler = scheduler_] {
+        while (scheduler->run_main(10)) {
+        }
+        scheduler->finish();
+      });
+    }
 
     poll_.init();
     auto &event_fd = output_queue_->reader_get_event_fd();
@@ -277,6 +503,14 @@ Client::Response Client::receive(double timeout) {
   return impl_->receive(timeout);
 }
 
+void Client::enable_shared_scheduler(int thread_count) {
+  Impl::enable_shared_scheduler(thread_count);
+}
+
+void Client::enable_low_latency_mode(double spin_duration) {
+  Impl::enable_low_latency_mode(spin_duration);
+}
+
 Client::Response Client::execute(Request request) {
   Response response;
   response.id = request.id;
@@ -111,6 +111,23 @@ class Client final {
    */
   static Response execute(Request request);
 
+  /**
+   * Makes all Client instances created after the call share one process-wide pool of TDLib threads instead of
+   * creating 4 dedicated threads per instance. Recommended for applications hosting many accounts at once.
+   * Must be called before creation of the Client instances, which are supposed to use the pool.
+   * The option "scheduler_thread_settings" can't be used by the Client instances sharing the pool.
+   * \param[in] thread_count Number of threads in the shared pool; 0 chooses it based on the number of CPU cores.
+   */
+  static void enable_shared_scheduler(int thread_count = 0);
+
+  /**
+   * Enables low-latency mode for all Client instances created after the call. In this mode TDLib threads and
+   * Client::receive busy-wait for new requests and responses for up to spin_duration seconds before blocking,
+   * which avoids thread wakeup delays at the cost of higher CPU usage.
+   * \param[in] spin_duration Maximum number of seconds to busy-wait; 0 disables the low-latency mode.
+   */
+  static void enable_low_latency_mode(double spin_duration);
+
   /**
    * Destroys the client and TDLib instance.
    */
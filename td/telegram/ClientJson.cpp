@@ -15,33 +15,42 @@
 #include "td/utils/JsonBuilder.h"
 #include "td/utils/logging.h"
 #include "td/utils/Status.h"
+#include "td/utils/StringBuilder.h"
 
 #include <algorithm>
+#include <cstring>
 
 namespace td {
 
 Result<Client::Request> ClientJson::to_request(Slice request) {
   auto request_str = request.str();
-  TRY_RESULT(json_value, json_decode(request_str));
-  if (json_value.type() != JsonValue::Type::Object) {
+  JsonPullParser parser(request_str);
+  if (parser.peek_type() != JsonValue::Type::Object) {
     return Status::Error("Expected an object");
   }
-  TRY_RESULT(extra_field, get_json_object_field(json_value.get_object(), "@extra", JsonValue::Type::Null, true));
+  TRY_RESULT(extra_value_str, parser.find_object_field("@extra"));
+
+  td_api::object_ptr<td_api::Function> func;
+  TRY_STATUS(from_json(func, parser));
+  TRY_STATUS(parser.finish());
+
+  // "@extra" was only skipped by the parser, so it can be decoded in place now
+  JsonValue extra_value;
+  if (!extra_value_str.empty()) {
+    TRY_RESULT(value, json_decode(extra_value_str));
+    extra_value = std::move(value);
+  }
   std::uint64_t extra_id = extra_id_.fetch_add(1, std::memory_order_relaxed);
-  auto extra_str = json_encode<string>(extra_field);
+  auto extra_str = json_encode<string>(extra_value);
   if (!extra_str.empty()) {
     std::lock_guard<std::mutex> guard(mutex_);
     extra_[extra_id] = std::move(extra_str);
   }
-
-  td_api::object_ptr<td_api::Function> func;
-  TRY_STATUS(from_json(func, json_value));
   return Client::Request{extra_id, std::move(func)};
 }
 
-std::string ClientJson::from_response(Client::Response response) {
-  auto str = json_encode<string>(ToJson(static_cast<td_api::Object &>(*response.object)));
-  CHECK(!str.empty() && str.back() == '}');
+TD_THREAD_LOCAL std::string *ClientJson::current_output_;
+CSlice ClientJson::from_response(Client::Response response) {
   std::string extra;
   if (response.id != 0) {
     std::lock_guard<std::mutex> guard(mutex_);
@@ -51,21 +60,40 @@ std::string ClientJson::from_response(Client::Response response) {
       extra_.erase(it);
     }
   }
-  if (!extra.empty()) {
-    str.pop_back();
-    str.reserve(str.size() + 10 + extra.size());
-    str += ",\"@extra\":";
-    str += extra;
-    str += "}";
+
+  // the response is written directly to the reusable per-thread buffer, which grows when it is too small;
+  // space for ",\"@extra\":<extra>" is reserved at its end, so "@extra" can be inserted without moving the object
+  const size_t MIN_OUTPUT_SIZE = 1 << 12;
+  auto extra_size = extra.empty() ? static_cast<size_t>(0) : extra.size() + 10;
+  init_thread_local<std::string>(current_output_);
+  auto &output = *current_output_;
+  if (output.size() < extra_size + MIN_OUTPUT_SIZE) {
+    output.resize(extra_size + MIN_OUTPUT_SIZE);
+  }
+  size_t size;
+  while (true) {
+    JsonBuilder jb(StringBuilder(MutableSlice(&output[0], output.size() - extra_size)));
+    jb.enter_value() << ToJson(static_cast<td_api::Object &>(*response.object));
+    if (!jb.string_builder().is_error()) {
+      auto object = jb.string_builder().as_cslice();
+      CHECK(!object.empty() && object.back() == '}');
+      size = object.size();
+      break;
+    }
+    auto new_size = output.size() * 2;
+    output.clear();  // there is no need to copy the data
+    output.resize(new_size);
   }
-  return str;
-}
 
-TD_THREAD_LOCAL std::string *ClientJson::current_output_;
-CSlice ClientJson::store_string(std::string str) {
-  init_thread_local<std::string>(ClientJson::current_output_);
-  *current_output_ = std::move(str);
-  return *current_output_;
+  if (!extra.empty()) {
+    auto *ptr = &output[size - 1];
+    std::memcpy(ptr, ",\"@extra\":", 10);
+    std::memcpy(ptr + 10, extra.data(), extra.size());
+    size += extra_size;
+    output[size - 1] = '}';
+    output[size] = '\0';
+  }
+  return CSlice(output.data(), output.data() + size);
 }
 
 void ClientJson::send(Slice request) {
@@ -83,7 +111,7 @@ CSlice ClientJson::receive(double timeout) {
   if (!response.object) {
     return {};
   }
-  return store_string(from_response(std::move(response)));
+  return from_response(std::move(response));
 }
 
 CSlice ClientJson::execute(Slice request) {
@@ -93,7 +121,7 @@ CSlice ClientJson::execute(Slice request) {
     return {};
   }
 
-  return store_string(from_response(Client::execute(r_request.move_as_ok())));
+  return from_response(Client::execute(r_request.move_as_ok()));
 }
 
 }  // namespace td
@@ -36,9 +36,7 @@ class ClientJson final {
   std::atomic<std::uint64_t> extra_id_{1};
   static TD_THREAD_LOCAL std::string *current_output_;
 
-  CSlice store_string(std::string str);
-
   Result<Client::Request> to_request(Slice request);
-  std::string from_response(Client::Response response);
+  CSlice from_response(Client::Response response);
 };
 }  // namespace td
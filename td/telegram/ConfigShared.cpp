@@ -81,6 +81,18 @@ int32 ConfigShared::get_option_integer(Slice name, int32 default_value) const {
   return to_integer<int32>(str_value.substr(1));
 }
 
+string ConfigShared::get_option_string(Slice name, string default_value) const {
+  auto str_value = get_option(name);
+  if (str_value.empty()) {
+    return default_value;
+  }
+  if (str_value[0] != 'S') {
+    LOG(ERROR) << "Found \"" << str_value << "\" instead of string option";
+    return default_value;
+  }
+  return str_value.substr(1);
+}
+
 tl_object_ptr<td_api::OptionValue> ConfigShared::get_option_value(Slice value) const {
   return get_option_value_object(get_option(value));
 }
@@ -40,6 +40,7 @@ class ConfigShared {
 
   bool get_option_boolean(Slice name) const;
   int32 get_option_integer(Slice name, int32 default_value = 0) const;
+  string get_option_string(Slice name, string default_value = "") const;
 
   tl_object_ptr<td_api::OptionValue> get_option_value(Slice value) const;
 
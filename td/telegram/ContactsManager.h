@@ -29,6 +29,7 @@
 #include "td/telegram/UserId.h"
 
 #include "td/utils/common.h"
+#include "td/utils/FlatHashMap.h"
 #include "td/utils/Hints.h"
 #include "td/utils/Slice.h"
 #include "td/utils/Status.h"
@@ -970,14 +971,14 @@ class ContactsManager : public Actor {
   UserId my_id_;
   UserId support_user_id_;
 
-  std::unordered_map<UserId, User, UserIdHash> users_;
+  FlatHashMapNodeStable<UserId, User, UserIdHash> users_;
   std::unordered_map<UserId, UserFull, UserIdHash> users_full_;
 
-  std::unordered_map<ChatId, Chat, ChatIdHash> chats_;
+  FlatHashMapNodeStable<ChatId, Chat, ChatIdHash> chats_;
   std::unordered_map<ChatId, ChatFull, ChatIdHash> chats_full_;
 
   std::unordered_set<ChannelId, ChannelIdHash> min_channels_;
-  std::unordered_map<ChannelId, Channel, ChannelIdHash> channels_;
+  FlatHashMapNodeStable<ChannelId, Channel, ChannelIdHash> channels_;
   std::unordered_map<ChannelId, ChannelFull, ChannelIdHash> channels_full_;
 
   std::unordered_map<SecretChatId, SecretChat, SecretChatIdHash> secret_chats_;
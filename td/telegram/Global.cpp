@@ -21,8 +21,6 @@
 #include "td/utils/port/Clocks.h"
 #include "td/utils/tl_helpers.h"
 
-#include <algorithm>
-
 namespace td {
 
 Global::Global() = default;
@@ -64,8 +62,11 @@ void Global::set_mtproto_header(std::unique_ptr<MtprotoHeader> mtproto_header) {
 Status Global::init(const TdParameters &parameters, ActorId<Td> td, std::unique_ptr<TdDb> td_db) {
   parameters_ = parameters;
 
-  gc_scheduler_id_ = std::min(Scheduler::instance()->sched_id() + 2, Scheduler::instance()->sched_count() - 1);
-  slow_net_scheduler_id_ = std::min(Scheduler::instance()->sched_id() + 3, Scheduler::instance()->sched_count() - 1);
+  // schedulers are chosen relatively to the Td scheduler, so Td instances sharing a scheduler pool spread their load
+  auto sched_id = Scheduler::instance()->sched_id();
+  auto sched_count = Scheduler::instance()->sched_count();
+  gc_scheduler_id_ = (sched_id + 2) % sched_count;
+  slow_net_scheduler_id_ = (sched_id + 3) % sched_count;
 
   td_ = td;
   td_db_ = std::move(td_db);
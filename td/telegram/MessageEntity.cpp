@@ -12,11 +12,15 @@
 #include "td/utils/HttpUrl.h"
 #include "td/utils/logging.h"
 #include "td/utils/misc.h"
+#include "td/utils/port/cpu.h"
 #include "td/utils/unicode.h"
 #include "td/utils/utf8.h"
 
+#if TD_HAVE_SSE2
+#include <emmintrin.h>
+#endif
+
 #include <algorithm>
-#include <cstring>
 #include <tuple>
 #include <unordered_set>
 
@@ -159,9 +163,61 @@ static bool is_alpha_digit_or_underscore_or_minus(uint32 a) {
   return is_alpha_digit_or_underscore(a) || a == '-';
 }
 
+static bool is_entity_candidate(unsigned char c) {
+  return c == '@' || c == '/' || c == '#' || c == '.';
+}
+
+#if TD_HAVE_SSE2
+static int32 count_trailing_zeros(uint32 x) {
+#if TD_GCC || TD_CLANG
+  return __builtin_ctz(x);
+#else
+  int32 res = 0;
+  while ((x & 1) == 0) {
+    x >>= 1;
+    res++;
+  }
+  return res;
+#endif
+}
+#endif
+
+// finds in one pass positions of all characters, from which search of entities starts:
+// '@' for mentions, '/' for bot commands, '#' for hashtags and '.' for URLs and email addresses
+static vector<const unsigned char *> find_entity_candidates(Slice str) {
+  vector<const unsigned char *> candidates;
+  const unsigned char *ptr = str.ubegin();
+  const unsigned char *end = str.uend();
+
+#if TD_HAVE_SSE2
+  const __m128i at_sign = _mm_set1_epi8('@');
+  const __m128i slash = _mm_set1_epi8('/');
+  const __m128i number_sign = _mm_set1_epi8('#');
+  const __m128i dot = _mm_set1_epi8('.');
+  while (end - ptr >= 16) {
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr));
+    __m128i matches = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, at_sign), _mm_cmpeq_epi8(block, slash)),
+                                   _mm_or_si128(_mm_cmpeq_epi8(block, number_sign), _mm_cmpeq_epi8(block, dot)));
+    auto mask = static_cast<uint32>(_mm_movemask_epi8(matches));
+    while (mask != 0) {
+      candidates.push_back(ptr + count_trailing_zeros(mask));
+      mask &= mask - 1;
+    }
+    ptr += 16;
+  }
+#endif
+
+  for (; ptr != end; ptr++) {
+    if (is_entity_candidate(*ptr)) {
+      candidates.push_back(ptr);
+    }
+  }
+  return candidates;
+}
+
 // This functions just implements corresponding regexps
 // All other fixes will be in other functions
-static vector<Slice> match_mentions(Slice str) {
+static vector<Slice> match_mentions(Slice str, const vector<const unsigned char *> &candidates) {
   vector<Slice> result;
   const unsigned char *begin = str.ubegin();
   const unsigned char *end = str.uend();
@@ -169,11 +225,11 @@ static vector<Slice> match_mentions(Slice str) {
 
   // '/(?<=\B)@([a-zA-Z0-9_]{2,32})(?=\b)/u'
 
-  while (true) {
-    ptr = reinterpret_cast<const unsigned char *>(std::memchr(ptr, '@', narrow_cast<int32>(end - ptr)));
-    if (ptr == nullptr) {
-      break;
+  for (auto candidate : candidates) {
+    if (candidate < ptr || *candidate != '@') {
+      continue;
     }
+    ptr = candidate;
 
     uint32 prev = 0;
     if (ptr != begin) {
@@ -204,7 +260,7 @@ static vector<Slice> match_mentions(Slice str) {
   return result;
 }
 
-static vector<Slice> match_bot_commands(Slice str) {
+static vector<Slice> match_bot_commands(Slice str, const vector<const unsigned char *> &candidates) {
   vector<Slice> result;
   const unsigned char *begin = str.ubegin();
   const unsigned char *end = str.uend();
@@ -212,11 +268,11 @@ static vector<Slice> match_bot_commands(Slice str) {
 
   // '/(?<!\b|[\/<>])\/([a-zA-Z0-9_]{1,64})(?:@([a-zA-Z0-9_]{3,32}))?(?!\B|[\/<>])/u'
 
-  while (true) {
-    ptr = reinterpret_cast<const unsigned char *>(std::memchr(ptr, '/', narrow_cast<int32>(end - ptr)));
-    if (ptr == nullptr) {
-      break;
+  for (auto candidate : candidates) {
+    if (candidate < ptr || *candidate != '/') {
+      continue;
     }
+    ptr = candidate;
 
     uint32 prev = 0;
     if (ptr != begin) {
@@ -262,7 +318,7 @@ static vector<Slice> match_bot_commands(Slice str) {
   return result;
 }
 
-static vector<Slice> match_hashtags(Slice str) {
+static vector<Slice> match_hashtags(Slice str, const vector<const unsigned char *> &candidates) {
   vector<Slice> result;
   const unsigned char *begin = str.ubegin();
   const unsigned char *end = str.uend();
@@ -286,11 +342,11 @@ static vector<Slice> match_hashtags(Slice str) {
     }
   };
 
-  while (true) {
-    ptr = reinterpret_cast<const unsigned char *>(std::memchr(ptr, '#', narrow_cast<int32>(end - ptr)));
-    if (ptr == nullptr) {
-      break;
+  for (auto candidate : candidates) {
+    if (candidate < ptr || *candidate != '#') {
+      continue;
     }
+    ptr = candidate;
 
     uint32 prev = 0;
     if (ptr != begin) {
@@ -337,7 +393,7 @@ static vector<Slice> match_hashtags(Slice str) {
   return result;
 }
 
-static vector<Slice> match_urls(Slice str) {
+static vector<Slice> match_urls(Slice str, const vector<const unsigned char *> &candidates) {
   vector<Slice> result;
   const unsigned char *begin = str.ubegin();
   const unsigned char *end = str.uend();
@@ -406,11 +462,25 @@ static vector<Slice> match_urls(Slice str) {
 
   Slice bad_path_end_chars(".:;,('?!");
 
+  size_t candidate_pos = 0;
   while (true) {
-    auto dot_pos = str.find('.');
-    if (dot_pos > str.size()) {
+    while (candidate_pos < candidates.size() &&
+           (candidates[candidate_pos] < begin || *candidates[candidate_pos] != '.')) {
+      candidate_pos++;
+    }
+    if (candidate_pos == candidates.size()) {
       break;
     }
+    auto dot_pos = static_cast<size_t>(candidates[candidate_pos] - begin);
+
+    // fast path for dots at the end of sentences; the same result would be returned by the full check below
+    const unsigned char *after_dot_ptr = begin + dot_pos + 1;
+    if (after_dot_ptr == end || after_dot_ptr[0] == ' ' || after_dot_ptr[0] == '\n' || after_dot_ptr[0] == ')' ||
+        after_dot_ptr[0] == '"' || after_dot_ptr[0] == '\'') {
+      str = str.substr(dot_pos + 1);
+      begin = after_dot_ptr;
+      continue;
+    }
 
     const unsigned char *last_at_ptr = nullptr;
     const unsigned char *domain_end_ptr = begin + dot_pos;
@@ -873,8 +943,8 @@ const std::unordered_set<Slice, SliceHash> &get_valid_short_usernames() {
   return valid_usernames;
 }
 
-vector<Slice> find_mentions(Slice str) {
-  auto mentions = match_mentions(str);
+static vector<Slice> find_mentions(Slice str, const vector<const unsigned char *> &candidates) {
+  auto mentions = match_mentions(str, candidates);
   mentions.erase(std::remove_if(mentions.begin(), mentions.end(),
                                 [](Slice mention) {
                                   mention.remove_prefix(1);
@@ -887,17 +957,9 @@ vector<Slice> find_mentions(Slice str) {
   return mentions;
 }
 
-vector<Slice> find_bot_commands(Slice str) {
-  return match_bot_commands(str);
-}
-
-vector<Slice> find_hashtags(Slice str) {
-  return match_hashtags(str);
-}
-
-vector<std::pair<Slice, bool>> find_urls(Slice str) {
+static vector<std::pair<Slice, bool>> find_urls(Slice str, const vector<const unsigned char *> &candidates) {
   vector<std::pair<Slice, bool>> result;
-  for (auto url : match_urls(str)) {
+  for (auto url : match_urls(str, candidates)) {
     if (is_email_address(url)) {
       result.emplace_back(url, true);
     } else {
@@ -910,6 +972,22 @@ vector<std::pair<Slice, bool>> find_urls(Slice str) {
   return result;
 }
 
+vector<Slice> find_mentions(Slice str) {
+  return find_mentions(str, find_entity_candidates(str));
+}
+
+vector<Slice> find_bot_commands(Slice str) {
+  return match_bot_commands(str, find_entity_candidates(str));
+}
+
+vector<Slice> find_hashtags(Slice str) {
+  return match_hashtags(str, find_entity_candidates(str));
+}
+
+vector<std::pair<Slice, bool>> find_urls(Slice str) {
+  return find_urls(str, find_entity_candidates(str));
+}
+
 void fix_entities(vector<MessageEntity> &entities) {
   if (entities.empty()) {
     return;
@@ -934,8 +1012,9 @@ void fix_entities(vector<MessageEntity> &entities) {
 vector<MessageEntity> find_entities(Slice text, bool skip_bot_commands, bool only_urls) {
   vector<MessageEntity> entities;
 
+  auto candidates = find_entity_candidates(text);
   if (!only_urls) {
-    auto mentions = find_mentions(text);
+    auto mentions = find_mentions(text, candidates);
     for (auto &mention : mentions) {
       entities.emplace_back(MessageEntity::Type::Mention, narrow_cast<int32>(mention.begin() - text.begin()),
                             narrow_cast<int32>(mention.size()));
@@ -943,7 +1022,7 @@ vector<MessageEntity> find_entities(Slice text, bool skip_bot_commands, bool onl
   }
 
   if (!skip_bot_commands && !only_urls) {
-    auto bot_commands = find_bot_commands(text);
+    auto bot_commands = match_bot_commands(text, candidates);
     for (auto &bot_command : bot_commands) {
       entities.emplace_back(MessageEntity::Type::BotCommand, narrow_cast<int32>(bot_command.begin() - text.begin()),
                             narrow_cast<int32>(bot_command.size()));
@@ -951,14 +1030,14 @@ vector<MessageEntity> find_entities(Slice text, bool skip_bot_commands, bool onl
   }
 
   if (!only_urls) {
-    auto hashtags = find_hashtags(text);
+    auto hashtags = match_hashtags(text, candidates);
     for (auto &hashtag : hashtags) {
       entities.emplace_back(MessageEntity::Type::Hashtag, narrow_cast<int32>(hashtag.begin() - text.begin()),
                             narrow_cast<int32>(hashtag.size()));
     }
   }
 
-  auto urls = find_urls(text);
+  auto urls = find_urls(text, candidates);
   for (auto &url : urls) {
     // TODO better find messageEntityUrl
     auto type = url.second ? MessageEntity::Type::EmailAddress : MessageEntity::Type::Url;
@@ -983,31 +1062,17 @@ vector<MessageEntity> find_entities(Slice text, bool skip_bot_commands, bool onl
 
   int32 utf16_pos = 0;
   for (auto &entity : entities) {
-    int cnt = 2;
-    auto entity_begin = entity.offset;
-    auto entity_end = entity.offset + entity.length;
-
-    int32 pos = static_cast<int32>(ptr - begin);
-    if (entity_begin == pos) {
-      cnt--;
-      entity.offset = utf16_pos;
-    }
-
-    while (ptr != end && cnt > 0) {
-      unsigned char c = ptr[0];
-      utf16_pos += 1 + (c >= 0xf0);
-      ptr = next_utf8_unsafe(ptr, nullptr);
-
-      pos = static_cast<int32>(ptr - begin);
-      if (entity_begin == pos) {
-        cnt--;
-        entity.offset = utf16_pos;
-      } else if (entity_end == pos) {
-        cnt--;
-        entity.length = utf16_pos - entity.offset;
-      }
-    }
-    CHECK(cnt == 0);
+    auto entity_begin = begin + entity.offset;
+    auto entity_end = entity_begin + entity.length;
+    CHECK(ptr <= entity_begin && entity_begin < entity_end && entity_end <= end);
+    CHECK(is_utf8_character_first_code_unit(*entity_begin));
+    CHECK(entity_end == end || is_utf8_character_first_code_unit(*entity_end));
+
+    utf16_pos += narrow_cast<int32>(utf8_utf16_length(Slice(ptr, entity_begin)));
+    entity.offset = utf16_pos;
+    utf16_pos += narrow_cast<int32>(utf8_utf16_length(Slice(entity_begin, entity_end)));
+    entity.length = utf16_pos - entity.offset;
+    ptr = entity_end;
   }
 
   return entities;
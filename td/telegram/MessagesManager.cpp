@@ -433,7 +433,7 @@ class GetDialogListQuery : public NetActorOnce {
   }
 
   void on_result(uint64 id, BufferSlice packet) override {
-    auto result_ptr = fetch_result<telegram_api::messages_getDialogs>(packet);
+    auto result_ptr = fetch_result_in_arena<telegram_api::messages_getDialogs>(packet);
     if (result_ptr.is_error()) {
       return on_error(id, result_ptr.move_as_error());
     }
@@ -1044,7 +1044,7 @@ class GetDialogMessageByDateQuery : public Td::ResultHandler {
   }
 
   void on_result(uint64 id, BufferSlice packet) override {
-    auto result_ptr = fetch_result<telegram_api::messages_getHistory>(packet);
+    auto result_ptr = fetch_result_in_arena<telegram_api::messages_getHistory>(packet);
     if (result_ptr.is_error()) {
       return on_error(id, result_ptr.move_as_error());
     }
@@ -1139,7 +1139,7 @@ class GetHistoryQuery : public Td::ResultHandler {
   }
 
   void on_result(uint64 id, BufferSlice packet) override {
-    auto result_ptr = fetch_result<telegram_api::messages_getHistory>(packet);
+    auto result_ptr = fetch_result_in_arena<telegram_api::messages_getHistory>(packet);
     if (result_ptr.is_error()) {
       return on_error(id, result_ptr.move_as_error());
     }
@@ -1330,7 +1330,7 @@ class SearchMessagesQuery : public Td::ResultHandler {
     static_assert(std::is_same<telegram_api::messages_getUnreadMentions::ReturnType,
                                telegram_api::messages_search::ReturnType>::value,
                   "");
-    auto result_ptr = fetch_result<telegram_api::messages_search>(packet);
+    auto result_ptr = fetch_result_in_arena<telegram_api::messages_search>(packet);
     if (result_ptr.is_error()) {
       return on_error(id, result_ptr.move_as_error());
     }
@@ -3104,7 +3104,7 @@ class GetChannelDifferenceQuery : public Td::ResultHandler {
   }
 
   void on_result(uint64 id, BufferSlice packet) override {
-    auto result_ptr = fetch_result<telegram_api::updates_getChannelDifference>(packet);
+    auto result_ptr = fetch_result_in_arena<telegram_api::updates_getChannelDifference>(packet);
     if (result_ptr.is_error()) {
       return on_error(id, result_ptr.move_as_error());
     }
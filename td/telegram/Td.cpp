@@ -3498,6 +3498,10 @@ class GetTermsOfServiceRequest : public RequestActor<string> {
 Td::Td(std::unique_ptr<TdCallback> callback) : callback_(std::move(callback)) {
 }
 
+Td::Td(std::unique_ptr<TdCallback> callback, bool is_scheduler_shared)
+    : callback_(std::move(callback)), is_scheduler_shared_(is_scheduler_shared) {
+}
+
 void Td::on_alarm_timeout_callback(void *td_ptr, int64 request_id) {
   auto td = static_cast<Td *>(td_ptr);
   auto td_id = td->actor_id(td);
@@ -3688,6 +3692,88 @@ void Td::on_result(NetQueryPtr query) {
   handler->on_result(std::move(query));
 }
 
+namespace {
+// parses value of the option "scheduler_thread_settings", which is a ';'-separated list of entries
+// "<role>:<CPU list>[:<priority>]", for example "database:0-3;slow_net:4-7:10", where role is one of main, database,
+// gc and slow_net, and CPU list is a ','-separated list of CPU numbers and ranges; CPU list can be empty
+// returns scheduler offsets from the scheduler of Td with corresponding settings
+Result<vector<std::pair<int32, SchedulerThreadSettings>>> parse_scheduler_thread_settings(Slice str) {
+  static const Slice roles[] = {"main", "database", "gc", "slow_net"};
+
+  vector<std::pair<int32, SchedulerThreadSettings>> result;
+  for (auto entry : full_split(str, ';')) {
+    if (entry.empty()) {
+      continue;
+    }
+    auto parts = full_split(entry, ':');
+    if (parts.size() < 2 || parts.size() > 3) {
+      return Status::Error(PSLICE() << "Wrong entry \"" << entry << '"');
+    }
+
+    int32 offset = -1;
+    for (int32 i = 0; i < 4; i++) {
+      if (parts[0] == roles[i]) {
+        offset = i;
+      }
+    }
+    if (offset == -1) {
+      return Status::Error(PSLICE() << "Unknown scheduler role \"" << parts[0] << '"');
+    }
+
+    SchedulerThreadSettings settings;
+    settings.name = PSTRING() << "td_" << parts[0];
+    for (auto range : full_split(parts[1], ',')) {
+      if (range.empty()) {
+        continue;
+      }
+      auto range_parts = split(range, '-');
+      TRY_RESULT(first, to_integer_safe<int32>(range_parts.first));
+      auto last = first;
+      if (!range_parts.second.empty()) {
+        TRY_RESULT(range_end, to_integer_safe<int32>(range_parts.second));
+        last = range_end;
+      }
+      if (first < 0 || last < first || last >= 1024) {
+        return Status::Error(PSLICE() << "Wrong CPU range \"" << range << '"');
+      }
+      for (auto cpu = first; cpu <= last; cpu++) {
+        settings.cpus.push_back(cpu);
+      }
+    }
+    if (parts.size() == 3) {
+      TRY_RESULT(priority, to_integer_safe<int32>(parts[2]));
+      if (priority < -20 || priority > 19) {
+        return Status::Error(PSLICE() << "Wrong priority " << priority);
+      }
+      settings.priority = priority;
+    }
+    result.emplace_back(offset, std::move(settings));
+  }
+  return std::move(result);
+}
+}  // namespace
+
+void Td::update_scheduler_thread_settings(Slice option_value) {
+  if (is_scheduler_shared_) {
+    // the threads are shared with other clients, which can have different settings
+    if (!option_value.empty()) {
+      LOG(WARNING) << "Ignore scheduler_thread_settings, because schedulers are shared between clients";
+    }
+    return;
+  }
+  auto r_settings = parse_scheduler_thread_settings(option_value);
+  if (r_settings.is_error()) {
+    LOG(ERROR) << "Ignore scheduler_thread_settings \"" << option_value << "\": " << r_settings.error();
+    return;
+  }
+
+  auto current_scheduler_id = Scheduler::instance()->sched_id();
+  auto scheduler_count = Scheduler::instance()->sched_count();
+  for (auto &it : r_settings.move_as_ok()) {
+    set_scheduler_thread_settings((current_scheduler_id + it.first) % scheduler_count, std::move(it.second));
+  }
+}
+
 void Td::on_config_option_updated(const string &name) {
   if (close_flag_) {
     return;
@@ -3709,6 +3795,8 @@ void Td::on_config_option_updated(const string &name) {
     send_closure(storage_manager_, &StorageManager::update_use_storage_optimizer);
   } else if (name == "rating_e_decay") {
     return send_closure(top_dialog_manager_, &TopDialogManager::update_rating_e_decay);
+  } else if (name == "scheduler_thread_settings") {
+    update_scheduler_thread_settings(G()->shared_config().get_option_string(name));
   } else if (name == "call_ring_timeout_ms" || name == "call_receive_timeout_ms" ||
              name == "channels_read_media_period") {
     return;
@@ -4041,7 +4129,7 @@ Status Td::init(DbKey key) {
 
   TdDb::Events events;
   TRY_RESULT(td_db,
-             TdDb::open(std::min(current_scheduler_id + 1, scheduler_count - 1), parameters_, std::move(key), events));
+             TdDb::open((current_scheduler_id + 1) % scheduler_count, parameters_, std::move(key), events));
   LOG(INFO) << "Successfully inited database in " << tag("database_directory", parameters_.database_directory)
             << " and " << tag("files_directory", parameters_.files_directory);
   G()->init(parameters_, actor_id(this), std::move(td_db)).ensure();
@@ -4168,7 +4256,7 @@ Status Td::init(DbKey key) {
   secret_chats_manager_ = create_actor<SecretChatsManager>("SecretChatsManager", create_reference());
   G()->set_secret_chats_manager(secret_chats_manager_.get());
   storage_manager_ = create_actor<StorageManager>("StorageManager", create_reference(),
-                                                  std::min(current_scheduler_id + 2, scheduler_count - 1));
+                                                  (current_scheduler_id + 2) % scheduler_count);
   G()->set_storage_manager(storage_manager_.get());
   top_dialog_manager_ = create_actor<TopDialogManager>("TopDialogManager", create_reference());
   G()->set_top_dialog_manager(top_dialog_manager_.get());
@@ -6152,6 +6240,27 @@ void Td::on_request(uint64 id, td_api::setOption &request) {
       }
       break;
     case 's':
+      if (request.name_ == "scheduler_thread_settings") {
+        if (value_constructor_id == td_api::optionValueEmpty::ID) {
+          G()->shared_config().set_option_empty(request.name_);
+        } else if (value_constructor_id == td_api::optionValueString::ID) {
+          if (is_scheduler_shared_) {
+            return send_error_raw(id, 3,
+                                  "Option \"scheduler_thread_settings\" can't be used with schedulers shared between "
+                                  "clients");
+          }
+          auto &value = static_cast<td_api::optionValueString *>(request.value_.get())->value_;
+          auto r_settings = parse_scheduler_thread_settings(value);
+          if (r_settings.is_error()) {
+            return send_error_raw(id, 3, PSLICE() << "Wrong option \"scheduler_thread_settings\" value: "
+                                                  << r_settings.error().message());
+          }
+          G()->shared_config().set_option_string(request.name_, value);
+        } else {
+          return send_error_raw(id, 3, "Option \"scheduler_thread_settings\" must have string value");
+        }
+        return send_closure(actor_id(this), &Td::send_result, id, make_tl_object<td_api::ok>());
+      }
       if (set_integer_option("session_count", 0, 50)) {
         return;
       }
@@ -6433,6 +6542,16 @@ void Td::on_request(uint64 id, const td_api::getFileExtension &request) {
   send_result(id, do_static_request(request));
 }
 
+void Td::on_request(uint64 id, const td_api::setActorStatisticsEnabled &request) {
+  // don't check authorization state
+  send_result(id, do_static_request(request));
+}
+
+void Td::on_request(uint64 id, const td_api::getActorStatistics &request) {
+  // don't check authorization state
+  send_result(id, do_static_request(request));
+}
+
 template <class T>
 td_api::object_ptr<td_api::Object> Td::do_static_request(const T &) {
   return create_error_raw(400, "Function can't be executed synchronously");
@@ -6456,6 +6575,23 @@ td_api::object_ptr<td_api::Object> Td::do_static_request(const td_api::getFileEx
   return make_tl_object<td_api::text>(MimeType::to_extension(request.mime_type_));
 }
 
+td_api::object_ptr<td_api::Object> Td::do_static_request(const td_api::setActorStatisticsEnabled &request) {
+  ActorStats::set_enabled(request.is_enabled_);
+  return make_tl_object<td_api::ok>();
+}
+
+td_api::object_ptr<td_api::Object> Td::do_static_request(const td_api::getActorStatistics &request) {
+  auto entries = transform(ActorStats::get_entries(), [](const ActorStatsEntry &entry) {
+    return make_tl_object<td_api::actorStatisticsEntry>(
+        entry.name, static_cast<int64>(entry.event_count), entry.total_time, entry.total_cpu_time,
+        entry.max_event_time, static_cast<int32>(std::min(entry.max_mailbox_size, static_cast<size_t>(1 << 30))));
+  });
+  if (request.reset_) {
+    ActorStats::reset();
+  }
+  return make_tl_object<td_api::actorStatistics>(ActorStats::is_enabled(), std::move(entries));
+}
+
 // test
 void Td::on_request(uint64 id, td_api::testNetwork &request) {
   create_handler<TestQuery>(id)->send();
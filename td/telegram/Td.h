@@ -80,6 +80,9 @@ class Td final : public NetQueryCallback {
 
   explicit Td(unique_ptr<TdCallback> callback);
 
+  // is_scheduler_shared must be true if the schedulers are also used by other Td instances
+  Td(unique_ptr<TdCallback> callback, bool is_scheduler_shared);
+
   void request(uint64 id, tl_object_ptr<td_api::Function> function);
 
   void destroy();
@@ -207,6 +210,7 @@ class Td final : public NetQueryCallback {
   TdParameters parameters_;
 
   unique_ptr<TdCallback> callback_;
+  bool is_scheduler_shared_ = false;
 
   StateManager::State connection_state_;
 
@@ -244,6 +248,8 @@ class Td final : public NetQueryCallback {
 
   void on_config_option_updated(const string &name);
 
+  void update_scheduler_thread_settings(Slice option_value);
+
   static tl_object_ptr<td_api::ConnectionState> get_connection_state_object(StateManager::State state);
 
   void send(NetQueryPtr &&query);
@@ -740,6 +746,10 @@ class Td final : public NetQueryCallback {
 
   void on_request(uint64 id, const td_api::getFileExtension &request);
 
+  void on_request(uint64 id, const td_api::setActorStatisticsEnabled &request);
+
+  void on_request(uint64 id, const td_api::getActorStatistics &request);
+
   // test
   void on_request(uint64 id, td_api::testNetwork &request);
   void on_request(uint64 id, td_api::testGetDifference &request);
@@ -759,6 +769,8 @@ class Td final : public NetQueryCallback {
   static td_api::object_ptr<td_api::Object> do_static_request(const td_api::getTextEntities &request);
   static td_api::object_ptr<td_api::Object> do_static_request(const td_api::getFileMimeType &request);
   static td_api::object_ptr<td_api::Object> do_static_request(const td_api::getFileExtension &request);
+  static td_api::object_ptr<td_api::Object> do_static_request(const td_api::setActorStatisticsEnabled &request);
+  static td_api::object_ptr<td_api::Object> do_static_request(const td_api::getActorStatistics &request);
 
   Status init(DbKey key) TD_WARN_UNUSED_RESULT;
   void clear();
@@ -109,7 +109,7 @@ class GetDifferenceQuery : public Td::ResultHandler {
   }
 
   void on_result(uint64 id, BufferSlice packet) override {
-    auto result_ptr = fetch_result<telegram_api::updates_getDifference>(packet);
+    auto result_ptr = fetch_result_in_arena<telegram_api::updates_getDifference>(packet);
     if (result_ptr.is_error()) {
       return on_error(id, result_ptr.move_as_error());
     }
@@ -1865,6 +1865,23 @@ class CliClient final : public Actor {
       send_request(make_tl_object<td_api::getFileMimeType>(trim(args)));
     } else if (op == "gfe") {
       send_request(make_tl_object<td_api::getFileExtension>(trim(args)));
+    } else if (op == "sase") {
+      execute(make_tl_object<td_api::setActorStatisticsEnabled>(as_bool(args)));
+    } else if (op == "gas" || op == "gasr") {
+      auto result = execute(make_tl_object<td_api::getActorStatistics>(op == "gasr"));
+      if (result != nullptr && result->get_id() == td_api::actorStatistics::ID) {
+        auto statistics = move_tl_object_as<td_api::actorStatistics>(result);
+        if (!statistics->is_enabled_) {
+          LOG(PLAIN) << "Actor statistics collection is disabled, use \"sase 1\" to enable it\n";
+        }
+        for (auto &entry : statistics->entries_) {
+          LOG(PLAIN) << tag("name", entry->name_) << tag("events", entry->event_count_)
+                     << tag("time", format::as_time(entry->total_time_))
+                     << tag("cpu_time", format::as_time(entry->total_cpu_time_))
+                     << tag("max_event_time", format::as_time(entry->max_event_time_))
+                     << tag("max_mailbox_size", entry->max_mailbox_size_) << "\n";
+        }
+      }
     } else {
       op_not_found_count++;
     }
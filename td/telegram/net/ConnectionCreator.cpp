@@ -11,6 +11,7 @@
 #include "td/telegram/logevent/LogEvent.h"
 #include "td/telegram/StateManager.h"
 
+#include "td/mtproto/CryptoWorkerPool.h"
 #include "td/mtproto/IStreamTransport.h"
 #include "td/mtproto/PingConnection.h"
 #include "td/mtproto/RawConnection.h"
@@ -21,6 +22,7 @@
 #include "td/utils/format.h"
 #include "td/utils/logging.h"
 #include "td/utils/port/IPAddress.h"
+#include "td/utils/port/thread.h"
 #include "td/utils/ScopeGuard.h"
 #include "td/utils/Time.h"
 #include "td/utils/tl_helpers.h"
@@ -521,11 +523,32 @@ void ConnectionCreator::client_add_connection(size_t hash,
   }
   if (r_raw_connection.is_ok()) {
     client.backoff.clear();
-    client.ready_connections.push_back(std::make_pair(r_raw_connection.move_as_ok(), Time::now_cached()));
+    auto raw_connection = r_raw_connection.move_as_ok();
+    if (client.is_media && raw_connection->get_transport_type() != mtproto::TransportType::Http) {
+      auto crypto_worker_pool = get_media_crypto_worker_pool();
+      if (crypto_worker_pool != nullptr) {
+        raw_connection->set_crypto_worker_pool(std::move(crypto_worker_pool));
+      }
+    }
+    client.ready_connections.push_back(std::make_pair(std::move(raw_connection), Time::now_cached()));
   }
   client_loop(client);
 }
 
+std::shared_ptr<mtproto::CryptoWorkerPool> ConnectionCreator::get_media_crypto_worker_pool() {
+#if !TD_THREAD_UNSUPPORTED
+  if (media_crypto_worker_pool_ == nullptr) {
+    // the thread of the session takes part in the work too
+    auto thread_count = std::min(thread::hardware_concurrency(), static_cast<unsigned>(MAX_CRYPTO_THREAD_COUNT + 1));
+    if (thread_count <= 1) {
+      return nullptr;
+    }
+    media_crypto_worker_pool_ = std::make_shared<mtproto::CryptoWorkerPool>(thread_count - 1);
+  }
+#endif
+  return media_crypto_worker_pool_;
+}
+
 void ConnectionCreator::client_wakeup(size_t hash) {
   LOG(INFO) << tag("hash", format::as_hex(hash)) << " wakeup";
   client_loop(clients_[hash]);
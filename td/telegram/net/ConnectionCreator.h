@@ -33,6 +33,7 @@
 
 namespace td {
 namespace mtproto {
+class CryptoWorkerPool;
 class RawConnection;
 }  // namespace mtproto
 namespace detail {
@@ -199,6 +200,11 @@ class ConnectionCreator : public Actor {
   std::shared_ptr<NetStatsCallback> media_net_stats_callback_;
   std::shared_ptr<NetStatsCallback> common_net_stats_callback_;
 
+  // upload and download connections encrypt and decrypt most of the traffic
+  static constexpr int32 MAX_CRYPTO_THREAD_COUNT = 4;
+  std::shared_ptr<mtproto::CryptoWorkerPool> media_crypto_worker_pool_;
+  std::shared_ptr<mtproto::CryptoWorkerPool> get_media_crypto_worker_pool();
+
   ActorShared<> ref_cnt_guard_;
   int ref_cnt_{0};
   ActorShared<ConnectionCreator> create_reference(int64 token);
@@ -6,15 +6,56 @@
 //
 #include "td/telegram/net/NetQueryCreator.h"
 
+#include "td/telegram/telegram_api.h"
+
 #include "td/utils/Gzip.h"
+#include "td/utils/tl_storers.h"
+
+#include <limits>
 
 namespace td {
+
+constexpr size_t NetQueryCreator::SIZE_HINT_COUNT;
+
 NetQueryCreator::Ptr NetQueryCreator::create(uint64 id, const Storer &storer, DcId dc_id, NetQuery::Type type,
                                              NetQuery::AuthFlag auth_flag, NetQuery::GzipFlag gzip_flag,
                                              double total_timeout_limit) {
   BufferSlice slice(storer.size());
   storer.store(slice.as_slice().ubegin());
+  return create_query(id, std::move(slice), dc_id, type, auth_flag, gzip_flag, total_timeout_limit);
+}
+
+NetQueryCreator::Ptr NetQueryCreator::create(uint64 id, const TLStorer<telegram_api::Function> &storer, DcId dc_id,
+                                             NetQuery::Type type, NetQuery::AuthFlag auth_flag,
+                                             NetQuery::GzipFlag gzip_flag, double total_timeout_limit) {
+  const telegram_api::Function &function = storer.get_object();
+  TlStorerToBufferSlice function_storer(get_size_hint(function.get_id()));
+  function.store(function_storer);
+  set_size_hint(function.get_id(), function_storer.get_length());
+  return create_query(id, function_storer.move_as_buffer_slice(), dc_id, type, auth_flag, gzip_flag,
+                      total_timeout_limit);
+}
+
+size_t NetQueryCreator::get_size_hint(int32 constructor_id) const {
+  auto id = static_cast<uint32>(constructor_id);
+  auto value = size_hints_[id % SIZE_HINT_COUNT].load(std::memory_order_relaxed);
+  if (static_cast<uint32>(value >> 32) != id) {
+    return 0;
+  }
+  return static_cast<uint32>(value);
+}
+
+void NetQueryCreator::set_size_hint(int32 constructor_id, size_t size) {
+  auto id = static_cast<uint32>(constructor_id);
+  if (size > std::numeric_limits<uint32>::max()) {
+    size = 0;
+  }
+  size_hints_[id % SIZE_HINT_COUNT].store((static_cast<uint64>(id) << 32) | size, std::memory_order_relaxed);
+}
 
+NetQueryCreator::Ptr NetQueryCreator::create_query(uint64 id, BufferSlice &&slice, DcId dc_id, NetQuery::Type type,
+                                                   NetQuery::AuthFlag auth_flag, NetQuery::GzipFlag gzip_flag,
+                                                   double total_timeout_limit) {
   // TODO: magic constant
   if (slice.size() < (1 << 8)) {
     gzip_flag = NetQuery::GzipFlag::Off;
@@ -9,10 +9,16 @@
 #include "td/telegram/net/NetQuery.h"
 #include "td/telegram/UniqueId.h"
 
+#include "td/mtproto/utils.h"
+
 #include "td/utils/buffer.h"
+#include "td/utils/common.h"
 #include "td/utils/ObjectPool.h"
 #include "td/utils/Storer.h"
 
+#include <array>
+#include <atomic>
+
 namespace td {
 class NetQueryCreator {
  public:
@@ -48,7 +54,28 @@ class NetQueryCreator {
              NetQuery::AuthFlag auth_flag = NetQuery::AuthFlag::On,
              NetQuery::GzipFlag gzip_flag = NetQuery::GzipFlag::On, double total_timeout_limit = 60);
 
+  // telegram_api queries are serialized in one pass
+  Ptr create(const TLStorer<telegram_api::Function> &storer, DcId dc_id = DcId::main(),
+             NetQuery::Type type = NetQuery::Type::Common, NetQuery::AuthFlag auth_flag = NetQuery::AuthFlag::On,
+             NetQuery::GzipFlag gzip_flag = NetQuery::GzipFlag::On, double total_timeout_limit = 60) {
+    return create(UniqueId::next(), storer, dc_id, type, auth_flag, gzip_flag, total_timeout_limit);
+  }
+  Ptr create(uint64 id, const TLStorer<telegram_api::Function> &storer, DcId dc_id = DcId::main(),
+             NetQuery::Type type = NetQuery::Type::Common, NetQuery::AuthFlag auth_flag = NetQuery::AuthFlag::On,
+             NetQuery::GzipFlag gzip_flag = NetQuery::GzipFlag::On, double total_timeout_limit = 60);
+
  private:
   ObjectPool<NetQuery> object_pool_;
+
+  // sizes of the last serialized queries together with their constructor in the high 32 bits; used as buffer
+  // size hints; the constructor is stored to ignore hints of other constructors hashed to the same slot
+  static constexpr size_t SIZE_HINT_COUNT = 256;
+  std::array<std::atomic<uint64>, SIZE_HINT_COUNT> size_hints_{};
+
+  size_t get_size_hint(int32 constructor_id) const;
+  void set_size_hint(int32 constructor_id, size_t size);
+
+  Ptr create_query(uint64 id, BufferSlice &&slice, DcId dc_id, NetQuery::Type type, NetQuery::AuthFlag auth_flag,
+                   NetQuery::GzipFlag gzip_flag, double total_timeout_limit);
 };
 }  // namespace td
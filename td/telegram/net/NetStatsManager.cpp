@@ -51,7 +51,7 @@ void NetStatsManager::init() {
     ActorId<NetStatsManager> parent_;
     size_t id_;
     void on_stats_updated() override {
-      send_closure(parent_, &NetStatsManager::on_stats_updated, id_);
+      send_closure_coalesced(parent_, id_, &NetStatsManager::on_stats_updated, id_);
     }
   };
 
@@ -22,6 +22,8 @@ class TlStorerCalcLength;
 
 class TlStorerUnsafe;
 
+class TlStorerToBufferSlice;
+
 class TlStorerToString;
 
 /**
@@ -48,6 +50,13 @@ class TlObject {
   virtual void store(TlStorerCalcLength &s) const {
   }
 
+  /**
+   * Appends the object to the storer serializing object, a buffer growing as needed.
+   * \param[in] s Storer to which the object will be appended.
+   */
+  virtual void store(TlStorerToBufferSlice &s) const {
+  }
+
   /**
    * Helper function for the to_string method. Appends a string representation of the object to the storer.
    * \param[in] s Storer to which the object string representation will be appended.
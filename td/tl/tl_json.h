@@ -157,6 +157,93 @@ Status from_json(std::vector<T> &to, JsonValue &from) {
   return Status::OK();
 }
 
+inline Status from_json(int32 &to, JsonPullParser &from) {
+  auto type = from.peek_type();
+  if (type != JsonValue::Type::Number && type != JsonValue::Type::String) {
+    return Status::Error(PSLICE() << "Expected number, got " << type);
+  }
+  TRY_RESULT(number, type == JsonValue::Type::String ? from.read_string() : from.read_number());
+  TRY_RESULT(res, to_integer_safe<int32>(number));
+  to = res;
+  return Status::OK();
+}
+
+inline Status from_json(bool &to, JsonPullParser &from) {
+  auto type = from.peek_type();
+  if (type != JsonValue::Type::Boolean) {
+    int32 x;
+    auto status = from_json(x, from);
+    if (status.is_ok()) {
+      to = x != 0;
+      return Status::OK();
+    }
+    return Status::Error(PSLICE() << "Expected bool, got " << type);
+  }
+  TRY_RESULT(value, from.read_boolean());
+  to = value;
+  return Status::OK();
+}
+
+inline Status from_json(int64 &to, JsonPullParser &from) {
+  auto type = from.peek_type();
+  if (type != JsonValue::Type::Number && type != JsonValue::Type::String) {
+    return Status::Error(PSLICE() << "Expected number, got " << type);
+  }
+  TRY_RESULT(number, type == JsonValue::Type::String ? from.read_string() : from.read_number());
+  TRY_RESULT(res, to_integer_safe<int64>(number));
+  to = res;
+  return Status::OK();
+}
+
+inline Status from_json(double &to, JsonPullParser &from) {
+  auto type = from.peek_type();
+  if (type != JsonValue::Type::Number) {
+    return Status::Error(PSLICE() << "Expected number, got " << type);
+  }
+  TRY_RESULT(number, from.read_number());
+  to = to_double(number.str());
+  return Status::OK();
+}
+
+inline Status from_json(string &to, JsonPullParser &from) {
+  auto type = from.peek_type();
+  if (type != JsonValue::Type::String) {
+    return Status::Error(PSLICE() << "Expected string, got " << type);
+  }
+  TRY_RESULT(value, from.read_string());
+  to.assign(value.begin(), value.size());
+  return Status::OK();
+}
+
+inline Status from_json_bytes(string &to, JsonPullParser &from) {
+  auto type = from.peek_type();
+  if (type != JsonValue::Type::String) {
+    return Status::Error(PSLICE() << "Expected string, got " << type);
+  }
+  TRY_RESULT(value, from.read_string());
+  TRY_RESULT(decoded, base64_decode(value));
+  to = std::move(decoded);
+  return Status::OK();
+}
+
+template <class T>
+Status from_json(std::vector<T> &to, JsonPullParser &from) {
+  auto type = from.peek_type();
+  if (type != JsonValue::Type::Array) {
+    return Status::Error(PSLICE() << "Expected array, got " << type);
+  }
+  TRY_STATUS(from.enter_array());
+  to.clear();
+  while (true) {
+    TRY_RESULT(has_element, from.next_element());
+    if (!has_element) {
+      return Status::OK();
+    }
+    to.emplace_back();
+    TRY_STATUS(from_json(to.back(), from));
+  }
+}
+
 template <class T>
 class DowncastHelper : public T {
  public:
@@ -213,6 +300,61 @@ std::enable_if_t<!std::is_constructible<T>::value, Status> from_json(tl_object_p
   return Status::OK();
 }
 
+template <class T>
+Result<int32> get_json_constructor(T *object, MutableSlice constructor_value) {
+  switch (JsonPullParser::get_value_type(constructor_value)) {
+    case JsonValue::Type::Number:
+      return to_integer<int32>(constructor_value);
+    case JsonValue::Type::String:
+      if (constructor_value.find('\\') == static_cast<size_t>(-1)) {
+        return tl_constructor_from_string(object, constructor_value.substr(1, constructor_value.size() - 2));
+      } else {
+        // the value can't be decoded in place, because the object will be parsed later
+        string value_copy = constructor_value.str();
+        Parser parser(value_copy);
+        TRY_RESULT(value, json_string_decode(parser));
+        return tl_constructor_from_string(object, value);
+      }
+    default:
+      return Status::Error(PSLICE() << "Expected string or int, got "
+                                    << JsonPullParser::get_value_type(constructor_value));
+  }
+}
+
+template <class T>
+std::enable_if_t<!std::is_constructible<T>::value, Status> from_json(tl_object_ptr<T> &to, JsonPullParser &from) {
+  auto type = from.peek_type();
+  if (type != JsonValue::Type::Object) {
+    if (type == JsonValue::Type::Null) {
+      TRY_STATUS(from.read_null());
+      to = nullptr;
+      return Status::OK();
+    }
+    return Status::Error(PSLICE() << "Expected object, got " << type);
+  }
+
+  TRY_RESULT(constructor_value, from.find_object_type());
+  if (constructor_value.empty()) {
+    return Status::Error(400, "Can't find field \"@type\"");
+  }
+  TRY_RESULT(constructor, get_json_constructor(to.get(), constructor_value));
+
+  TRY_STATUS(from.enter_object());
+  DowncastHelper<T> helper(constructor);
+  Status status;
+  bool ok = downcast_call(static_cast<T &>(helper), [&](auto &dummy) {
+    auto result = make_tl_object<std::decay_t<decltype(dummy)>>();
+    status = from_json(*result, from);
+    to = std::move(result);
+  });
+  TRY_STATUS(std::move(status));
+  if (!ok) {
+    return Status::Error(PSLICE() << "Unknown constructor " << format::as_hex(constructor));
+  }
+
+  return Status::OK();
+}
+
 template <class T>
 std::enable_if_t<std::is_constructible<T>::value, Status> from_json(tl_object_ptr<T> &to, JsonValue &from) {
   if (from.type() != JsonValue::Type::Object) {
@@ -226,4 +368,20 @@ std::enable_if_t<std::is_constructible<T>::value, Status> from_json(tl_object_pt
   return from_json(*to, from.get_object());
 }
 
+template <class T>
+std::enable_if_t<std::is_constructible<T>::value, Status> from_json(tl_object_ptr<T> &to, JsonPullParser &from) {
+  auto type = from.peek_type();
+  if (type != JsonValue::Type::Object) {
+    if (type == JsonValue::Type::Null) {
+      TRY_STATUS(from.read_null());
+      to = nullptr;
+      return Status::OK();
+    }
+    return Status::Error(PSLICE() << "Expected object, got " << type);
+  }
+  TRY_STATUS(from.enter_object());
+  to = make_tl_object<T>();
+  return from_json(*to, from);
+}
+
 }  // namespace td
@@ -18,6 +18,17 @@ void MultiTimeout::set_timeout_at(int64 key, double timeout) {
   LOG(DEBUG) << "Set timeout for " << key << " in " << timeout - Time::now();
   auto item = items_.emplace(key);
   auto heap_node = static_cast<HeapNode *>(const_cast<Item *>(&*item.first));
+  if (use_timer_wheel_) {
+    if (heap_node->in_heap()) {
+      CHECK(!item.second);
+      timeout_wheel_.fix(timeout, heap_node);
+    } else {
+      CHECK(item.second);
+      timeout_wheel_.insert(timeout, heap_node);
+    }
+    update_wheel_timeout();
+    return;
+  }
   if (heap_node->in_heap()) {
     CHECK(!item.second);
     bool need_update_timeout = heap_node->is_top();
@@ -42,6 +53,11 @@ void MultiTimeout::add_timeout_at(int64 key, double timeout) {
     CHECK(!item.second);
   } else {
     CHECK(item.second);
+    if (use_timer_wheel_) {
+      timeout_wheel_.insert(timeout, heap_node);
+      update_wheel_timeout();
+      return;
+    }
     timeout_queue_.insert(timeout, heap_node);
     if (heap_node->is_top()) {
       update_timeout();
@@ -55,6 +71,15 @@ void MultiTimeout::cancel_timeout(int64 key) {
   if (item != items_.end()) {
     auto heap_node = static_cast<HeapNode *>(const_cast<Item *>(&*item));
     CHECK(heap_node->in_heap());
+    if (use_timer_wheel_) {
+      timeout_wheel_.erase(heap_node);
+      items_.erase(item);
+      // the Actor timeout is left as is, if there are other timeouts, because it can only expire earlier than needed
+      if (items_.empty()) {
+        update_wheel_timeout();
+      }
+      return;
+    }
     bool need_update_timeout = heap_node->is_top();
     timeout_queue_.erase(heap_node);
     items_.erase(item);
@@ -77,8 +102,34 @@ void MultiTimeout::update_timeout() {
   }
 }
 
+void MultiTimeout::update_wheel_timeout() {
+  if (items_.empty()) {
+    CHECK(timeout_wheel_.empty());
+    if (Actor::has_timeout()) {
+      LOG(DEBUG) << "Cancel timeout";
+      Actor::cancel_timeout();
+    }
+    return;
+  }
+  double timeout_at = timeout_wheel_.next_key();
+  if (!Actor::has_timeout() || timeout_at != wheel_timeout_at_) {
+    LOG(DEBUG) << "Set timeout in " << timeout_at - Time::now_cached();
+    wheel_timeout_at_ = timeout_at;
+    Actor::set_timeout_at(timeout_at);
+  }
+}
+
 void MultiTimeout::timeout_expired() {
   double now = Time::now_cached();
+  if (use_timer_wheel_) {
+    while (HeapNode *heap_node = timeout_wheel_.pop_expired(now)) {
+      int64 key = static_cast<Item *>(heap_node)->key;
+      items_.erase(Item(key));
+      callback_(data_, key);
+    }
+    update_wheel_timeout();
+    return;
+  }
   while (!timeout_queue_.empty() && timeout_queue_.top_key() < now) {
     int64 key = static_cast<Item *>(timeout_queue_.pop())->key;
     items_.erase(Item(key));
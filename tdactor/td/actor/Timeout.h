@@ -11,6 +11,7 @@
 #include "td/utils/Heap.h"
 #include "td/utils/logging.h"
 #include "td/utils/Time.h"
+#include "td/utils/TimerWheel.h"
 
 #include <set>
 
@@ -93,6 +94,13 @@ class MultiTimeout final : public Actor {
     data_ = data;
   }
 
+  // use TimerWheel instead of KHeap, which is faster if most of the timeouts are cancelled before they expire
+  // must be called before any timeout is set
+  void set_use_timer_wheel(bool use_timer_wheel) {
+    CHECK(items_.empty());
+    use_timer_wheel_ = use_timer_wheel;
+  }
+
   bool has_timeout(int64 key) const;
 
   void set_timeout_in(int64 key, double timeout) {
@@ -116,9 +124,13 @@ class MultiTimeout final : public Actor {
   Data data_;
 
   KHeap<double> timeout_queue_;
+  TimerWheel timeout_wheel_;
+  bool use_timer_wheel_ = false;
+  double wheel_timeout_at_ = 0;  // the time for which Actor timeout is set, if use_timer_wheel_
   std::set<Item> items_;
 
   void update_timeout();
+  void update_wheel_timeout();
 
   void timeout_expired() override;
 };
@@ -18,6 +18,7 @@
 
 #include <atomic>
 #include <memory>
+#include <unordered_map>
 #include <utility>
 
 namespace td {
@@ -92,12 +93,19 @@ class ActorInfo
   void finish_run();
 
   vector<Event> mailbox_;
+  // events received by the destination scheduler before it has finished migration of the actor
+  vector<Event> pending_mailbox_;
 
   bool is_lite() const;
 
   void set_wait_generation(uint32 wait_generation);
   bool must_wait(uint32 wait_generation) const;
 
+  // coalesced events from the mailbox_, which haven't been run yet
+  CoalescedEvent *get_coalesced_event(uint64 key);
+  void add_coalesced_event(uint64 key, CoalescedEvent *event);
+  void on_coalesced_event_run(uint64 key, CoalescedEvent *event);
+
  private:
   Deleter deleter_;
   bool is_lite_;
@@ -107,6 +115,8 @@ class ActorInfo
   std::atomic<int32> sched_id_{0};
   Actor *actor_ = nullptr;
 
+  std::unique_ptr<std::unordered_map<uint64, CoalescedEvent *>> coalesced_events_;
+
 #ifdef TD_DEBUG
   string name_;
 #endif
@@ -59,6 +59,31 @@ inline void ActorInfo::set_wait_generation(uint32 wait_generation) {
 inline bool ActorInfo::must_wait(uint32 wait_generation) const {
   return wait_generation_ == wait_generation;
 }
+inline CoalescedEvent *ActorInfo::get_coalesced_event(uint64 key) {
+  if (coalesced_events_ == nullptr) {
+    return nullptr;
+  }
+  auto it = coalesced_events_->find(key);
+  if (it == coalesced_events_->end()) {
+    return nullptr;
+  }
+  return it->second;
+}
+inline void ActorInfo::add_coalesced_event(uint64 key, CoalescedEvent *event) {
+  if (coalesced_events_ == nullptr) {
+    coalesced_events_ = std::make_unique<std::unordered_map<uint64, CoalescedEvent *>>();
+  }
+  (*coalesced_events_)[key] = event;
+}
+inline void ActorInfo::on_coalesced_event_run(uint64 key, CoalescedEvent *event) {
+  if (coalesced_events_ == nullptr) {
+    return;
+  }
+  auto it = coalesced_events_->find(key);
+  if (it != coalesced_events_->end() && it->second == event) {
+    coalesced_events_->erase(it);
+  }
+}
 inline void ActorInfo::on_actor_moved(Actor *actor_new_ptr) {
   actor_ = actor_new_ptr;
 }
@@ -67,6 +92,8 @@ inline void ActorInfo::clear() {
   //  LOG_IF(WARNING, !mailbox_.empty()) << "Destroy actor with non-empty mailbox: " << get_name()
   //                                     << format::as_array(mailbox_);
   mailbox_.clear();
+  pending_mailbox_.clear();
+  coalesced_events_.reset();
   CHECK(!is_running());
   CHECK(!is_migrating());
   // NB: must be in non migrating state
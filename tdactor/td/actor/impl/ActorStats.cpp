@@ -0,0 +1,192 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2018
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/actor/impl/ActorStats.h"
+
+#include "td/utils/logging.h"
+#include "td/utils/port/Clocks.h"
+#include "td/utils/port/config.h"
+
+#if TD_PORT_POSIX
+#include <time.h>
+#endif
+
+#include <algorithm>
+#include <unordered_set>
+
+namespace td {
+
+namespace {
+
+double get_thread_cpu_time() {
+#if TD_PORT_POSIX && defined(CLOCK_THREAD_CPUTIME_ID)
+  timespec ts;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) * 1e-9;
+  }
+  return 0;
+#elif TD_PORT_WINDOWS
+  FILETIME creation_time;
+  FILETIME exit_time;
+  FILETIME kernel_time;
+  FILETIME user_time;
+  if (GetThreadTimes(GetCurrentThread(), &creation_time, &exit_time, &kernel_time, &user_time) == 0) {
+    return 0;
+  }
+  auto to_seconds = [](const FILETIME &time) {
+    return static_cast<double>((static_cast<uint64>(time.dwHighDateTime) << 32) | time.dwLowDateTime) * 1e-7;
+  };
+  return to_seconds(kernel_time) + to_seconds(user_time);
+#else
+  return 0;
+#endif
+}
+
+struct Registry {
+  std::mutex mutex;
+  std::unordered_set<ActorStats::Storage *> storages;
+  std::unordered_map<string, ActorStatsEntry> finished_entries;  // entries from already destroyed schedulers
+};
+
+Registry &get_registry() {
+  static Registry *registry = new Registry();  // intentionally leaked, because schedulers can outlive static objects
+  return *registry;
+}
+
+void merge_entries(std::unordered_map<string, ActorStatsEntry> &to,
+                   const std::unordered_map<string, ActorStatsEntry> &from) {
+  for (auto &it : from) {
+    auto &entry = to[it.first];
+    if (entry.name.empty()) {
+      entry.name = it.second.name;
+    }
+    entry.add(it.second);
+  }
+}
+
+}  // namespace
+
+void ActorStatsEntry::add(const ActorStatsEntry &other) {
+  event_count += other.event_count;
+  total_time += other.total_time;
+  total_cpu_time += other.total_cpu_time;
+  max_event_time = std::max(max_event_time, other.max_event_time);
+  max_mailbox_size = std::max(max_mailbox_size, other.max_mailbox_size);
+}
+
+std::atomic<bool> ActorStats::is_enabled_{false};
+
+vector<ActorStatsEntry> ActorStats::get_entries() {
+  std::unordered_map<string, ActorStatsEntry> entries;
+  {
+    auto &registry = get_registry();
+    std::lock_guard<std::mutex> registry_lock(registry.mutex);
+    merge_entries(entries, registry.finished_entries);
+    for (auto storage : registry.storages) {
+      std::lock_guard<std::mutex> lock(storage->mutex_);
+      merge_entries(entries, storage->entries_);
+    }
+  }
+
+  vector<ActorStatsEntry> result;
+  result.reserve(entries.size());
+  for (auto &it : entries) {
+    if (it.second.event_count != 0 || it.second.max_mailbox_size != 0) {
+      result.push_back(std::move(it.second));
+    }
+  }
+  std::sort(result.begin(), result.end(), [](const ActorStatsEntry &lhs, const ActorStatsEntry &rhs) {
+    if (lhs.total_time != rhs.total_time) {
+      return lhs.total_time > rhs.total_time;
+    }
+    return lhs.name < rhs.name;
+  });
+  return result;
+}
+
+void ActorStats::reset() {
+  auto &registry = get_registry();
+  std::lock_guard<std::mutex> registry_lock(registry.mutex);
+  registry.finished_entries.clear();
+  for (auto storage : registry.storages) {
+    std::lock_guard<std::mutex> lock(storage->mutex_);
+    // entries can't be erased, because running ActorStatsGuard can reference them
+    for (auto &it : storage->entries_) {
+      auto name = std::move(it.second.name);
+      it.second = ActorStatsEntry();
+      it.second.name = std::move(name);
+    }
+  }
+}
+
+ActorStats::Storage::Storage() {
+  auto &registry = get_registry();
+  std::lock_guard<std::mutex> registry_lock(registry.mutex);
+  registry.storages.insert(this);
+}
+
+ActorStats::Storage::~Storage() {
+  auto &registry = get_registry();
+  std::lock_guard<std::mutex> registry_lock(registry.mutex);
+  registry.storages.erase(this);
+  merge_entries(registry.finished_entries, entries_);
+}
+
+ActorStatsEntry *ActorStats::Storage::get_entry(Slice name) {
+  // must be called with locked mutex_
+  if (name.empty()) {
+    name = Slice("Unnamed");
+  }
+  key_.assign(name.begin(), name.size());
+  auto &entry = entries_[key_];
+  if (entry.name.empty()) {
+    entry.name = key_;
+  }
+  return &entry;
+}
+
+void ActorStats::Storage::on_mailbox_size(Slice name, size_t mailbox_size) {
+  if (likely(!ActorStats::is_enabled())) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto entry = get_entry(name);
+  entry->max_mailbox_size = std::max(entry->max_mailbox_size, mailbox_size);
+}
+
+void ActorStatsGuard::start(ActorStats::Storage *storage, Slice name, size_t mailbox_size) {
+  CHECK(storage != nullptr);
+  storage_ = storage;
+  {
+    std::lock_guard<std::mutex> lock(storage->mutex_);
+    entry_ = storage->get_entry(name);
+    entry_->max_mailbox_size = std::max(entry_->max_mailbox_size, mailbox_size);
+  }
+
+  save_nested_time_ = storage->nested_time_;
+  save_nested_cpu_time_ = storage->nested_cpu_time_;
+  storage->nested_time_ = 0;
+  storage->nested_cpu_time_ = 0;
+  start_time_ = Clocks::monotonic();
+  start_cpu_time_ = get_thread_cpu_time();
+}
+
+void ActorStatsGuard::finish() {
+  double elapsed_time = Clocks::monotonic() - start_time_;
+  double elapsed_cpu_time = get_thread_cpu_time() - start_cpu_time_;
+  double self_time = std::max(elapsed_time - storage_->nested_time_, 0.0);
+  double self_cpu_time = std::max(elapsed_cpu_time - storage_->nested_cpu_time_, 0.0);
+  storage_->nested_time_ = save_nested_time_ + elapsed_time;
+  storage_->nested_cpu_time_ = save_nested_cpu_time_ + elapsed_cpu_time;
+
+  std::lock_guard<std::mutex> lock(storage_->mutex_);
+  entry_->event_count++;
+  entry_->total_time += self_time;
+  entry_->total_cpu_time += self_cpu_time;
+  entry_->max_event_time = std::max(entry_->max_event_time, self_time);
+}
+
+}  // namespace td
@@ -0,0 +1,107 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2018
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/common.h"
+#include "td/utils/Slice.h"
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+namespace td {
+
+// statistics about all actors with the same name
+struct ActorStatsEntry {
+  string name;
+  uint64 event_count = 0;
+  double total_time = 0;  // wall-clock time spent in event handlers, excluding nested events of other actors
+  double total_cpu_time = 0;
+  double max_event_time = 0;
+  size_t max_mailbox_size = 0;
+
+  void add(const ActorStatsEntry &other);
+};
+
+// Process-wide optional profiler of actors. Each Scheduler owns an ActorStats::Storage, which is updated only
+// if the profiler is enabled, so disabled profiler costs one relaxed atomic load per event.
+class ActorStats {
+ public:
+  static void set_enabled(bool is_enabled) {
+    is_enabled_.store(is_enabled, std::memory_order_relaxed);
+  }
+  static bool is_enabled() {
+    return is_enabled_.load(std::memory_order_relaxed);
+  }
+
+  // returns statistics merged from all schedulers, sorted by total_time in descending order
+  static vector<ActorStatsEntry> get_entries();
+
+  static void reset();
+
+  class Storage {
+   public:
+    Storage();
+    Storage(const Storage &) = delete;
+    Storage &operator=(const Storage &) = delete;
+    Storage(Storage &&) = delete;
+    Storage &operator=(Storage &&) = delete;
+    ~Storage();
+
+    void on_mailbox_size(Slice name, size_t mailbox_size);
+
+   private:
+    friend class ActorStats;
+    friend class ActorStatsGuard;
+
+    std::mutex mutex_;
+    std::unordered_map<string, ActorStatsEntry> entries_;
+    string key_;
+
+    // time spent in nested events of the currently running events; is accessed only from the scheduler thread
+    double nested_time_ = 0;
+    double nested_cpu_time_ = 0;
+
+    ActorStatsEntry *get_entry(Slice name);
+  };
+
+ private:
+  static std::atomic<bool> is_enabled_;
+};
+
+// measures time of one actor event
+class ActorStatsGuard {
+ public:
+  ActorStatsGuard(ActorStats::Storage *storage, Slice name, size_t mailbox_size) {
+    if (likely(!ActorStats::is_enabled())) {
+      return;
+    }
+    start(storage, name, mailbox_size);
+  }
+  ActorStatsGuard(const ActorStatsGuard &) = delete;
+  ActorStatsGuard &operator=(const ActorStatsGuard &) = delete;
+  ActorStatsGuard(ActorStatsGuard &&) = delete;
+  ActorStatsGuard &operator=(ActorStatsGuard &&) = delete;
+  ~ActorStatsGuard() {
+    if (storage_ != nullptr) {
+      finish();
+    }
+  }
+
+ private:
+  ActorStats::Storage *storage_ = nullptr;
+  ActorStatsEntry *entry_ = nullptr;
+  double start_time_ = 0;
+  double start_cpu_time_ = 0;
+  double save_nested_time_ = 0;
+  double save_nested_cpu_time_ = 0;
+
+  void start(ActorStats::Storage *storage, Slice name, size_t mailbox_size);
+  void finish();
+};
+
+}  // namespace td
@@ -11,13 +11,86 @@
 #include "td/actor/impl/ActorInfo.h"
 #include "td/actor/impl/Scheduler.h"
 
+#include "td/utils/misc.h"
 #include "td/utils/MpscPollableQueue.h"
 #include "td/utils/port/thread_local.h"
+#include "td/utils/port/thread_settings.h"
 
 #include <memory>
 
 namespace td {
 
+namespace {
+
+// prints CPU list as ranges, for example, "0-3,8"
+string cpus_to_string(const vector<int32> &cpus) {
+  string result;
+  for (size_t i = 0; i < cpus.size();) {
+    size_t j = i + 1;
+    while (j < cpus.size() && cpus[j] == cpus[j - 1] + 1) {
+      j++;
+    }
+    if (i != 0) {
+      result += ',';
+    }
+    result += to_string(cpus[i]);
+    if (j - i > 1) {
+      result += '-';
+      result += to_string(cpus[j - 1]);
+    }
+    i = j;
+  }
+  return result;
+}
+
+class SchedulerThreadSettingsApplier : public Actor {
+ public:
+  explicit SchedulerThreadSettingsApplier(SchedulerThreadSettings settings) : settings_(std::move(settings)) {
+  }
+
+ private:
+  SchedulerThreadSettings settings_;
+
+  void start_up() override {
+    apply_scheduler_thread_settings(Scheduler::instance()->sched_id(), settings_);
+    stop();
+  }
+};
+
+}  // namespace
+
+void apply_scheduler_thread_settings(int32 sched_id, const SchedulerThreadSettings &settings) {
+  if (!settings.name.empty()) {
+    auto status = set_current_thread_name(settings.name);
+    if (status.is_error()) {
+      VLOG(actor) << "Can't set name of scheduler " << sched_id << " thread: " << status;
+    }
+  }
+  if (!settings.cpus.empty()) {
+    auto status = set_current_thread_affinity(settings.cpus);
+    if (status.is_error()) {
+      LOG(WARNING) << "Can't set CPU affinity of scheduler " << sched_id << " thread: " << status;
+    }
+  }
+  if (settings.priority != 0) {
+    auto status = set_current_thread_priority(settings.priority);
+    if (status.is_error()) {
+      LOG(WARNING) << "Can't set priority of scheduler " << sched_id << " thread: " << status;
+    }
+  }
+
+  auto r_cpus = get_current_thread_affinity();
+  auto cpus = r_cpus.is_ok() ? cpus_to_string(r_cpus.ok()) : string("unknown");
+  LOG(INFO) << "Scheduler " << sched_id << " runs in thread \"" << settings.name << "\" on CPUs " << cpus
+            << " with priority " << settings.priority;
+}
+
+void set_scheduler_thread_settings(int32 sched_id, SchedulerThreadSettings settings) {
+  create_actor_on_scheduler<SchedulerThreadSettingsApplier>("SchedulerThreadSettingsApplier", sched_id,
+                                                            std::move(settings))
+      .release();
+}
+
 void ConcurrentScheduler::init(int32 threads_n) {
 #if TD_THREAD_UNSUPPORTED || TD_EVENTFD_UNSUPPORTED
   threads_n = 0;
@@ -30,6 +103,10 @@ void ConcurrentScheduler::init(int32 threads_n) {
     outbound[i] = queue;
   }
 
+  thread_settings_.clear();
+  thread_settings_.resize(threads_n);
+  is_main_thread_configured_ = false;
+
   schedulers_.resize(threads_n);
   for (int32 i = 0; i < threads_n; i++) {
     auto &sched = schedulers_[i];
@@ -55,8 +132,13 @@ void ConcurrentScheduler::start() {
 #if !TD_THREAD_UNSUPPORTED && !TD_EVENTFD_UNSUPPORTED
   for (size_t i = 1; i < schedulers_.size(); i++) {
     auto &sched = schedulers_[i];
-    threads_.push_back(td::thread([&, tid = i]() {
+    auto settings = thread_settings_[i];
+    if (settings.name.empty()) {
+      settings.name = PSTRING() << "td_sched_" << i;
+    }
+    threads_.push_back(td::thread([&, tid = i, settings = std::move(settings)]() {
       set_thread_id(static_cast<int32>(tid));
+      apply_scheduler_thread_settings(static_cast<int32>(tid), settings);
       while (!is_finished()) {
         sched->run(10);
       }
@@ -69,6 +151,13 @@ void ConcurrentScheduler::start() {
 bool ConcurrentScheduler::run_main(double timeout) {
   CHECK(state_ == State::Run);
   // run main scheduler in same thread
+  if (!is_main_thread_configured_) {
+    is_main_thread_configured_ = true;
+    auto &settings = thread_settings_[0];
+    if (!settings.name.empty() || !settings.cpus.empty() || settings.priority != 0) {
+      apply_scheduler_thread_settings(0, settings);
+    }
+  }
   auto &main_sched = schedulers_[0];
   if (!is_finished()) {
     main_sched->run(timeout);
@@ -20,10 +20,46 @@
 
 namespace td {
 
+// settings of a thread running a scheduler
+struct SchedulerThreadSettings {
+  string name;          // empty name keeps the current name
+  vector<int32> cpus;   // empty list keeps the current affinity
+  int32 priority = 0;   // nice value; 0 keeps the current priority
+};
+
+// applies settings to the calling thread, which must run the scheduler sched_id, and logs the resulting layout
+void apply_scheduler_thread_settings(int32 sched_id, const SchedulerThreadSettings &settings);
+
+// asynchronously applies settings to the thread of the scheduler sched_id; must be called from inside of a scheduler
+void set_scheduler_thread_settings(int32 sched_id, SchedulerThreadSettings settings);
+
 class ConcurrentScheduler : private Scheduler::Callback {
  public:
   void init(int32 threads_n);
 
+  // must be called after init and before start
+  // threads without explicit name are named "td_sched_<sched_id>", except the thread of the main scheduler 0,
+  // settings for which are applied on the first run_main call
+  void set_thread_settings(int32 sched_id, SchedulerThreadSettings settings) {
+    CHECK(state_ == State::Start);
+    CHECK(0 <= sched_id && sched_id < static_cast<int32>(thread_settings_.size()));
+    thread_settings_[sched_id] = std::move(settings);
+  }
+
+  // must be called after init and before any actor timeout is set
+  void set_use_timer_wheel(bool use_timer_wheel) {
+    for (auto &sched : schedulers_) {
+      sched->set_use_timer_wheel(use_timer_wheel);
+    }
+  }
+
+  // must be called after init and before start
+  void set_spin_poll_duration(double spin_duration) {
+    for (auto &sched : schedulers_) {
+      sched->set_spin_poll_duration(spin_duration);
+    }
+  }
+
   void finish_async() {
     schedulers_[0]->finish();
   }
@@ -70,6 +106,8 @@ class ConcurrentScheduler : private Scheduler::Callback {
   enum class State { Start, Run };
   State state_;
   std::vector<unique_ptr<Scheduler>> schedulers_;
+  std::vector<SchedulerThreadSettings> thread_settings_;
+  bool is_main_thread_configured_ = false;
   std::atomic<bool> is_finished_;
   std::mutex at_finish_mutex_;
   std::vector<std::function<void()>> at_finish_;
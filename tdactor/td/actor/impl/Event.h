@@ -12,6 +12,7 @@
 #include "td/utils/logging.h"
 #include "td/utils/StringBuilder.h"
 
+#include <memory>
 #include <type_traits>
 #include <utility>
 
@@ -106,6 +107,33 @@ class LambdaEvent : public CustomEvent {
   LambdaT f_;
 };
 
+// event in a mailbox of an actor, which is replaced by a newer event with the same key until it is run
+class CoalescedEvent : public CustomEvent {
+ public:
+  CoalescedEvent(uint64 key, std::unique_ptr<CustomEvent> event) : key_(key), event_(std::move(event)) {
+  }
+
+  void run(Actor *actor) override;
+  CustomEvent *clone() const override {
+    LOG(FATAL) << "Not supported";
+    return nullptr;
+  }
+  void start_migrate(int32 sched_id) override {
+    event_->start_migrate(sched_id);
+  }
+  void finish_migrate() override {
+    event_->finish_migrate();
+  }
+
+  void replace(std::unique_ptr<CustomEvent> event) {
+    event_ = std::move(event);
+  }
+
+ private:
+  uint64 key_;
+  std::unique_ptr<CustomEvent> event_;
+};
+
 class Event {
  public:
   enum class Type { NoType, Start, Stop, Yield, Timeout, Hangup, Raw, Custom };
@@ -8,9 +8,11 @@
 
 #include "td/actor/impl/Actor-decl.h"
 #include "td/actor/impl/ActorId-decl.h"
+#include "td/actor/impl/ActorStats.h"
 #include "td/actor/impl/EventFull-decl.h"
 
 #include "td/utils/Closure.h"
+#include "td/utils/FlatHashMap.h"
 #include "td/utils/Heap.h"
 #include "td/utils/List.h"
 #include "td/utils/MovableValue.h"
@@ -21,10 +23,10 @@
 #include "td/utils/port/Poll.h"
 #include "td/utils/port/thread_local.h"
 #include "td/utils/Slice.h"
+#include "td/utils/TimerWheel.h"
 #include "td/utils/type_traits.h"
 
 #include <functional>
-#include <map>
 #include <memory>
 #include <type_traits>
 #include <utility>
@@ -95,6 +97,33 @@ class Scheduler {
 
   void send_to_scheduler(int32 sched_id, const ActorId<> &actor_id, Event &&event);
   void send_to_other_scheduler(int32 sched_id, const ActorId<> &actor_id, Event &&event);
+  void flush_outbound_events();
+
+  struct OutboundStats {
+    uint64 batch_count = 0;
+    uint64 event_count = 0;
+    size_t max_batch_size = 0;
+  };
+  const OutboundStats &get_outbound_stats() const {
+    return outbound_stats_;
+  }
+
+  // use TimerWheel instead of KHeap for actor timeouts; must be called before any timeout is set
+  void set_use_timer_wheel(bool use_timer_wheel);
+
+  // low-latency mode: when idle, busy-poll the inbound queue for up to spin_duration seconds before waiting in Poll
+  // 0 disables busy polling
+  void set_spin_poll_duration(double spin_duration) {
+    spin_poll_duration_ = spin_duration;
+  }
+
+  struct SpinPollStats {
+    uint64 spin_count = 0;            // number of times busy polling was started
+    uint64 avoided_wakeup_count = 0;  // number of times an inbound event was found before waiting in Poll
+  };
+  const SpinPollStats &get_spin_poll_stats() const {
+    return spin_poll_stats_;
+  }
 
   template <class EventT>
   void send_lambda(ActorRef actor_ref, EventT &&lambda, Send::Flags flags = 0);
@@ -102,6 +131,11 @@ class Scheduler {
   template <class EventT>
   void send_closure(ActorRef actor_ref, EventT &&closure, Send::Flags flags = 0);
 
+  // sends the closure, replacing a not yet run closure, sent to the same actor with the same key
+  // closures with the same key must be interchangeable, i.e. only the last of them needs to be run
+  template <class EventT>
+  void send_closure_coalesced(ActorRef actor_ref, uint64 key, EventT &&closure);
+
   void send(ActorRef actor_ref, Event &&event, Send::Flags flags = 0);
 
   void hack(const ActorId<> &actor_id, Event &&event) {
@@ -189,6 +223,7 @@ class Scheduler {
   void run_mailbox();
   double run_events();
   void run_poll(double timeout);
+  bool spin_inbound_queue(double spin_duration);
 
   template <class ActorT>
   ActorOwn<ActorT> register_actor_impl(Slice name, ActorT *actor_ptr, Actor::Deleter deleter, int32 sched_id);
@@ -204,8 +239,10 @@ class Scheduler {
   ListNode pending_actors_list_;
   ListNode ready_actors_list_;
   KHeap<double> timeout_queue_;
+  TimerWheel timeout_wheel_;
+  bool use_timer_wheel_ = false;
 
-  std::map<ActorInfo *, std::vector<Event>> pending_events_;
+  int32 pending_actor_count_ = 0;  // number of migrating to this scheduler actors with non-empty pending_mailbox_
 
 #if !TD_THREAD_UNSUPPORTED && !TD_EVENTFD_UNSUPPORTED
   EventFd event_fd_;
@@ -222,6 +259,21 @@ class Scheduler {
   int32 sched_n_;
   std::shared_ptr<MpscPollableQueue<EventFull>> inbound_queue_;
   std::vector<std::shared_ptr<MpscPollableQueue<EventFull>>> outbound_queues_;
+  std::vector<std::vector<EventFull>> outbound_events_;  // events to be sent to other schedulers in one batch
+  using CoalescedEventKey = std::pair<ActorInfo *, uint64>;
+  struct CoalescedEventKeyHash {
+    std::size_t operator()(const CoalescedEventKey &key) const {
+      return std::hash<ActorInfo *>()(key.first) * 2023654985u + std::hash<uint64>()(key.second);
+    }
+  };
+  // (actor, key) -> (sched_id, index in outbound_events_[sched_id]) of coalesced events
+  FlatHashMap<CoalescedEventKey, std::pair<int32, size_t>, CoalescedEventKeyHash> outbound_coalesced_events_;
+  OutboundStats outbound_stats_;
+
+  double spin_poll_duration_ = 0;
+  SpinPollStats spin_poll_stats_;
+
+  ActorStats::Storage actor_stats_;
 
   std::shared_ptr<ActorContext> save_context_;
 
@@ -267,6 +319,16 @@ void send_closure(ActorIdT &&actor_id, FunctionT function, ArgsT &&... args) {
                                       create_immediate_closure(function, std::forward<ArgsT>(args)...));
 }
 
+template <class ActorIdT, class FunctionT, class... ArgsT>
+void send_closure_coalesced(ActorIdT &&actor_id, uint64 key, FunctionT function, ArgsT &&... args) {
+  using ActorT = typename std::decay_t<ActorIdT>::ActorT;
+  using FunctionClassT = member_function_class_t<FunctionT>;
+  static_assert(std::is_base_of<FunctionClassT, ActorT>::value, "unsafe send_closure");
+
+  Scheduler::instance()->send_closure_coalesced(std::forward<ActorIdT>(actor_id), key,
+                                                create_immediate_closure(function, std::forward<ArgsT>(args)...));
+}
+
 template <class ActorIdT, class FunctionT, class... ArgsT>
 void send_closure_later(ActorIdT &&actor_id, FunctionT function, ArgsT &&... args) {
   using ActorT = typename std::decay_t<ActorIdT>::ActorT;
@@ -17,10 +17,12 @@
 #include "td/utils/List.h"
 #include "td/utils/logging.h"
 #include "td/utils/ObjectPool.h"
+#include "td/utils/port/cpu.h"
 #include "td/utils/port/thread_local.h"
 #include "td/utils/ScopeGuard.h"
 #include "td/utils/Time.h"
 
+#include <algorithm>
 #include <functional>
 #include <utility>
 
@@ -49,6 +51,11 @@ void Scheduler::set_scheduler(Scheduler *scheduler) {
   scheduler_ = scheduler;
 }
 
+void CoalescedEvent::run(Actor *actor) {
+  actor->get_info()->on_coalesced_event_run(key_, this);
+  event_->run(actor);
+}
+
 void Scheduler::ServiceActor::start_up() {
 #if TD_THREAD_UNSUPPORTED || TD_EVENTFD_UNSUPPORTED
   CHECK(!inbound_);
@@ -100,6 +107,7 @@ SchedulerGuard::SchedulerGuard(Scheduler *scheduler) : scheduler_(scheduler) {
 
 SchedulerGuard::~SchedulerGuard() {
   if (is_valid_.get()) {
+    scheduler_->flush_outbound_events();
     std::swap(save_context_, scheduler_->context());
     Scheduler::set_scheduler(save_scheduler_);
     CHECK(scheduler_->has_guard_);
@@ -189,6 +197,7 @@ void Scheduler::init(int32 id, std::vector<std::shared_ptr<MpscPollableQueue<Eve
     inbound_queue_ = std::move(outbound[id]);
   }
   outbound_queues_ = std::move(outbound);
+  outbound_events_.resize(outbound_queues_.size());
   sched_id_ = id;
   sched_n_ = static_cast<int32>(outbound_queues_.size());
   service_actor_.set_queue(inbound_queue_);
@@ -295,11 +304,18 @@ void Scheduler::register_migrated_actor(ActorInfo *actor_info) {
   for (auto &event : actor_info->mailbox_) {
     finish_migrate(event);
   }
-  auto it = pending_events_.find(actor_info);
-  if (it != pending_events_.end()) {
-    actor_info->mailbox_.insert(actor_info->mailbox_.end(), make_move_iterator(begin(it->second)),
-                                make_move_iterator(end(it->second)));
-    pending_events_.erase(it);
+  auto &pending_mailbox = actor_info->pending_mailbox_;
+  if (!pending_mailbox.empty()) {
+    pending_actor_count_--;
+    CHECK(pending_actor_count_ >= 0);
+    if (actor_info->mailbox_.empty()) {
+      // keep allocated memory of both vectors for next migrations
+      std::swap(actor_info->mailbox_, pending_mailbox);
+    } else {
+      actor_info->mailbox_.insert(actor_info->mailbox_.end(), make_move_iterator(begin(pending_mailbox)),
+                                  make_move_iterator(end(pending_mailbox)));
+      pending_mailbox.clear();
+    }
   }
   if (actor_info->mailbox_.empty()) {
     pending_actors_list_.put(actor_info->get_list_node());
@@ -318,9 +334,26 @@ void Scheduler::send_to_other_scheduler(int32 sched_id, const ActorId<> &actor_i
       VLOG(actor) << "Send to scheduler " << sched_id << ": " << event;
     }
     start_migrate(event, sched_id);
-    outbound_queues_[sched_id]->writer_put(EventCreator::event_unsafe(actor_id, std::move(event)));
+    outbound_events_[sched_id].push_back(EventCreator::event_unsafe(actor_id, std::move(event)));
+  }
+}
+
+void Scheduler::flush_outbound_events() {
+  for (size_t sched_id = 0; sched_id < outbound_events_.size(); sched_id++) {
+    auto &events = outbound_events_[sched_id];
+    if (events.empty()) {
+      continue;
+    }
+    outbound_stats_.batch_count++;
+    outbound_stats_.event_count += events.size();
+    if (events.size() > outbound_stats_.max_batch_size) {
+      outbound_stats_.max_batch_size = events.size();
+    }
+    VLOG(actor) << "Send " << events.size() << " events to scheduler " << sched_id;
+    outbound_queues_[sched_id]->writer_put_batch(events);
     outbound_queues_[sched_id]->writer_flush();
   }
+  outbound_coalesced_events_.clear();
 }
 
 void Scheduler::add_to_mailbox(ActorInfo *actor_info, Event &&event) {
@@ -331,6 +364,7 @@ void Scheduler::add_to_mailbox(ActorInfo *actor_info, Event &&event) {
   }
   VLOG(actor) << "Add to mailbox: " << *actor_info << " " << event;
   actor_info->mailbox_.push_back(std::move(event));
+  actor_stats_.on_mailbox_size(actor_info->get_name(), actor_info->mailbox_.size());
 }
 
 void Scheduler::do_stop_actor(Actor *actor) {
@@ -342,7 +376,10 @@ void Scheduler::do_stop_actor(ActorInfo *actor_info) {
   ObjectPool<ActorInfo>::OwnerPtr owner_ptr;
   if (!actor_info->is_lite()) {
     EventGuard guard(this, actor_info);
-    do_event(actor_info, Event::stop());
+    {
+      ActorStatsGuard stats_guard(&actor_stats_, actor_info->get_name(), 1);
+      do_event(actor_info, Event::stop());
+    }
     owner_ptr = actor_info->get_actor_unsafe()->clear();
     // Actor context is visible in destructor
     actor_info->destroy_actor();
@@ -410,6 +447,14 @@ void Scheduler::set_actor_timeout_in(ActorInfo *actor_info, double timeout) {
 void Scheduler::set_actor_timeout_at(ActorInfo *actor_info, double timeout_at) {
   HeapNode *heap_node = actor_info->get_heap_node();
   VLOG(actor) << "set actor " << *actor_info << " " << tag("timeout", timeout_at) << timeout_at - Time::now_cached();
+  if (use_timer_wheel_) {
+    if (heap_node->in_heap()) {
+      timeout_wheel_.fix(timeout_at, heap_node);
+    } else {
+      timeout_wheel_.insert(timeout_at, heap_node);
+    }
+    return;
+  }
   if (heap_node->in_heap()) {
     timeout_queue_.fix(timeout_at, heap_node);
   } else {
@@ -417,10 +462,46 @@ void Scheduler::set_actor_timeout_at(ActorInfo *actor_info, double timeout_at) {
   }
 }
 
+void Scheduler::set_use_timer_wheel(bool use_timer_wheel) {
+  CHECK(timeout_queue_.empty() && timeout_wheel_.empty());
+  use_timer_wheel_ = use_timer_wheel;
+}
+
+bool Scheduler::spin_inbound_queue(double spin_duration) {
+  spin_poll_stats_.spin_count++;
+  double end_time = Time::now() + spin_duration;
+  while (true) {
+    for (int i = 0; i < 64; i++) {
+      if (inbound_queue_->reader_has_values()) {
+        spin_poll_stats_.avoided_wakeup_count++;
+        // the event_fd of the queue may be not released, so the ServiceActor must be woken up explicitly
+        yield_actor(&service_actor_);
+        return true;
+      }
+      cpu_relax();
+    }
+    if (Time::now() >= end_time) {
+      return false;
+    }
+  }
+}
+
 void Scheduler::run_poll(double timeout) {
   // LOG(DEBUG) << "run poll [timeout:" << format::as_time(timeout) << "]";
   // we can't wait for less than 1ms
-  poll_.run(static_cast<int32>(timeout * 1000 + 1));
+  auto timeout_ms = static_cast<int32>(timeout * 1000 + 1);
+#if !TD_THREAD_UNSUPPORTED && !TD_EVENTFD_UNSUPPORTED
+  if (spin_poll_duration_ > 0 && timeout > 0 && inbound_queue_ != nullptr) {
+    auto spin_duration = std::min(timeout, spin_poll_duration_);
+    if (spin_inbound_queue(spin_duration)) {
+      // just collect already ready events
+      timeout_ms = 0;
+    } else {
+      timeout_ms = static_cast<int32>((timeout - spin_duration) * 1000 + 1);
+    }
+  }
+#endif
+  poll_.run(timeout_ms);
 
 #if !TD_THREAD_UNSUPPORTED && !TD_EVENTFD_UNSUPPORTED
   if (can_read(event_fd_.get_fd())) {
@@ -462,6 +543,17 @@ void Scheduler::run_mailbox() {
 
 double Scheduler::run_timeout() {
   double now = Time::now();
+  if (use_timer_wheel_) {
+    while (HeapNode *node = timeout_wheel_.pop_expired(now)) {
+      ActorInfo *actor_info = ActorInfo::from_heap_node(node);
+      inc_wait_generation();
+      send(actor_info->actor_id(), Event::timeout(), Send::immediate);
+    }
+    if (timeout_wheel_.empty()) {
+      return 10000;
+    }
+    return timeout_wheel_.next_key() - now;
+  }
   while (!timeout_queue_.empty() && timeout_queue_.top_key() < now) {
     HeapNode *node = timeout_queue_.pop();
     ActorInfo *actor_info = ActorInfo::from_heap_node(node);
@@ -155,10 +155,12 @@ void Scheduler::flush_mailbox(ActorInfo *actor_info, const RunFuncT &run_func, c
   EventGuard guard(this, actor_info);
   size_t i = 0;
   for (; i < mailbox_size && guard.can_run(); i++) {
+    ActorStatsGuard stats_guard(&actor_stats_, actor_info->get_name(), mailbox_size - i);
     do_event(actor_info, std::move(mailbox[i]));
   }
   if (run_func) {
     if (guard.can_run()) {
+      ActorStatsGuard stats_guard(&actor_stats_, actor_info->get_name(), 1);
       (*run_func)(actor_info);
     } else {
       mailbox.insert(begin(mailbox) + i, (*event_func)());
@@ -170,7 +172,11 @@ void Scheduler::flush_mailbox(ActorInfo *actor_info, const RunFuncT &run_func, c
 inline void Scheduler::send_to_scheduler(int32 sched_id, const ActorId<> &actor_id, Event &&event) {
   if (sched_id == sched_id_) {
     ActorInfo *actor_info = actor_id.get_actor_info();
-    pending_events_[actor_info].push_back(std::move(event));
+    auto &pending_mailbox = actor_info->pending_mailbox_;
+    if (pending_mailbox.empty()) {
+      pending_actor_count_++;
+    }
+    pending_mailbox.push_back(std::move(event));
   } else {
     send_to_other_scheduler(sched_id, actor_id, std::move(event));
   }
@@ -204,6 +210,7 @@ void Scheduler::send_impl(const ActorId<> &actor_id, Send::Flags flags, const Ru
              !actor_info->must_wait(wait_generation_))) {  // run immediately
     if (likely(actor_info->mailbox_.empty())) {
       EventGuard guard(this, actor_info);
+      ActorStatsGuard stats_guard(&actor_stats_, actor_info->get_name(), 1);
       run_func(actor_info);
     } else {
       flush_mailbox(actor_info, &run_func, &event_func);
@@ -248,6 +255,57 @@ void Scheduler::send_closure(ActorRef actor_ref, EventT &&closure, Send::Flags f
                    });
 }
 
+template <class EventT>
+void Scheduler::send_closure_coalesced(ActorRef actor_ref, uint64 key, EventT &&closure) {
+  CHECK(has_guard_);
+  ActorInfo *actor_info = actor_ref.get().get_actor_info();
+  if (unlikely(actor_info == nullptr || close_flag_)) {
+    return;
+  }
+
+  int32 actor_sched_id;
+  bool is_migrating;
+  std::tie(actor_sched_id, is_migrating) = actor_info->migrate_dest_flag_atomic();
+  if (actor_sched_id >= sched_count() || (is_migrating && actor_sched_id == sched_id_)) {
+    return send_closure(actor_ref, std::forward<EventT>(closure));
+  }
+
+  if (actor_sched_id != sched_id_) {
+    // the event will be sent in a batch in flush_outbound_events
+    auto &outbound_events = outbound_events_[actor_sched_id];
+    CoalescedEventKey coalesced_event_key(actor_info, key);
+    auto it = outbound_coalesced_events_.find(coalesced_event_key);
+    if (it != outbound_coalesced_events_.end() && it->second.first == actor_sched_id &&
+        it->second.second < outbound_events.size()) {
+      // the previous event hasn't been sent yet, so it can be replaced in place
+      auto event = Event::immediate_closure(std::forward<EventT>(closure));
+      event.set_link_token(actor_ref.token());
+      start_migrate(event, actor_sched_id);
+      outbound_events[it->second.second] = EventCreator::event_unsafe(actor_ref.get(), std::move(event));
+      return;
+    }
+    outbound_coalesced_events_[coalesced_event_key] = std::make_pair(actor_sched_id, outbound_events.size());
+    return send_closure(actor_ref, std::forward<EventT>(closure));
+  }
+
+  auto coalesced_event = actor_info->get_coalesced_event(key);
+  if (coalesced_event != nullptr) {
+    // the link token of the first event is kept
+    coalesced_event->replace(
+        std::make_unique<ClosureEvent<typename std::decay_t<EventT>::Delayed>>(std::forward<EventT>(closure)));
+    return;
+  }
+  if (actor_info->is_running() || actor_info->must_wait(wait_generation_)) {
+    coalesced_event = new CoalescedEvent(
+        key, std::make_unique<ClosureEvent<typename std::decay_t<EventT>::Delayed>>(std::forward<EventT>(closure)));
+    actor_info->add_coalesced_event(key, coalesced_event);
+    auto event = Event::custom(coalesced_event);
+    event.set_link_token(actor_ref.token());
+    return add_to_mailbox(actor_info, std::move(event));
+  }
+  send_closure(actor_ref, std::forward<EventT>(closure));
+}
+
 inline void Scheduler::send(ActorRef actor_ref, Event &&event, Send::Flags flags) {
   event.set_link_token(actor_ref.token());
   return send_impl(actor_ref.get(), flags, [&](ActorInfo *actor_info) { do_event(actor_info, std::move(event)); },
@@ -314,7 +372,11 @@ inline bool Scheduler::has_actor_timeout(const ActorInfo *actor_info) const {
 inline void Scheduler::cancel_actor_timeout(ActorInfo *actor_info) {
   HeapNode *heap_node = actor_info->get_heap_node();
   if (heap_node->in_heap()) {
-    timeout_queue_.erase(heap_node);
+    if (use_timer_wheel_) {
+      timeout_wheel_.erase(heap_node);
+    } else {
+      timeout_queue_.erase(heap_node);
+    }
   }
 }
 
@@ -338,11 +400,14 @@ inline void Scheduler::wakeup() {
 
 inline double Scheduler::run_events() {
   double res;
-  VLOG(actor) << "run events " << sched_id_ << " " << tag("pending", pending_events_.size())
-              << tag("actors", actor_count_);
+  VLOG(actor) << "run events " << sched_id_ << " " << tag("pending", pending_actor_count_)
+              << tag("actors", actor_count_) << tag("outbound_batches", outbound_stats_.batch_count)
+              << tag("outbound_events", outbound_stats_.event_count)
+              << tag("avoided_wakeups", spin_poll_stats_.avoided_wakeup_count);
   do {
     run_mailbox();
     res = run_timeout();
+    flush_outbound_events();
   } while (!ready_actors_list_.empty());
   return res;
 }
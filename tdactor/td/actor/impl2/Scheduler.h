@@ -1121,16 +1121,18 @@ class Scheduler {
       }
       scheduler_info.io_queue.reset();
 
-      // Drain cpu queue
-      auto &cpu_queue = *scheduler_info.cpu_queue;
-      while (true) {
-        SchedulerMessage message;
-        if (!cpu_queue.try_pop(message, get_thread_id())) {
-          break;
+      // Drain cpu queue, which doesn't exist if there are no cpu workers
+      if (scheduler_info.cpu_queue) {
+        auto &cpu_queue = *scheduler_info.cpu_queue;
+        while (true) {
+          SchedulerMessage message;
+          if (!cpu_queue.try_pop(message, get_thread_id())) {
+            break;
+          }
+          // message's destructor is called
         }
-        // message's destructor is called
+        scheduler_info.cpu_queue.reset();
       }
-      scheduler_info.cpu_queue.reset();
 
       // Do not destroy worker infos. run_in_context will crash if they are empty
     }
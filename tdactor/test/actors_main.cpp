@@ -8,9 +8,11 @@
 
 #include "td/actor/actor.h"
 #include "td/actor/PromiseFuture.h"
+#include "td/actor/Timeout.h"
 
 #include "td/utils/logging.h"
 #include "td/utils/Random.h"
+#include "td/utils/Time.h"
 
 #include <initializer_list>
 #include <limits>
@@ -462,3 +464,193 @@ TEST(Actors, do_after_stop) {
   }
   sched.finish();
 }
+
+class TimeoutChecker : public Actor {
+ public:
+  enum class Type : int32 { Simple, SetEarlier, SetLater, Cancel, Size };
+
+  TimeoutChecker(ActorShared<> parent, Type type) : parent_(std::move(parent)), type_(type) {
+  }
+
+  void start_up() override {
+    auto timeout = Random::fast(0, 3) * 0.001;
+    switch (type_) {
+      case Type::SetEarlier:
+        set_timeout_in(1000);
+        break;
+      case Type::SetLater:
+        set_timeout_in(0);
+        timeout += 0.005;
+        break;
+      default:
+        break;
+    }
+    expire_at_ = Time::now() + timeout;
+    set_timeout_in(timeout);
+    if (type_ == Type::Cancel) {
+      cancel_timeout();
+    }
+  }
+
+  void timeout_expired() override {
+    CHECK(type_ != Type::Cancel);
+    CHECK(Time::now() >= expire_at_);
+    stop();
+  }
+
+ private:
+  ActorShared<> parent_;
+  Type type_;
+  double expire_at_ = 0;
+};
+
+class MultiTimeoutChecker : public Actor {
+ public:
+  MultiTimeoutChecker(ActorShared<> parent, bool use_timer_wheel)
+      : parent_(std::move(parent)), use_timer_wheel_(use_timer_wheel) {
+  }
+
+ private:
+  static constexpr int32 KEY_COUNT = 200;
+
+  ActorShared<> parent_;
+  bool use_timer_wheel_;
+  unique_ptr<MultiTimeout> timeout_;  // must be registered on the scheduler of the checker
+  vector<double> expire_at_;  // 0 if the timeout was cancelled
+  vector<int32> fire_count_;
+  int32 left_ = 0;
+
+  static void on_timeout_callback(void *checker_ptr, int64 key) {
+    static_cast<MultiTimeoutChecker *>(checker_ptr)->on_timeout(key);
+  }
+
+  void on_timeout(int64 key) {
+    CHECK(0 < key && key <= KEY_COUNT);
+    CHECK(expire_at_[key] != 0);
+    CHECK(Time::now() >= expire_at_[key]);
+    CHECK(fire_count_[key] == 0);
+    fire_count_[key]++;
+    if (--left_ == 0) {
+      // wait for cancelled timeouts, which must not fire
+      set_timeout_in(0.02);
+    }
+  }
+
+  void start_up() override {
+    timeout_ = make_unique<MultiTimeout>();
+    timeout_->set_use_timer_wheel(use_timer_wheel_);
+    timeout_->set_callback(on_timeout_callback);
+    timeout_->set_callback_data(static_cast<void *>(this));
+    expire_at_.resize(KEY_COUNT + 1);
+    fire_count_.resize(KEY_COUNT + 1);
+    for (int64 key = 1; key <= KEY_COUNT; key++) {
+      auto timeout = Random::fast(0, 3) * 0.001;
+      auto now = Time::now();
+      switch (key % 5) {
+        case 0:
+          timeout_->set_timeout_in(key, timeout);
+          expire_at_[key] = now + timeout;
+          break;
+        case 1:
+          // the second add_timeout_in must be ignored
+          timeout_->add_timeout_in(key, timeout);
+          timeout_->add_timeout_in(key, 1000);
+          expire_at_[key] = now + timeout;
+          break;
+        case 2:
+          timeout_->set_timeout_in(key, 1000);
+          timeout_->set_timeout_in(key, timeout);
+          expire_at_[key] = now + timeout;
+          break;
+        case 3:
+          timeout_->set_timeout_in(key, 0);
+          timeout_->set_timeout_in(key, timeout + 0.005);
+          expire_at_[key] = now + timeout + 0.005;
+          break;
+        case 4:
+          timeout_->add_timeout_in(key, timeout);
+          timeout_->cancel_timeout(key);
+          CHECK(!timeout_->has_timeout(key));
+          break;
+      }
+      if (expire_at_[key] != 0) {
+        left_++;
+      }
+    }
+  }
+
+  void timeout_expired() override {
+    for (int64 key = 1; key <= KEY_COUNT; key++) {
+      CHECK(fire_count_[key] == (expire_at_[key] != 0 ? 1 : 0));
+      CHECK(!timeout_->has_timeout(key));
+    }
+    stop();
+  }
+};
+
+constexpr int32 MultiTimeoutChecker::KEY_COUNT;
+
+class TimeoutManager : public Actor {
+ public:
+  explicit TimeoutManager(bool use_timer_wheel) : use_timer_wheel_(use_timer_wheel) {
+  }
+
+ private:
+  bool use_timer_wheel_;
+  int32 ref_cnt_ = 0;
+  vector<ActorOwn<TimeoutChecker>> cancelled_checkers_;
+
+  void start_up() override {
+    auto sched_count = static_cast<uint32>(Scheduler::instance()->sched_count());
+    for (int i = 0; i < 1000; i++) {
+      auto type = static_cast<TimeoutChecker::Type>(i % static_cast<int32>(TimeoutChecker::Type::Size));
+      auto sched_id = static_cast<int32>(Random::fast_uint32() % sched_count);
+      if (type == TimeoutChecker::Type::Cancel) {
+        cancelled_checkers_.push_back(
+            create_actor_on_scheduler<TimeoutChecker>("TimeoutChecker", sched_id, ActorShared<>(), type));
+      } else {
+        create_actor_on_scheduler<TimeoutChecker>("TimeoutChecker", sched_id, create_reference(), type).release();
+      }
+    }
+    for (int32 sched_id = 0; sched_id < static_cast<int32>(sched_count); sched_id++) {
+      create_actor_on_scheduler<MultiTimeoutChecker>("MultiTimeoutChecker", sched_id, create_reference(),
+                                                     use_timer_wheel_)
+          .release();
+    }
+  }
+
+  ActorShared<> create_reference() {
+    ref_cnt_++;
+    return actor_shared();
+  }
+
+  void hangup_shared() override {
+    if (--ref_cnt_ == 0) {
+      // wait for cancelled timeouts, which must not fire
+      set_timeout_in(0.02);
+    }
+  }
+
+  void timeout_expired() override {
+    cancelled_checkers_.clear();
+    Scheduler::instance()->finish();
+    stop();
+  }
+};
+
+TEST(Actors, timeouts) {
+  SET_VERBOSITY_LEVEL(VERBOSITY_NAME(ERROR));
+  for (auto use_timer_wheel : {false, true}) {
+    ConcurrentScheduler sched;
+    int threads_n = 3;
+    sched.init(threads_n);
+    sched.set_use_timer_wheel(use_timer_wheel);
+
+    sched.create_actor_unsafe<TimeoutManager>(0, "TimeoutManager", use_timer_wheel).release();
+    sched.start();
+    while (sched.run_main(10)) {
+      // empty
+    }
+    sched.finish();
+  }
+}
@@ -14,6 +14,7 @@
 #include "td/utils/logging.h"
 #include "td/utils/Observer.h"
 #include "td/utils/port/FileFd.h"
+#include "td/utils/port/thread_settings.h"
 #include "td/utils/Slice.h"
 #include "td/utils/Status.h"
 #include "td/utils/StringBuilder.h"
@@ -583,3 +584,203 @@ TEST(Actors, stop_in_teardown) {
   }
   scheduler.finish();
 }
+
+class StatsWorker : public Actor {
+ public:
+  void work() {
+    cnt_++;
+  }
+  void finish() {
+    CHECK(cnt_ == 100);
+    stop();
+    Scheduler::instance()->finish();
+  }
+
+ private:
+  int cnt_ = 0;
+};
+
+class StatsMaster : public Actor {
+  void start_up() override {
+    auto worker = create_actor<StatsWorker>("StatsWorker").release();
+    for (int i = 0; i < 100; i++) {
+      send_closure_later(worker, &StatsWorker::work);
+    }
+    send_closure_later(worker, &StatsWorker::finish);
+    stop();
+  }
+};
+
+TEST(Actors, actor_stats) {
+  SET_VERBOSITY_LEVEL(VERBOSITY_NAME(ERROR));
+  ActorStats::reset();
+  ActorStats::set_enabled(true);
+  ConcurrentScheduler scheduler;
+  scheduler.init(0);
+  scheduler.create_actor_unsafe<StatsMaster>(0, "StatsMaster").release();
+  scheduler.start();
+  while (scheduler.run_main(10)) {
+  }
+  scheduler.finish();
+  ActorStats::set_enabled(false);
+
+  bool found = false;
+  for (auto &entry : ActorStats::get_entries()) {
+    if (entry.name == "StatsWorker") {
+      found = true;
+      ASSERT_EQ(103u, entry.event_count);  // start_up, 101 closures and tear_down
+      ASSERT_TRUE(entry.max_mailbox_size >= 101u);
+      ASSERT_TRUE(entry.max_event_time <= entry.total_time);
+    }
+  }
+  ASSERT_TRUE(found);
+}
+
+#if !TD_THREAD_UNSUPPORTED && !TD_EVENTFD_UNSUPPORTED
+class CoalescedMaster;
+
+class CoalescedWorker : public Actor {
+ public:
+  void set_value(int value) {
+    values_.push_back(value);
+  }
+  void set_other_value(int value) {
+    other_values_.push_back(value);
+  }
+  void finish(ActorId<CoalescedMaster> master);
+
+ private:
+  vector<int> values_;
+  vector<int> other_values_;
+};
+
+class CoalescedMaster : public Actor {
+ public:
+  explicit CoalescedMaster(int32 worker_sched_id) : worker_sched_id_(worker_sched_id) {
+  }
+
+ private:
+  int32 worker_sched_id_;
+  ActorOwn<CoalescedWorker> worker_;
+
+  void start_up() override {
+    worker_ = create_actor_on_scheduler<CoalescedWorker>("CoalescedWorker", worker_sched_id_);
+    send_closure_later(worker_, &CoalescedWorker::set_value, -1);
+    for (int i = 0; i < 100; i++) {
+      send_closure_coalesced(worker_, 1, &CoalescedWorker::set_value, i);
+      send_closure_coalesced(worker_, 2, &CoalescedWorker::set_other_value, i);
+    }
+    send_closure_later(worker_, &CoalescedWorker::finish, actor_id(this));
+  }
+
+ public:
+  void on_finished() {
+    stop();
+    Scheduler::instance()->finish();
+  }
+};
+
+void CoalescedWorker::finish(ActorId<CoalescedMaster> master) {
+  CHECK(values_ == vector<int>({-1, 99}));
+  CHECK(other_values_ == vector<int>({99}));
+  send_closure(master, &CoalescedMaster::on_finished);
+}
+
+TEST(Actors, send_closure_coalesced) {
+  SET_VERBOSITY_LEVEL(VERBOSITY_NAME(ERROR));
+  for (int32 worker_sched_id = 0; worker_sched_id < 2; worker_sched_id++) {
+    ConcurrentScheduler scheduler;
+    scheduler.init(1);
+    scheduler.create_actor_unsafe<CoalescedMaster>(0, "CoalescedMaster", worker_sched_id).release();
+    scheduler.start();
+    while (scheduler.run_main(10)) {
+    }
+    scheduler.finish();
+  }
+}
+
+class ThreadSettingsChecker : public Actor {
+ public:
+  explicit ThreadSettingsChecker(vector<int32> expected_cpus) : expected_cpus_(std::move(expected_cpus)) {
+  }
+
+ private:
+  vector<int32> expected_cpus_;
+
+  void start_up() override {
+    auto r_cpus = get_current_thread_affinity();
+    if (r_cpus.is_ok()) {
+      CHECK(r_cpus.ok() == expected_cpus_);
+    }
+    stop();
+    Scheduler::instance()->finish();
+  }
+};
+
+TEST(Actors, scheduler_thread_settings) {
+  SET_VERBOSITY_LEVEL(VERBOSITY_NAME(ERROR));
+  auto r_cpus = get_current_thread_affinity();
+  if (r_cpus.is_error() || r_cpus.ok().empty()) {
+    return;
+  }
+  vector<int32> cpus{r_cpus.ok()[0]};
+
+  ConcurrentScheduler scheduler;
+  scheduler.init(1);
+  SchedulerThreadSettings settings;
+  settings.name = "td_test_sched";
+  settings.cpus = cpus;
+  scheduler.set_thread_settings(1, std::move(settings));
+  scheduler.create_actor_unsafe<ThreadSettingsChecker>(1, "ThreadSettingsChecker", cpus).release();
+  scheduler.start();
+  while (scheduler.run_main(10)) {
+  }
+  scheduler.finish();
+}
+#endif
+
+#if !TD_THREAD_UNSUPPORTED && !TD_EVENTFD_UNSUPPORTED
+class SpinPollPing;
+
+class SpinPollPong : public Actor {
+ public:
+  void ping(ActorId<SpinPollPing> sender, int32 left);
+};
+
+class SpinPollPing : public Actor {
+ public:
+  void pong(int32 left) {
+    if (left == 0) {
+      CHECK(Scheduler::instance()->get_spin_poll_stats().spin_count > 0);
+      stop();
+      Scheduler::instance()->finish();
+      return;
+    }
+    send_closure(pong_, &SpinPollPong::ping, actor_id(this), left - 1);
+  }
+
+ private:
+  ActorOwn<SpinPollPong> pong_;
+
+  void start_up() override {
+    pong_ = create_actor_on_scheduler<SpinPollPong>("SpinPollPong", 1);
+    send_closure(pong_, &SpinPollPong::ping, actor_id(this), 100);
+  }
+};
+
+void SpinPollPong::ping(ActorId<SpinPollPing> sender, int32 left) {
+  send_closure(sender, &SpinPollPing::pong, left);
+}
+
+TEST(Actors, spin_poll) {
+  SET_VERBOSITY_LEVEL(VERBOSITY_NAME(ERROR));
+  ConcurrentScheduler scheduler;
+  scheduler.init(1);
+  scheduler.set_spin_poll_duration(0.0001);
+  scheduler.create_actor_unsafe<SpinPollPing>(0, "SpinPollPing").release();
+  scheduler.start();
+  while (scheduler.run_main(10)) {
+  }
+  scheduler.finish();
+}
+#endif
@@ -33,6 +33,7 @@ class FdInterface {
   virtual Status get_pending_error() TD_WARN_UNUSED_RESULT = 0;
 
   virtual Result<size_t> write(Slice slice) TD_WARN_UNUSED_RESULT = 0;
+  virtual Result<size_t> writev(const Slice *slices, size_t slice_count) TD_WARN_UNUSED_RESULT = 0;
   virtual Result<size_t> read(MutableSlice slice) TD_WARN_UNUSED_RESULT = 0;
 
   virtual void close() = 0;
@@ -62,6 +63,9 @@ class FdToInterface : public FdInterface {
   Result<size_t> write(Slice slice) final TD_WARN_UNUSED_RESULT {
     return fd_.write(slice);
   }
+  Result<size_t> writev(const Slice *slices, size_t slice_count) final TD_WARN_UNUSED_RESULT {
+    return fd_.writev(slices, slice_count);
+  }
   Result<size_t> read(MutableSlice slice) final TD_WARN_UNUSED_RESULT {
     return fd_.read(slice);
   }
@@ -104,6 +108,9 @@ class FdProxy {
   Result<size_t> write(Slice slice) TD_WARN_UNUSED_RESULT {
     return fd_->write(slice);
   }
+  Result<size_t> writev(const Slice *slices, size_t slice_count) TD_WARN_UNUSED_RESULT {
+    return fd_->writev(slices, slice_count);
+  }
   Result<size_t> read(MutableSlice slice) TD_WARN_UNUSED_RESULT {
     return fd_->read(slice);
   }
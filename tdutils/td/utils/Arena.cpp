@@ -0,0 +1,118 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2018
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/utils/Arena.h"
+
+#include "td/utils/logging.h"
+#include "td/utils/port/thread_local.h"
+
+#include <new>
+
+namespace td {
+
+namespace {
+
+// every allocated block is preceded by a header with a pointer to the owning arena or nullptr for heap blocks;
+// the header also keeps the returned memory aligned to HEADER_SIZE
+constexpr size_t HEADER_SIZE = 16;
+static_assert(sizeof(Arena *) <= HEADER_SIZE, "Arena header is too small");
+
+TD_THREAD_LOCAL Arena *current_arena;  // static zero-initialized
+
+size_t align_size(size_t size) {
+  return (size + HEADER_SIZE - 1) & ~(HEADER_SIZE - 1);
+}
+
+}  // namespace
+
+constexpr int64 Arena::GUARD_REF_CNT;
+constexpr size_t Arena::MIN_CHUNK_SIZE;
+constexpr size_t Arena::MAX_CHUNK_SIZE;
+
+std::atomic<size_t> Arena::arena_mem_{0};
+
+void *Arena::allocate(size_t size) {
+  void *header;
+  Arena *arena = current_arena;
+  if (arena != nullptr) {
+    header = arena->do_allocate(HEADER_SIZE + size);
+  } else {
+    header = ::operator new(HEADER_SIZE + size);
+  }
+  *static_cast<Arena **>(header) = arena;
+  return static_cast<char *>(header) + HEADER_SIZE;
+}
+
+void Arena::deallocate(void *ptr) noexcept {
+  if (ptr == nullptr) {
+    return;
+  }
+  void *header = static_cast<char *>(ptr) - HEADER_SIZE;
+  Arena *arena = *static_cast<Arena **>(header);
+  if (arena == nullptr) {
+    ::operator delete(header);
+  } else {
+    arena->dec_ref_cnt(1);
+  }
+}
+
+size_t Arena::get_arena_mem() {
+  return arena_mem_.load(std::memory_order_relaxed);
+}
+
+Arena::Guard::Guard() : arena_(new Arena()), old_arena_(current_arena) {
+  current_arena = arena_;
+}
+
+Arena::Guard::~Guard() {
+  CHECK(current_arena == arena_);
+  current_arena = old_arena_;
+  arena_->dec_ref_cnt(GUARD_REF_CNT - arena_->allocation_count_);
+}
+
+Arena::~Arena() {
+  while (chunk_ != nullptr) {
+    char *next = *reinterpret_cast<char **>(chunk_);
+    ::operator delete(chunk_);
+    chunk_ = next;
+  }
+  arena_mem_.fetch_sub(mem_, std::memory_order_relaxed);
+}
+
+void *Arena::do_allocate(size_t size) {
+  size = align_size(size);
+  if (static_cast<size_t>(end_ - begin_) < size) {
+    // the rest of the current chunk is wasted
+    size_t chunk_size = next_chunk_size_;
+    if (chunk_size < MAX_CHUNK_SIZE) {
+      next_chunk_size_ *= 2;
+    }
+    if (chunk_size < HEADER_SIZE + size) {
+      chunk_size = HEADER_SIZE + size;
+    }
+    auto chunk = static_cast<char *>(::operator new(chunk_size));
+    *reinterpret_cast<char **>(chunk) = chunk_;
+    chunk_ = chunk;
+    begin_ = chunk + HEADER_SIZE;
+    end_ = chunk + chunk_size;
+    mem_ += chunk_size;
+    arena_mem_.fetch_add(chunk_size, std::memory_order_relaxed);
+  }
+  auto result = begin_;
+  begin_ += size;
+  allocation_count_++;
+  return result;
+}
+
+void Arena::dec_ref_cnt(int64 count) {
+  auto old_ref_cnt = ref_cnt_.fetch_sub(count, std::memory_order_acq_rel);
+  CHECK(old_ref_cnt >= count);
+  if (old_ref_cnt == count) {
+    delete this;
+  }
+}
+
+}  // namespace td
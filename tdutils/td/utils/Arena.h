@@ -0,0 +1,69 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2018
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/common.h"
+
+#include <atomic>
+
+namespace td {
+
+// Region allocator for many small objects with a common lifetime, like TL objects of one network query result.
+// While an Arena::Guard is alive, Arena::allocate returns memory from the guard's arena, otherwise from the heap.
+// Objects can be deallocated in any order and from any thread, but memory of an arena is released only at once,
+// after the guard and all objects allocated from the arena are destroyed.
+class Arena {
+ public:
+  static void *allocate(size_t size);
+  static void deallocate(void *ptr) noexcept;
+
+  class Guard {
+   public:
+    Guard();
+    Guard(const Guard &) = delete;
+    Guard &operator=(const Guard &) = delete;
+    Guard(Guard &&) = delete;
+    Guard &operator=(Guard &&) = delete;
+    ~Guard();
+
+   private:
+    Arena *arena_;
+    Arena *old_arena_;
+  };
+
+  // returns total size of memory owned by all arenas
+  static size_t get_arena_mem();
+
+ private:
+  static constexpr int64 GUARD_REF_CNT = static_cast<int64>(1) << 62;
+  static constexpr size_t MIN_CHUNK_SIZE = 1 << 14;
+  static constexpr size_t MAX_CHUNK_SIZE = 1 << 18;
+
+  // the guard holds GUARD_REF_CNT references; allocations made during its lifetime are counted in
+  // allocation_count_ and are transferred to ref_cnt_ only when the guard is destroyed
+  std::atomic<int64> ref_cnt_{GUARD_REF_CNT};
+  int64 allocation_count_ = 0;
+  char *chunk_ = nullptr;  // list of owned chunks, linked through their first bytes
+  char *begin_ = nullptr;
+  char *end_ = nullptr;
+  size_t next_chunk_size_ = MIN_CHUNK_SIZE;
+  size_t mem_ = 0;
+
+  static std::atomic<size_t> arena_mem_;
+
+  Arena() = default;
+  Arena(const Arena &) = delete;
+  Arena &operator=(const Arena &) = delete;
+  Arena(Arena &&) = delete;
+  Arena &operator=(Arena &&) = delete;
+  ~Arena();
+
+  void *do_allocate(size_t size);
+  void dec_ref_cnt(int64 count);
+};
+
+}  // namespace td
@@ -106,9 +106,11 @@ Result<size_t> BufferedFdBase<FdT>::flush_write() {
   // TODO: sync on demand
   write_->sync_with_writer();
   while (!write_->empty() && ::td::can_write(*this)) {
-    Slice slice = write_->prepare_read();
-    TRY_RESULT(x, FdT::write(slice));
-    write_->confirm_read(x);
+    // the whole chain of buffers is written with one system call
+    Slice slices[Fd::MAX_IO_SLICES];
+    auto slice_count = write_->prepare_readv(slices, Fd::MAX_IO_SLICES);
+    TRY_RESULT(x, slice_count == 1 ? FdT::write(slices[0]) : FdT::writev(slices, slice_count));
+    write_->advance(x);
     result += x;
   }
   return result;
@@ -0,0 +1,33 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2018
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/FlatHashTable.h"
+
+#include <functional>
+
+namespace td {
+
+// std::unordered_map replacement for small keys; KeyT() can't be used as a key
+template <class KeyT, class ValueT, class HashT = std::hash<KeyT>, class EqT = std::equal_to<KeyT>>
+class FlatHashMap : public FlatHashTable<MapNode<KeyT, ValueT>, HashT, EqT> {
+ public:
+  ValueT &operator[](const KeyT &key) {
+    return this->emplace(key).first->second;
+  }
+};
+
+// FlatHashMap, which never moves values, so they can be referenced by pointers
+template <class KeyT, class ValueT, class HashT = std::hash<KeyT>, class EqT = std::equal_to<KeyT>>
+class FlatHashMapNodeStable : public FlatHashTable<MapNodePtr<KeyT, ValueT>, HashT, EqT> {
+ public:
+  ValueT &operator[](const KeyT &key) {
+    return this->emplace(key).first->second;
+  }
+};
+
+}  // namespace td
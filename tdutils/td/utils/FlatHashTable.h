@@ -0,0 +1,370 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2018
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/common.h"
+#include "td/utils/logging.h"
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+namespace td {
+
+// keys equal to KeyT() are used to mark empty buckets and can't be stored in flat hash tables
+template <class KeyT>
+bool is_hash_table_key_empty(const KeyT &key) {
+  return key == KeyT();
+}
+
+// mixes bits of a possibly weak hash, like the identity hash of integers, which is required for power-of-two tables
+inline uint32 randomize_hash(size_t h) {
+  auto result = static_cast<uint32>(static_cast<uint64>(h) ^ (static_cast<uint64>(h) >> 32));
+  result ^= result >> 16;
+  result *= 0x85ebca6b;
+  result ^= result >> 13;
+  result *= 0xc2b2ae35;
+  result ^= result >> 16;
+  return result;
+}
+
+template <class KeyT, class ValueT>
+struct MapNode {
+  using public_key_type = KeyT;
+  using public_type = MapNode<KeyT, ValueT>;
+
+  KeyT first{};
+  ValueT second{};
+
+  MapNode() = default;
+
+  const KeyT &key() const {
+    return first;
+  }
+  public_type &get_public() {
+    return *this;
+  }
+  const public_type &get_public() const {
+    return *this;
+  }
+
+  bool empty() const {
+    return is_hash_table_key_empty(first);
+  }
+  template <class... ArgsT>
+  void emplace(KeyT key, ArgsT &&... args) {
+    first = std::move(key);
+    second = ValueT(std::forward<ArgsT>(args)...);
+  }
+  void clear() {
+    first = KeyT();
+    second = ValueT();
+  }
+};
+
+// node, which is allocated separately, so pointers to its value aren't invalidated by rehashing
+template <class KeyT, class ValueT>
+struct MapNodePtr {
+  using public_key_type = KeyT;
+  using public_type = MapNode<KeyT, ValueT>;
+
+  std::unique_ptr<public_type> node;
+
+  const KeyT &key() const {
+    return node->first;
+  }
+  public_type &get_public() {
+    return *node;
+  }
+  const public_type &get_public() const {
+    return *node;
+  }
+
+  bool empty() const {
+    return node == nullptr;
+  }
+  template <class... ArgsT>
+  void emplace(KeyT key, ArgsT &&... args) {
+    node = std::make_unique<public_type>();
+    node->first = std::move(key);
+    node->second = ValueT(std::forward<ArgsT>(args)...);
+  }
+  void clear() {
+    node = nullptr;
+  }
+};
+
+template <class KeyT>
+struct SetNode {
+  using public_key_type = KeyT;
+  using public_type = const KeyT;
+
+  KeyT first{};
+
+  const KeyT &key() const {
+    return first;
+  }
+  public_type &get_public() const {
+    return first;
+  }
+
+  bool empty() const {
+    return is_hash_table_key_empty(first);
+  }
+  void emplace(KeyT key) {
+    first = std::move(key);
+  }
+  void clear() {
+    first = KeyT();
+  }
+};
+
+// Open-addressing hash table with linear probing and backward-shift deletion.
+// All nodes are stored in one array, so lookups don't need pointer chasing unless MapNodePtr is used.
+// Any insertion can invalidate iterators and, for MapNode and SetNode, references to the stored objects.
+template <class NodeT, class HashT, class EqT>
+class FlatHashTable {
+ public:
+  using KeyT = typename NodeT::public_key_type;
+  using key_type = KeyT;
+  using value_type = typename NodeT::public_type;
+
+  template <class TableT, class ReferenceT>
+  class IteratorBase {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+    using value_type = typename FlatHashTable::value_type;
+    using pointer = ReferenceT *;
+    using reference = ReferenceT &;
+
+    IteratorBase() = default;
+    IteratorBase(TableT *table, uint32 bucket) : table_(table), bucket_(bucket) {
+    }
+    template <class OtherTableT, class OtherReferenceT>
+    IteratorBase(const IteratorBase<OtherTableT, OtherReferenceT> &other)  // iterator to const_iterator
+        : table_(other.table_), bucket_(other.bucket_) {
+    }
+
+    reference operator*() const {
+      return table_->nodes_[bucket_].get_public();
+    }
+    pointer operator->() const {
+      return &**this;
+    }
+    IteratorBase &operator++() {
+      bucket_ = table_->next_used_bucket(bucket_ + 1);
+      return *this;
+    }
+    IteratorBase operator++(int) {
+      auto result = *this;
+      ++*this;
+      return result;
+    }
+
+    bool operator==(const IteratorBase &other) const {
+      return bucket_ == other.bucket_;
+    }
+    bool operator!=(const IteratorBase &other) const {
+      return bucket_ != other.bucket_;
+    }
+
+   private:
+    template <class OtherTableT, class OtherReferenceT>
+    friend class IteratorBase;
+    friend class FlatHashTable;
+
+    TableT *table_ = nullptr;
+    uint32 bucket_ = 0;
+  };
+  using iterator = IteratorBase<FlatHashTable, value_type>;
+  using const_iterator = IteratorBase<const FlatHashTable, const value_type>;
+
+  FlatHashTable() = default;
+  FlatHashTable(const FlatHashTable &) = delete;
+  FlatHashTable &operator=(const FlatHashTable &) = delete;
+  FlatHashTable(FlatHashTable &&other) noexcept
+      : nodes_(std::move(other.nodes_)), used_node_count_(other.used_node_count_) {
+    other.used_node_count_ = 0;
+  }
+  FlatHashTable &operator=(FlatHashTable &&other) noexcept {
+    nodes_ = std::move(other.nodes_);
+    used_node_count_ = other.used_node_count_;
+    other.used_node_count_ = 0;
+    return *this;
+  }
+  ~FlatHashTable() = default;
+
+  size_t size() const {
+    return used_node_count_;
+  }
+  bool empty() const {
+    return used_node_count_ == 0;
+  }
+  size_t bucket_count() const {
+    return nodes_.size();
+  }
+
+  iterator begin() {
+    return iterator(this, next_used_bucket(0));
+  }
+  iterator end() {
+    return iterator(this, get_bucket_count());
+  }
+  const_iterator begin() const {
+    return const_iterator(this, next_used_bucket(0));
+  }
+  const_iterator end() const {
+    return const_iterator(this, get_bucket_count());
+  }
+
+  iterator find(const KeyT &key) {
+    return iterator(this, find_bucket(key));
+  }
+  const_iterator find(const KeyT &key) const {
+    return const_iterator(this, find_bucket(key));
+  }
+  size_t count(const KeyT &key) const {
+    return find_bucket(key) != get_bucket_count() ? 1 : 0;
+  }
+
+  template <class... ArgsT>
+  std::pair<iterator, bool> emplace(KeyT key, ArgsT &&... args) {
+    CHECK(!is_hash_table_key_empty(key));
+    auto bucket = find_bucket(key);
+    if (bucket != get_bucket_count()) {
+      return {iterator(this, bucket), false};
+    }
+    if ((used_node_count_ + 1) * 5 > get_bucket_count() * 3) {
+      resize(get_bucket_count() == 0 ? MIN_BUCKET_COUNT : get_bucket_count() * 2);
+    }
+    bucket = get_start_bucket(key);
+    while (!nodes_[bucket].empty()) {
+      bucket = (bucket + 1) & get_bucket_mask();
+    }
+    nodes_[bucket].emplace(std::move(key), std::forward<ArgsT>(args)...);
+    used_node_count_++;
+    return {iterator(this, bucket), true};
+  }
+
+  std::pair<iterator, bool> insert(KeyT key) {
+    return emplace(std::move(key));
+  }
+
+  size_t erase(const KeyT &key) {
+    auto bucket = find_bucket(key);
+    if (bucket == get_bucket_count()) {
+      return 0;
+    }
+    erase_bucket(bucket);
+    return 1;
+  }
+  // unlike std::unordered_map::erase, doesn't return iterator to the next element, because elements can be moved
+  void erase(const_iterator it) {
+    CHECK(it.table_ == this);
+    erase_bucket(it.bucket_);
+  }
+
+  void clear() {
+    nodes_ = vector<NodeT>();
+    used_node_count_ = 0;
+  }
+
+  void reserve(size_t size) {
+    size_t bucket_count = MIN_BUCKET_COUNT;
+    while (size * 5 > bucket_count * 3) {
+      bucket_count *= 2;
+    }
+    if (bucket_count > get_bucket_count()) {
+      resize(bucket_count);
+    }
+  }
+
+ private:
+  static constexpr uint32 MIN_BUCKET_COUNT = 8;
+
+  vector<NodeT> nodes_;
+  size_t used_node_count_ = 0;
+
+  uint32 get_bucket_count() const {
+    return static_cast<uint32>(nodes_.size());
+  }
+  uint32 get_bucket_mask() const {
+    return get_bucket_count() - 1;
+  }
+  uint32 get_start_bucket(const KeyT &key) const {
+    return randomize_hash(HashT()(key)) & get_bucket_mask();
+  }
+
+  uint32 next_used_bucket(uint32 bucket) const {
+    while (bucket < get_bucket_count() && nodes_[bucket].empty()) {
+      bucket++;
+    }
+    return bucket;
+  }
+
+  // returns get_bucket_count() if the key isn't found
+  uint32 find_bucket(const KeyT &key) const {
+    if (used_node_count_ == 0 || is_hash_table_key_empty(key)) {
+      return get_bucket_count();
+    }
+    auto bucket = get_start_bucket(key);
+    while (true) {
+      auto &node = nodes_[bucket];
+      if (node.empty()) {
+        return get_bucket_count();
+      }
+      if (EqT()(node.key(), key)) {
+        return bucket;
+      }
+      bucket = (bucket + 1) & get_bucket_mask();
+    }
+  }
+
+  void erase_bucket(uint32 bucket) {
+    nodes_[bucket].clear();
+    used_node_count_--;
+
+    // move back nodes, which can't be found after the bucket became empty
+    auto empty_bucket = bucket;
+    auto mask = get_bucket_mask();
+    for (auto test_bucket = (bucket + 1) & mask;; test_bucket = (test_bucket + 1) & mask) {
+      auto &node = nodes_[test_bucket];
+      if (node.empty()) {
+        break;
+      }
+      auto start_bucket = get_start_bucket(node.key());
+      if (((test_bucket - start_bucket) & mask) >= ((test_bucket - empty_bucket) & mask)) {
+        nodes_[empty_bucket] = std::move(node);
+        node.clear();
+        empty_bucket = test_bucket;
+      }
+    }
+  }
+
+  void resize(uint32 new_bucket_count) {
+    auto old_nodes = std::move(nodes_);
+    nodes_ = vector<NodeT>(new_bucket_count);
+    for (auto &old_node : old_nodes) {
+      if (old_node.empty()) {
+        continue;
+      }
+      auto bucket = get_start_bucket(old_node.key());
+      while (!nodes_[bucket].empty()) {
+        bucket = (bucket + 1) & get_bucket_mask();
+      }
+      nodes_[bucket] = std::move(old_node);
+    }
+  }
+};
+
+template <class NodeT, class HashT, class EqT>
+constexpr uint32 FlatHashTable<NodeT, HashT, EqT>::MIN_BUCKET_COUNT;
+
+}  // namespace td
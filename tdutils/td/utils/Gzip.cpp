@@ -10,7 +10,9 @@ char disable_linker_warning_about_empty_file_gzip_cpp TD_UNUSED;
 
 #if TD_HAVE_ZLIB
 #include "td/utils/logging.h"
+#include "td/utils/port/thread_local.h"
 
+#include <algorithm>
 #include <cstring>
 #include <limits>
 
@@ -22,23 +24,51 @@ class Gzip::Impl {
  public:
   z_stream stream_;
 
+  // the mode for which stream_ is allocated; the stream is reset instead of reallocation when possible,
+  // because deflate allocates and initializes hundreds of kilobytes of memory
+  Mode stream_mode_ = Empty;
+
   // z_stream is not copyable nor movable
   Impl() = default;
   Impl(const Impl &other) = delete;
   Impl &operator=(const Impl &other) = delete;
   Impl(Impl &&other) = delete;
   Impl &operator=(Impl &&other) = delete;
-  ~Impl() = default;
+  ~Impl() {
+    free_stream();
+  }
+
+  void free_stream() {
+    if (stream_mode_ == Decode) {
+      inflateEnd(&stream_);
+    } else if (stream_mode_ == Encode) {
+      deflateEnd(&stream_);
+    }
+    stream_mode_ = Empty;
+    std::memset(&stream_, 0, sizeof(stream_));
+    stream_.zalloc = Z_NULL;
+    stream_.zfree = Z_NULL;
+    stream_.opaque = Z_NULL;
+  }
 };
 
 Status Gzip::init_encode() {
   CHECK(mode_ == Empty);
   init_common();
   mode_ = Encode;
-  int ret = deflateInit2(&impl_->stream_, 6, Z_DEFLATED, 15, MAX_MEM_LEVEL, Z_DEFAULT_STRATEGY);
+  int ret;
+  if (impl_->stream_mode_ == Encode) {
+    ret = deflateReset(&impl_->stream_);
+  } else {
+    impl_->free_stream();
+    ret = deflateInit2(&impl_->stream_, 6, Z_DEFLATED, 15, MAX_MEM_LEVEL, Z_DEFAULT_STRATEGY);
+  }
   if (ret != Z_OK) {
+    impl_->free_stream();
+    mode_ = Empty;
     return Status::Error("zlib deflate init failed");
   }
+  impl_->stream_mode_ = Encode;
   return Status::OK();
 }
 
@@ -46,10 +76,19 @@ Status Gzip::init_decode() {
   CHECK(mode_ == Empty);
   init_common();
   mode_ = Decode;
-  int ret = inflateInit2(&impl_->stream_, MAX_WBITS + 32);
+  int ret;
+  if (impl_->stream_mode_ == Decode) {
+    ret = inflateReset(&impl_->stream_);
+  } else {
+    impl_->free_stream();
+    ret = inflateInit2(&impl_->stream_, MAX_WBITS + 32);
+  }
   if (ret != Z_OK) {
+    impl_->free_stream();
+    mode_ = Empty;
     return Status::Error("zlib inflate init failed");
   }
+  impl_->stream_mode_ = Decode;
   return Status::OK();
 }
 
@@ -102,10 +141,6 @@ size_t Gzip::left_output() const {
 }
 
 void Gzip::init_common() {
-  std::memset(&impl_->stream_, 0, sizeof(impl_->stream_));
-  impl_->stream_.zalloc = Z_NULL;
-  impl_->stream_.zfree = Z_NULL;
-  impl_->stream_.opaque = Z_NULL;
   impl_->stream_.avail_in = 0;
   impl_->stream_.next_in = nullptr;
   impl_->stream_.avail_out = 0;
@@ -118,33 +153,74 @@ void Gzip::init_common() {
 }
 
 void Gzip::clear() {
-  if (mode_ == Decode) {
-    inflateEnd(&impl_->stream_);
-  } else if (mode_ == Encode) {
-    deflateEnd(&impl_->stream_);
-  }
+  // the stream itself is kept to be reused by the next init
   mode_ = Empty;
 }
 
 Gzip::Gzip() : impl_(make_unique<Impl>()) {
 }
 
-Gzip::Gzip(Gzip &&other) = default;
+Gzip::Gzip(Gzip &&other)
+    : impl_(std::move(other.impl_))
+    , input_size_(other.input_size_)
+    , output_size_(other.output_size_)
+    , close_input_flag_(other.close_input_flag_)
+    , mode_(other.mode_) {
+  other.mode_ = Empty;
+}
 
-Gzip &Gzip::operator=(Gzip &&other) = default;
+Gzip &Gzip::operator=(Gzip &&other) {
+  impl_ = std::move(other.impl_);
+  input_size_ = other.input_size_;
+  output_size_ = other.output_size_;
+  close_input_flag_ = other.close_input_flag_;
+  mode_ = other.mode_;
+  other.mode_ = Empty;
+  return *this;
+}
 
-Gzip::~Gzip() {
-  clear();
+Gzip::~Gzip() = default;
+
+// contexts are reused between calls, so only the first call in a thread pays for zlib state allocation
+static Gzip &get_thread_gzip(Gzip::Mode mode) {
+  static TD_THREAD_LOCAL Gzip *decoder;
+  static TD_THREAD_LOCAL Gzip *encoder;
+  auto &gzip = mode == Gzip::Decode ? decoder : encoder;
+  init_thread_local<Gzip>(gzip);
+  gzip->init(Gzip::Empty).ensure();  // previous call could have returned before the end of the stream
+  return *gzip;
+}
+
+// returns the uncompressed size stored in the gzip trailer or 0 if it is unknown
+// the size comes from the peer and can be forged, so it must be used only as a hint
+static size_t get_gzip_uncompressed_size(Slice s) {
+  if (s.size() < 18 || s.ubegin()[0] != 0x1f || s.ubegin()[1] != 0x8b) {
+    return 0;
+  }
+  auto p = s.ubegin() + s.size() - 4;
+  return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<size_t>(p[3]) << 24);
 }
 
 BufferSlice gzdecode(Slice s) {
-  Gzip gzip;
-  gzip.init_decode().ensure();
+  auto &gzip = get_thread_gzip(Gzip::Decode);
+  if (gzip.init_decode().is_error()) {
+    return BufferSlice();
+  }
   auto message = ChainBufferWriter::create_empty();
   gzip.set_input(s);
   gzip.close_input();
   double k = 2;
-  gzip.set_output(message.prepare_append(static_cast<size_t>(static_cast<double>(s.size()) * k)));
+  // when the size is known, the result is decompressed into one buffer and needs no concatenation
+  // the rest of the output, if any, is allocated only as it is really produced
+  constexpr size_t MAX_OUTPUT_SIZE_RATIO = 32;
+  constexpr size_t MAX_OUTPUT_SIZE_HINT = 1 << 24;
+  auto output_size = get_gzip_uncompressed_size(s);
+  if (output_size == 0) {
+    output_size = static_cast<size_t>(static_cast<double>(s.size()) * k);
+  } else {
+    output_size = std::min(output_size, std::min(s.size() * MAX_OUTPUT_SIZE_RATIO, MAX_OUTPUT_SIZE_HINT));
+  }
+  gzip.set_output(message.prepare_append(output_size));
   while (true) {
     auto r_state = gzip.run();
     if (r_state.is_error()) {
@@ -168,8 +244,10 @@ BufferSlice gzdecode(Slice s) {
 }
 
 BufferSlice gzencode(Slice s, double k) {
-  Gzip gzip;
-  gzip.init_encode().ensure();
+  auto &gzip = get_thread_gzip(Gzip::Encode);
+  if (gzip.init_encode().is_error()) {
+    return BufferSlice();
+  }
   gzip.set_input(s);
   gzip.close_input();
   size_t max_size = static_cast<size_t>(static_cast<double>(s.size()) * k);
@@ -7,70 +7,416 @@
 #pragma once
 
 #include "td/utils/common.h"
+#include "td/utils/logging.h"
+#include "td/utils/misc.h"
 #include "td/utils/Slice.h"
 
+#include <algorithm>
+#include <cstring>
+#include <limits>
 #include <map>
 #include <unordered_map>
 #include <utility>
 
 namespace td {
 
-// TODO template KeyT
-class Hints {
-  using KeyT = int64;
+namespace detail {
+// returns sorted normalized words of the name, which aren't prefixes of other words
+vector<string> get_hints_words(Slice name);
+
+// checks whether some of space-separated words begins with the prefix
+bool has_hints_word_with_prefix(Slice words, Slice prefix);
+}  // namespace detail
+
+// Prefix search index over names of keys; not thread-safe
+//
+// Each word of each name is stored as a reference into the name in a sorted array, so all words beginning with
+// a prefix form a contiguous range. For every pair of adjacent sorted words of a name their longest common prefix is
+// stored in another sorted array, which allows to count keys having some word beginning with a prefix exactly
+// in O(log n) as (number of words with the prefix) - (number of common prefixes beginning with the prefix).
+// Keys with non-empty names are additionally kept ordered by rating, so the best results for non-selective
+// one-word queries are found by walking keys in rating order until enough of them match.
+//
+// Changed names aren't merged into the sorted arrays immediately. Until the next rebuild of the index, new names
+// are checked one by one, and references to old names stay in the arrays and are compensated during search.
+template <class KeyT>
+class HintsImpl {
   using RatingT = int64;
 
  public:
-  void add(KeyT key, Slice name);
+  void add(KeyT key, Slice name) {
+    // LOG(ERROR) << "Add " << key << ": " << name;
+    auto it = key_to_id_.find(key);
+    if (it == key_to_id_.end()) {
+      if (name.empty()) {
+        return;
+      }
+      it = key_to_id_.emplace(key, create_key_id(key)).first;
+    }
+    auto key_id = it->second;
+    auto &info = key_infos_[key_id];
+    if (!info.name.empty()) {
+      if (info.name == name) {
+        return;
+      }
+      ordered_keys_.erase(std::make_pair(info.rating, key));
+      invalidate_words(key_id);
+    }
+    if (name.empty()) {
+      // the rating is forgotten together with the name
+      info.name.clear();
+      free_key_ids_.push_back(key_id);
+      key_to_id_.erase(it);
+      return;
+    }
+
+    info.name = name.str();
+    info.words = implode(detail::get_hints_words(name), ' ');
+    pending_keys_.emplace_back(key_id, info.generation);
+    ordered_keys_.emplace(std::make_pair(info.rating, key), key_id);
+
+    if (pending_keys_.size() + stale_words_.size() > indexed_key_count_ + MAX_UNINDEXED_KEY_COUNT) {
+      update_index();
+    }
+  }
 
   void remove(KeyT key) {
     add(key, "");
   }
 
-  void set_rating(KeyT key, RatingT rating);
+  void set_rating(KeyT key, RatingT rating) {
+    // LOG(ERROR) << "Set rating " << key << ": " << rating;
+    auto it = key_to_id_.find(key);
+    if (it == key_to_id_.end()) {
+      it = key_to_id_.emplace(key, create_key_id(key)).first;
+    }
+    auto key_id = it->second;
+    auto &info = key_infos_[key_id];
+    if (info.rating == rating) {
+      return;
+    }
+    if (!info.name.empty()) {
+      ordered_keys_.erase(std::make_pair(info.rating, key));
+      ordered_keys_.emplace(std::make_pair(rating, key), key_id);
+    }
+    info.rating = rating;
+  }
 
   std::pair<size_t, vector<KeyT>> search(
       Slice query, int32 limit,
-      bool return_all_for_empty_query = false) const;  // TODO sort by name instead of sort by rating
+      bool return_all_for_empty_query = false) const {  // TODO sort by name instead of sort by rating
+    // LOG(ERROR) << "Search " << query;
+    vector<KeyT> results;
+
+    if (limit < 0) {
+      return {size(), std::move(results)};
+    }
+
+    auto words = detail::get_hints_words(query);
+    if (words.empty()) {
+      if (!return_all_for_empty_query) {
+        return {0, std::move(results)};
+      }
+      for (auto &it : ordered_keys_) {
+        if (results.size() == static_cast<size_t>(limit)) {
+          break;
+        }
+        results.push_back(it.first.second);
+      }
+      return {size(), std::move(results)};
+    }
+
+    if ((pending_keys_.size() + stale_words_.size()) * MIN_INDEXED_KEYS_PER_UNINDEXED_KEY > indexed_key_count_) {
+      update_index();
+    }
+
+    // find the most selective word
+    size_t best_word = 0;
+    size_t best_count = 0;
+    std::pair<size_t, size_t> best_range;
+    for (size_t i = 0; i < words.size(); i++) {
+      auto range = get_prefix_range(words_, words[i]);
+      auto common_prefix_range = get_prefix_range(common_prefixes_, words[i]);
+      auto count = (range.second - range.first) - (common_prefix_range.second - common_prefix_range.first);
+      if (i == 0 || count < best_count) {
+        best_word = i;
+        best_count = count;
+        best_range = range;
+      }
+    }
+
+    if (words.size() == 1) {
+      for (auto &it : stale_words_) {
+        if (detail::has_hints_word_with_prefix(it.second, words[0])) {
+          best_count--;
+        }
+      }
+      for (auto &pending_key : pending_keys_) {
+        if (is_pending(pending_key) &&
+            detail::has_hints_word_with_prefix(key_infos_[pending_key.first].words, words[0])) {
+          best_count++;
+        }
+      }
+
+      if (static_cast<uint64>(limit) * size() < static_cast<uint64>(best_count) * best_count) {
+        // many keys match, so the best of them are found quickly in rating order
+        for (auto &it : ordered_keys_) {
+          if (results.size() == static_cast<size_t>(limit)) {
+            break;
+          }
+          if (detail::has_hints_word_with_prefix(key_infos_[it.second].words, words[0])) {
+            results.push_back(it.first.second);
+          }
+        }
+        return {best_count, std::move(results)};
+      }
+    }
+
+    if (++current_stamp_ == 0) {
+      std::fill(key_stamps_.begin(), key_stamps_.end(), 0);
+      current_stamp_ = 1;
+    }
+    key_stamps_.resize(key_infos_.size());
+    vector<uint32> key_ids;
+    key_ids.reserve(best_count);
+    auto add_key_id = [&](uint32 key_id, size_t skipped_word) {
+      if (key_stamps_[key_id] == current_stamp_) {
+        return;
+      }
+      key_stamps_[key_id] = current_stamp_;
+
+      for (size_t i = 0; i < words.size(); i++) {
+        if (i != skipped_word && !detail::has_hints_word_with_prefix(key_infos_[key_id].words, words[i])) {
+          return;
+        }
+      }
+      key_ids.push_back(key_id);
+    };
+    for (size_t pos = best_range.first; pos < best_range.second; pos++) {
+      if (!is_stale(words_[pos])) {
+        add_key_id(words_[pos].key_id, best_word);
+      }
+    }
+    for (auto &pending_key : pending_keys_) {
+      if (is_pending(pending_key)) {
+        add_key_id(pending_key.first, words.size());
+      }
+    }
+
+    auto total_size = key_ids.size();
+    CompareByRating compare(key_infos_);
+    if (total_size <= static_cast<size_t>(limit)) {
+      std::sort(key_ids.begin(), key_ids.end(), compare);
+    } else {
+      std::partial_sort(key_ids.begin(), key_ids.begin() + limit, key_ids.end(), compare);
+      key_ids.resize(limit);
+    }
+
+    results.reserve(key_ids.size());
+    for (auto key_id : key_ids) {
+      results.push_back(key_infos_[key_id].key);
+    }
+    return {total_size, std::move(results)};
+  }
 
-  bool has_key(KeyT key) const;
+  bool has_key(KeyT key) const {
+    auto it = key_to_id_.find(key);
+    return it != key_to_id_.end() && !key_infos_[it->second].name.empty();
+  }
 
-  string key_to_string(KeyT key) const;
+  string key_to_string(KeyT key) const {
+    auto it = key_to_id_.find(key);
+    if (it == key_to_id_.end()) {
+      return string();
+    }
+    return key_infos_[it->second].name;
+  }
 
-  std::pair<size_t, vector<KeyT>> search_empty(int32 limit) const;  // == search("", limit, true)
+  std::pair<size_t, vector<KeyT>> search_empty(int32 limit) const {  // == search("", limit, true)
+    return search(Slice(), limit, true);
+  }
 
-  size_t size() const;
+  size_t size() const {
+    return ordered_keys_.size();
+  }
 
  private:
-  std::map<string, vector<KeyT>> word_to_keys_;
-  std::unordered_map<KeyT, string> key_to_name_;
-  std::unordered_map<KeyT, RatingT> key_to_rating_;
+  static constexpr size_t MAX_UNINDEXED_KEY_COUNT = 4096;
+  static constexpr size_t MIN_INDEXED_KEYS_PER_UNINDEXED_KEY = 256;
+
+  struct KeyInfo {
+    KeyT key;
+    RatingT rating = 0;
+    uint32 generation = 0;
+    mutable bool is_indexed = false;  // whether the words are referenced from the sorted arrays
+    string name;
+    string words;  // normalized words of the name, separated by spaces
+  };
 
-  static vector<string> get_words(Slice name);
+  // reference to a part of words of the key with the given generation
+  struct WordRef {
+    uint32 key_id;
+    uint32 generation;
+    uint32 offset;
+    uint32 length;
+  };
 
-  vector<KeyT> search_word(const string &word) const;
+  std::unordered_map<KeyT, uint32> key_to_id_;
+  vector<KeyInfo> key_infos_;
+  vector<uint32> free_key_ids_;
+  std::map<std::pair<RatingT, KeyT>, uint32> ordered_keys_;  // keys with non-empty names
 
-  class CompareByRating {
-    const std::unordered_map<KeyT, RatingT> &key_to_rating_;
+  mutable vector<WordRef> words_;
+  mutable vector<WordRef> common_prefixes_;
+  mutable size_t indexed_key_count_ = 0;
+
+  // changes since the last rebuild of the index
+  mutable vector<std::pair<uint32, uint32>> pending_keys_;          // key_id, generation of not indexed words
+  mutable std::unordered_map<uint64, string> stale_words_;  // key_id and generation -> indexed words
+
+  mutable vector<uint32> key_stamps_;
+  mutable uint32 current_stamp_ = 0;
+
+  uint32 create_key_id(KeyT key) {
+    uint32 key_id;
+    if (free_key_ids_.empty()) {
+      CHECK(key_infos_.size() < std::numeric_limits<uint32>::max());
+      key_id = narrow_cast<uint32>(key_infos_.size());
+      key_infos_.emplace_back();
+    } else {
+      key_id = free_key_ids_.back();
+      free_key_ids_.pop_back();
+    }
+    auto &info = key_infos_[key_id];
+    info.key = key;
+    info.rating = RatingT();
+    return key_id;
+  }
+
+  static uint64 get_stale_words_key(uint32 key_id, uint32 generation) {
+    return (static_cast<uint64>(key_id) << 32) | generation;
+  }
+
+  void invalidate_words(uint32 key_id) {
+    auto &info = key_infos_[key_id];
+    if (info.is_indexed) {
+      stale_words_.emplace(get_stale_words_key(key_id, info.generation), std::move(info.words));
+      info.is_indexed = false;
+    }
+    info.words.clear();
+    info.generation++;
+  }
+
+  bool is_stale(const WordRef &word) const {
+    return key_infos_[word.key_id].generation != word.generation;
+  }
 
-    RatingT get_rating(const KeyT &key) const {
-      auto it = key_to_rating_.find(key);
-      if (it == key_to_rating_.end()) {
-        return RatingT();
+  bool is_pending(const std::pair<uint32, uint32> &pending_key) const {
+    auto &info = key_infos_[pending_key.first];
+    return info.generation == pending_key.second && !info.is_indexed;
+  }
+
+  Slice get_word(const WordRef &word) const {
+    auto &info = key_infos_[word.key_id];
+    if (info.generation == word.generation) {
+      return Slice(info.words).substr(word.offset, word.length);
+    }
+    auto it = stale_words_.find(get_stale_words_key(word.key_id, word.generation));
+    CHECK(it != stale_words_.end());
+    return Slice(it->second).substr(word.offset, word.length);
+  }
+
+  static bool less(Slice lhs, Slice rhs) {
+    auto result = std::memcmp(lhs.data(), rhs.data(), std::min(lhs.size(), rhs.size()));
+    return result < 0 || (result == 0 && lhs.size() < rhs.size());
+  }
+
+  std::pair<size_t, size_t> get_prefix_range(const vector<WordRef> &words, Slice prefix) const {
+    auto begin = std::lower_bound(words.begin(), words.end(), prefix,
+                                  [&](const WordRef &word, Slice value) { return less(get_word(word), value); });
+    auto end = std::partition_point(begin, words.end(),
+                                    [&](const WordRef &word) { return begins_with(get_word(word), prefix); });
+    return {static_cast<size_t>(begin - words.begin()), static_cast<size_t>(end - words.begin())};
+  }
+
+  void merge_words(vector<WordRef> &words, vector<WordRef> &new_words) const {
+    if (!stale_words_.empty()) {
+      words.erase(std::remove_if(words.begin(), words.end(), [&](const WordRef &word) { return is_stale(word); }),
+                  words.end());
+    }
+    if (new_words.empty()) {
+      return;
+    }
+
+    auto compare = [&](const WordRef &lhs, const WordRef &rhs) { return less(get_word(lhs), get_word(rhs)); };
+    std::sort(new_words.begin(), new_words.end(), compare);
+    if (words.empty()) {
+      std::swap(words, new_words);
+      return;
+    }
+    auto old_size = words.size();
+    words.insert(words.end(), new_words.begin(), new_words.end());
+    std::inplace_merge(words.begin(), words.begin() + old_size, words.end(), compare);
+  }
+
+  void update_index() const {
+    vector<WordRef> new_words;
+    vector<WordRef> new_common_prefixes;
+    for (auto &pending_key : pending_keys_) {
+      if (!is_pending(pending_key)) {
+        continue;
+      }
+      auto key_id = pending_key.first;
+      auto &info = key_infos_[key_id];
+      info.is_indexed = true;
+
+      size_t prev_offset = 0;
+      size_t offset = 0;
+      while (offset < info.words.size()) {
+        auto length = info.words.find(' ', offset);
+        if (length == string::npos) {
+          length = info.words.size();
+        }
+        length -= offset;
+        new_words.push_back(WordRef{key_id, info.generation, narrow_cast<uint32>(offset), narrow_cast<uint32>(length)});
+
+        if (offset != 0) {
+          size_t common_prefix = 0;
+          while (info.words[prev_offset + common_prefix] == info.words[offset + common_prefix]) {
+            common_prefix++;
+          }
+          if (common_prefix != 0) {
+            new_common_prefixes.push_back(WordRef{key_id, info.generation, narrow_cast<uint32>(prev_offset),
+                                                  narrow_cast<uint32>(common_prefix)});
+          }
+        }
+        prev_offset = offset;
+        offset += length + 1;
       }
-      return it->second;
     }
 
+    merge_words(words_, new_words);
+    merge_words(common_prefixes_, new_common_prefixes);
+    pending_keys_.clear();
+    stale_words_.clear();
+    indexed_key_count_ = size();
+  }
+
+  class CompareByRating {
+    const vector<KeyInfo> &key_infos_;
+
    public:
-    explicit CompareByRating(const std::unordered_map<KeyT, RatingT> &key_to_rating) : key_to_rating_(key_to_rating) {
+    explicit CompareByRating(const vector<KeyInfo> &key_infos) : key_infos_(key_infos) {
     }
 
-    bool operator()(const KeyT &lhs, const KeyT &rhs) const {
-      auto lhs_rating = get_rating(lhs);
-      auto rhs_rating = get_rating(rhs);
-      return lhs_rating < rhs_rating || (lhs_rating == rhs_rating && lhs < rhs);
+    bool operator()(uint32 lhs, uint32 rhs) const {
+      auto &lhs_info = key_infos_[lhs];
+      auto &rhs_info = key_infos_[rhs];
+      return lhs_info.rating < rhs_info.rating || (lhs_info.rating == rhs_info.rating && lhs_info.key < rhs_info.key);
     }
   };
 };
 
+using Hints = HintsImpl<int64>;
+
 }  // namespace td
@@ -127,26 +127,50 @@ StringBuilder &operator<<(StringBuilder &sb, const JsonString &val) {
           UNREACHABLE();
           break;
         }
-        sb << s[pos];
+        {
+          // the following printable ASCII characters are appended at once
+          auto plain_end = pos + 1;
+          while (plain_end < len && static_cast<unsigned char>(s[plain_end]) - 32u < 96u && s[plain_end] != '"' &&
+                 s[plain_end] != '\\') {
+            plain_end++;
+          }
+          sb << Slice(s + pos, s + plain_end);
+          pos = plain_end - 1;
+        }
         break;
     }
   }
   return sb;
 }
+
+// returns position of the closing '"' of a string or nullptr if there is none;
+// the quote closes the string if it is preceded by an even number of backslashes
+static char *json_string_find_end(char *begin, char *end) {
+  auto *cur = begin;
+  while (true) {
+    auto *quote = static_cast<char *>(std::memchr(cur, '"', end - cur));
+    if (quote == nullptr) {
+      return nullptr;
+    }
+    auto *slash = quote;
+    while (slash != begin && slash[-1] == '\\') {
+      slash--;
+    }
+    if (((quote - slash) & 1) == 0) {
+      return quote;
+    }
+    cur = quote + 1;
+  }
+}
+
 Result<MutableSlice> json_string_decode(Parser &parser) {
   if (!parser.try_skip('"')) {
     return Status::Error("Opening '\"' expected");
   }
   auto *cur_src = parser.data().data();
   auto *end_src = parser.data().end();
-  auto *end = cur_src;
-  while (end < end_src && end[0] != '"') {
-    if (end[0] == '\\') {
-      end++;
-    }
-    end++;
-  }
-  if (end >= end_src) {
+  auto *end = json_string_find_end(cur_src, end_src);
+  if (end == nullptr) {
     return Status::Error("Closing '\"' not found");
   }
   parser.advance(end + 1 - cur_src);
@@ -258,14 +282,8 @@ Status json_string_skip(Parser &parser) {
   auto *begin_src = parser.data().data();
   auto *cur_src = begin_src;
   auto *end_src = parser.data().end();
-  auto *end = cur_src;
-  while (end < end_src && *end != '"') {
-    if (*end == '\\') {
-      end++;
-    }
-    end++;
-  }
-  if (end >= end_src) {
+  auto *end = json_string_find_end(cur_src, end_src);
+  if (end == nullptr) {
     return Status::Error("Closing '\"' not found");
   }
   parser.advance(end + 1 - cur_src);
@@ -556,6 +574,303 @@ Status do_json_skip(Parser &parser, int32 max_depth) {
   return Status::Error("Can't parse");
 }
 
+constexpr int32 JsonPullParser::DEFAULT_MAX_DEPTH;
+
+JsonValue::Type JsonPullParser::peek_type() {
+  parser_.skip_whitespaces();
+  return get_value_type(parser_.data());
+}
+
+JsonValue::Type JsonPullParser::get_value_type(Slice value) {
+  if (value.empty()) {
+    return JsonValue::Type::Null;
+  }
+  switch (value[0]) {
+    case 'f':
+    case 't':
+      return JsonValue::Type::Boolean;
+    case '"':
+      return JsonValue::Type::String;
+    case '[':
+      return JsonValue::Type::Array;
+    case '{':
+      return JsonValue::Type::Object;
+    case '-':
+    case '+':
+    case '.':
+    case '0':
+    case '1':
+    case '2':
+    case '3':
+    case '4':
+    case '5':
+    case '6':
+    case '7':
+    case '8':
+    case '9':
+      return JsonValue::Type::Number;
+    default:
+      return JsonValue::Type::Null;
+  }
+}
+
+Status JsonPullParser::read_null() {
+  parser_.skip_whitespaces();
+  if (parser_.skip_start_with("null")) {
+    return Status::OK();
+  }
+  if (get_value_type(parser_.data()) != JsonValue::Type::Null) {
+    return Status::Error("Expected null");
+  }
+  // returns the error describing the unexpected symbol
+  return do_json_skip(parser_, 0);
+}
+
+Result<bool> JsonPullParser::read_boolean() {
+  parser_.skip_whitespaces();
+  if (parser_.skip_start_with("true")) {
+    return true;
+  }
+  if (parser_.skip_start_with("false")) {
+    return false;
+  }
+  return Status::Error("Expected boolean");
+}
+
+Result<MutableSlice> JsonPullParser::read_number() {
+  parser_.skip_whitespaces();
+  if (get_value_type(parser_.data()) != JsonValue::Type::Number) {
+    return Status::Error("Expected number");
+  }
+  return parser_.read_while(
+      [](char c) { return c == '-' || ('0' <= c && c <= '9') || c == 'e' || c == 'E' || c == '+' || c == '.'; });
+}
+
+Result<MutableSlice> JsonPullParser::read_string() {
+  parser_.skip_whitespaces();
+  return json_string_decode(parser_);
+}
+
+Result<JsonValue> JsonPullParser::read_value() {
+  return do_json_decode(parser_, max_depth_ - depth_);
+}
+
+Status JsonPullParser::skip_value() {
+  return do_json_skip(parser_, max_depth_ - depth_);
+}
+
+Status JsonPullParser::enter(char c) {
+  if (max_depth_ - depth_ < 0) {
+    return Status::Error("Too big object depth");
+  }
+  parser_.skip_whitespaces();
+  if (!parser_.try_skip(c)) {
+    return Status::Error(PSLICE() << "'" << c << "' expected");
+  }
+  depth_++;
+  is_first_ = true;
+  return Status::OK();
+}
+
+Result<bool> JsonPullParser::next(char end_c) {
+  parser_.skip_whitespaces();
+  if (parser_.try_skip(end_c)) {
+    depth_--;
+    is_first_ = false;
+    return false;
+  }
+  if (is_first_) {
+    is_first_ = false;
+  } else {
+    if (!parser_.try_skip(',')) {
+      return Status::Error("Unexpected symbol");
+    }
+    parser_.skip_whitespaces();
+  }
+  if (parser_.empty()) {
+    return Status::Error("Unexpected end");
+  }
+  return true;
+}
+
+Status JsonPullParser::enter_object() {
+  return enter('{');
+}
+
+Result<bool> JsonPullParser::next_field(MutableSlice &name) {
+  TRY_RESULT(has_field, next('}'));
+  if (!has_field) {
+    return false;
+  }
+  TRY_RESULT(key, json_string_decode(parser_));
+  parser_.skip_whitespaces();
+  if (!parser_.try_skip(':')) {
+    return Status::Error("':' expected");
+  }
+  name = key;
+  return true;
+}
+
+Status JsonPullParser::enter_array() {
+  return enter('[');
+}
+
+Result<bool> JsonPullParser::next_element() {
+  return next(']');
+}
+
+// skips a field name and the following ':' without changing them; returns whether the name is equal to the given
+static Result<bool> json_skip_field_name(Parser &parser, Slice name) {
+  if (parser.empty()) {
+    return Status::Error("Unexpected end");
+  }
+  auto key_begin = parser.ptr();
+  TRY_STATUS(json_string_skip(parser));
+  Slice key(key_begin + 1, parser.ptr() - 1);
+  bool is_found = key == name;
+  if (!is_found && key.find('\\') != static_cast<size_t>(-1)) {
+    string key_copy(key_begin, parser.ptr());
+    Parser key_parser(key_copy);
+    TRY_RESULT(decoded_key, json_string_decode(key_parser));
+    is_found = decoded_key == name;
+  }
+
+  parser.skip_whitespaces();
+  if (!parser.try_skip(':')) {
+    return Status::Error("':' expected");
+  }
+  parser.skip_whitespaces();
+  return is_found;
+}
+
+static Status json_skip_remembering_types(Parser &parser, int32 max_depth,
+                                          FlatHashMap<const char *, MutableSlice> &object_types);
+
+// skips an object, remembering raw values of the field "@type" of it and of all nested objects;
+// if stop_on_type is true, stops right after the field "@type" of the object
+static Status json_scan_object_types(Parser &parser, int32 max_depth, bool stop_on_type,
+                                     FlatHashMap<const char *, MutableSlice> &object_types) {
+  if (max_depth < 0) {
+    return Status::Error("Too big object depth");
+  }
+  const char *begin = parser.ptr();
+  if (!parser.try_skip('{')) {
+    return Status::Error("'{' expected");
+  }
+  MutableSlice type;
+  parser.skip_whitespaces();
+  if (!parser.try_skip('}')) {
+    while (true) {
+      TRY_RESULT(is_type, json_skip_field_name(parser, "@type"));
+      auto value_begin = parser.ptr();
+      TRY_STATUS(json_skip_remembering_types(parser, max_depth - 1, object_types));
+      if (is_type && type.empty()) {
+        type = MutableSlice(value_begin, parser.ptr());
+        if (stop_on_type) {
+          break;
+        }
+      }
+
+      parser.skip_whitespaces();
+      if (parser.try_skip('}')) {
+        break;
+      }
+      if (!parser.try_skip(',')) {
+        return Status::Error("Unexpected symbol");
+      }
+      parser.skip_whitespaces();
+    }
+  }
+  object_types[begin] = type;
+  return Status::OK();
+}
+
+static Status json_skip_remembering_types(Parser &parser, int32 max_depth,
+                                          FlatHashMap<const char *, MutableSlice> &object_types) {
+  if (max_depth < 0) {
+    return Status::Error("Too big object depth");
+  }
+  parser.skip_whitespaces();
+  switch (parser.peek_char()) {
+    case '{':
+      return json_scan_object_types(parser, max_depth, false, object_types);
+    case '[':
+      parser.skip('[');
+      parser.skip_whitespaces();
+      if (parser.try_skip(']')) {
+        return Status::OK();
+      }
+      while (true) {
+        TRY_STATUS(json_skip_remembering_types(parser, max_depth - 1, object_types));
+        parser.skip_whitespaces();
+        if (parser.try_skip(']')) {
+          return Status::OK();
+        }
+        if (!parser.try_skip(',')) {
+          return Status::Error("Unexpected symbol");
+        }
+      }
+    default:
+      return do_json_skip(parser, max_depth);
+  }
+}
+
+Result<MutableSlice> JsonPullParser::find_object_field(Slice name) {
+  if (max_depth_ - depth_ < 0) {
+    return Status::Error("Too big object depth");
+  }
+  // the object must not be changed, because it will be parsed later, so only skipping is allowed
+  Parser parser(parser_.data());
+  parser.skip_whitespaces();
+  if (!parser.try_skip('{')) {
+    return Status::Error("'{' expected");
+  }
+  parser.skip_whitespaces();
+  if (parser.try_skip('}')) {
+    return MutableSlice();
+  }
+  while (true) {
+    TRY_RESULT(is_found, json_skip_field_name(parser, name));
+    auto value_begin = parser.ptr();
+    TRY_STATUS(do_json_skip(parser, max_depth_ - depth_ - 1));
+    if (is_found) {
+      return MutableSlice(value_begin, parser.ptr());
+    }
+
+    parser.skip_whitespaces();
+    if (parser.try_skip('}')) {
+      return MutableSlice();
+    }
+    if (!parser.try_skip(',')) {
+      return Status::Error("Unexpected symbol");
+    }
+    parser.skip_whitespaces();
+  }
+}
+
+Result<MutableSlice> JsonPullParser::find_object_type() {
+  parser_.skip_whitespaces();
+  const char *begin = parser_.ptr();
+  auto it = object_types_.find(begin);
+  if (it == object_types_.end()) {
+    // the object must not be changed, because it will be parsed later, so only skipping is allowed
+    Parser parser(parser_.data());
+    TRY_STATUS(json_scan_object_types(parser, max_depth_ - depth_, true, object_types_));
+    it = object_types_.find(begin);
+    CHECK(it != object_types_.end());
+  }
+  auto result = it->second;
+  object_types_.erase(begin);
+  return result;
+}
+
+Status JsonPullParser::finish() {
+  if (!parser_.empty()) {
+    return Status::Error("Expected string end");
+  }
+  return Status::OK();
+}
+
 Slice JsonValue::get_type_name(Type type) {
   switch (type) {
     case Type::Null:
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "td/utils/common.h"
+#include "td/utils/FlatHashMap.h"
 #include "td/utils/logging.h"
 #include "td/utils/Parser.h"
 #include "td/utils/Slice.h"
@@ -726,6 +727,56 @@ inline Result<JsonValue> json_decode(MutableSlice from) {
   return result;
 }
 
+// decodes JSON in place value by value without building a JsonValue tree
+class JsonPullParser {
+ public:
+  static constexpr int32 DEFAULT_MAX_DEPTH = 100;
+
+  explicit JsonPullParser(MutableSlice from, int32 max_depth = DEFAULT_MAX_DEPTH)
+      : parser_(from), max_depth_(max_depth) {
+  }
+
+  // returns type of the next value; unexpected symbols are reported as Null and fail in read_null
+  JsonValue::Type peek_type();
+
+  static JsonValue::Type get_value_type(Slice value);
+
+  Status read_null() TD_WARN_UNUSED_RESULT;
+  Result<bool> read_boolean() TD_WARN_UNUSED_RESULT;
+  Result<MutableSlice> read_number() TD_WARN_UNUSED_RESULT;
+  Result<MutableSlice> read_string() TD_WARN_UNUSED_RESULT;
+  Result<JsonValue> read_value() TD_WARN_UNUSED_RESULT;
+  Status skip_value() TD_WARN_UNUSED_RESULT;
+
+  Status enter_object() TD_WARN_UNUSED_RESULT;
+  // reads name of the next field of the current object; returns false after the end of the object
+  Result<bool> next_field(MutableSlice &name) TD_WARN_UNUSED_RESULT;
+
+  Status enter_array() TD_WARN_UNUSED_RESULT;
+  // returns false after the end of the current array
+  Result<bool> next_element() TD_WARN_UNUSED_RESULT;
+
+  // returns raw unparsed value of the field of the next object value or an empty slice if there is no such field,
+  // the parser state isn't changed
+  Result<MutableSlice> find_object_field(Slice name) TD_WARN_UNUSED_RESULT;
+
+  // the same as find_object_field("@type"), but remembers the field of nested objects found during the search,
+  // so each object is scanned at most once and parsing of deeply nested objects remains linear
+  Result<MutableSlice> find_object_type() TD_WARN_UNUSED_RESULT;
+
+  Status finish() TD_WARN_UNUSED_RESULT;
+
+ private:
+  Parser parser_;
+  int32 max_depth_;
+  int32 depth_ = 0;
+  bool is_first_ = false;
+  FlatHashMap<const char *, MutableSlice> object_types_;  // object begin -> raw value of its field "@type"
+
+  Status enter(char c) TD_WARN_UNUSED_RESULT;
+  Result<bool> next(char end_c) TD_WARN_UNUSED_RESULT;
+};
+
 template <class StrT, class ValT>
 StrT json_encode(const ValT &val) {
   auto buf_len = 1 << 19;
@@ -15,7 +15,9 @@
 #include <sched.h>
 #endif
 
+#include <atomic>
 #include <utility>
+#include <vector>
 
 #include <td/utils/SpinLock.h>
 
@@ -39,9 +41,15 @@ class MpscPollableQueue {
       reader_vector_.clear();
       reader_pos_ = 0;
       std::swap(writer_vector_, reader_vector_);
+      has_writer_values_.store(false, std::memory_order_relaxed);
       return narrow_cast<int>(reader_vector_.size());
     }
   }
+  // returns true if reader_wait_nonblock will return non-zero value; unlike it, doesn't touch the event_fd_
+  // and doesn't take the lock, so can be used for busy polling without slowing down writers
+  bool reader_has_values() {
+    return reader_pos_ != reader_vector_.size() || has_writer_values_.load(std::memory_order_relaxed);
+  }
   ValueT reader_get_unsafe() {
     return std::move(reader_vector_[reader_pos_++]);
   }
@@ -51,6 +59,27 @@ class MpscPollableQueue {
   void writer_put(ValueT value) {
     auto guard = lock_.lock();
     writer_vector_.push_back(std::move(value));
+    has_writer_values_.store(true, std::memory_order_relaxed);
+    if (wait_event_fd_) {
+      wait_event_fd_ = false;
+      event_fd_.release();
+    }
+  }
+  // puts all values at once, leaving the vector empty
+  void writer_put_batch(std::vector<ValueT> &values) {
+    if (values.empty()) {
+      return;
+    }
+    auto guard = lock_.lock();
+    if (writer_vector_.empty()) {
+      std::swap(writer_vector_, values);
+    } else {
+      for (auto &value : values) {
+        writer_vector_.push_back(std::move(value));
+      }
+      values.clear();
+    }
+    has_writer_values_.store(true, std::memory_order_relaxed);
     if (wait_event_fd_) {
       wait_event_fd_ = false;
       event_fd_.release();
@@ -71,6 +100,7 @@ class MpscPollableQueue {
       event_fd_.close();
       wait_event_fd_ = false;
       writer_vector_.clear();
+      has_writer_values_ = false;
       reader_vector_.clear();
       reader_pos_ = 0;
     }
@@ -95,17 +125,176 @@ class MpscPollableQueue {
  private:
   SpinLock lock_;
   bool wait_event_fd_{false};
+  std::atomic<bool> has_writer_values_{false};  // equals to !writer_vector_.empty(), but can be read without the lock
   EventFd event_fd_;
   std::vector<ValueT> writer_vector_;
   std::vector<ValueT> reader_vector_;
   size_t reader_pos_{0};
 };
 
+// Lock-free variant of MpscPollableQueue with the same interface. Writers push nodes to an intrusive stack with one
+// CAS, the reader takes the whole stack at once. It needs one allocation per value, but writers never wait for
+// each other or for the reader.
+template <class ValueT>
+class MpscPollableLinkQueue {
+ public:
+  MpscPollableLinkQueue() = default;
+  MpscPollableLinkQueue(const MpscPollableLinkQueue &) = delete;
+  MpscPollableLinkQueue &operator=(const MpscPollableLinkQueue &) = delete;
+  MpscPollableLinkQueue(MpscPollableLinkQueue &&) = delete;
+  MpscPollableLinkQueue &operator=(MpscPollableLinkQueue &&) = delete;
+  ~MpscPollableLinkQueue() {
+    clear();
+  }
+
+  int reader_wait_nonblock() {
+    if (reader_size_ != 0) {
+      return narrow_cast<int>(reader_size_);
+    }
+
+    if (reader_take_all()) {
+      return narrow_cast<int>(reader_size_);
+    }
+    event_fd_.acquire();
+    // seq_cst store and exchange pair with seq_cst CAS and load in writer_push, so either a writer sees the flag
+    // or we see its node
+    wait_event_fd_.store(true, std::memory_order_seq_cst);
+    if (reader_take_all()) {
+      // if a writer has already reset the flag, then event_fd_ is released and the next acquire will just drain it
+      wait_event_fd_.store(false, std::memory_order_relaxed);
+      return narrow_cast<int>(reader_size_);
+    }
+    return 0;
+  }
+  bool reader_has_values() {
+    return reader_size_ != 0 || head_.load(std::memory_order_relaxed) != nullptr;
+  }
+  ValueT reader_get_unsafe() {
+    Node *node = reader_head_;
+    reader_head_ = node->next;
+    reader_size_--;
+    ValueT result = std::move(node->value);
+    delete node;
+    return result;
+  }
+  void reader_flush() {
+    //nop
+  }
+  void writer_put(ValueT value) {
+    Node *node = new Node(std::move(value));
+    writer_push(node, node);
+  }
+  // puts all values at once, leaving the vector empty
+  void writer_put_batch(std::vector<ValueT> &values) {
+    if (values.empty()) {
+      return;
+    }
+    // the stack is in reverse order, so the last value must be on top
+    Node *last = new Node(std::move(values[0]));
+    Node *first = last;
+    for (size_t i = 1; i < values.size(); i++) {
+      Node *node = new Node(std::move(values[i]));
+      node->next = first;
+      first = node;
+    }
+    values.clear();
+    writer_push(first, last);
+  }
+  EventFd &reader_get_event_fd() {
+    return event_fd_;
+  }
+  void writer_flush() {
+    //nop
+  }
+
+  void init() {
+    event_fd_.init();
+  }
+  void destroy() {
+    if (!event_fd_.empty()) {
+      event_fd_.close();
+      wait_event_fd_ = false;
+      clear();
+    }
+  }
+
+#if !TD_WINDOWS
+  int reader_wait() {
+    int res;
+
+    while ((res = reader_wait_nonblock()) == 0) {
+      pollfd fd;
+      fd.fd = reader_get_event_fd().get_fd().get_native_fd();
+      fd.events = POLLIN;
+      poll(&fd, 1, -1);
+    }
+    return res;
+  }
+#endif
+
+ private:
+  struct Node {
+    explicit Node(ValueT &&value) : value(std::move(value)) {
+    }
+    Node *next{nullptr};
+    ValueT value;
+  };
+
+  std::atomic<Node *> head_{nullptr};
+  std::atomic<bool> wait_event_fd_{false};
+  EventFd event_fd_;
+
+  Node *reader_head_{nullptr};
+  size_t reader_size_{0};
+
+  // pushes list from first to last, which is already linked in the reverse order
+  void writer_push(Node *first, Node *last) {
+    last->next = head_.load(std::memory_order_relaxed);
+    while (!head_.compare_exchange_weak(last->next, first, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+    }
+    if (wait_event_fd_.load(std::memory_order_seq_cst) && wait_event_fd_.exchange(false, std::memory_order_relaxed)) {
+      event_fd_.release();
+    }
+  }
+
+  // moves all written values to the reader list, returns true if there are some
+  bool reader_take_all() {
+    Node *node = head_.exchange(nullptr, std::memory_order_seq_cst);
+    if (node == nullptr) {
+      return false;
+    }
+    // reverse the stack to get values in the order of writing
+    Node *head = nullptr;
+    size_t size = 0;
+    while (node != nullptr) {
+      Node *next = node->next;
+      node->next = head;
+      head = node;
+      node = next;
+      size++;
+    }
+    reader_head_ = head;
+    reader_size_ = size;
+    return true;
+  }
+
+  void clear() {
+    while (reader_size_ != 0) {
+      reader_get_unsafe();
+    }
+    if (reader_take_all()) {
+      clear();
+    }
+  }
+};
+
 }  // namespace td
 
 #else
 #include "td/utils/logging.h"
 
+#include <vector>
+
 namespace td {
 
 // dummy implementation which shouldn't be used
@@ -124,6 +313,10 @@ class MpscPollableQueue {
     UNREACHABLE();
   }
 
+  void writer_put_batch(std::vector<ValueType> &values) {
+    UNREACHABLE();
+  }
+
   void writer_flush() {
     UNREACHABLE();
   }
@@ -150,6 +343,9 @@ class MpscPollableQueue {
   ~MpscPollableQueue() = default;
 };
 
+template <class T>
+using MpscPollableLinkQueue = MpscPollableQueue<T>;
+
 }  // namespace td
 
 #endif
@@ -73,6 +73,10 @@ class DefaultStorer : public Storer {
     return tl_store_unsafe(object_, ptr);
   }
 
+  const T &get_object() const {
+    return object_;
+  }
+
  private:
   mutable size_t size_ = std::numeric_limits<size_t>::max();
   const T &object_;
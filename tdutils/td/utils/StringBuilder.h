@@ -82,53 +82,28 @@ class StringBuilder {
     return *this << static_cast<int>(c);
   }
 
-  // TODO: optimize
   StringBuilder &operator<<(int x) {
-    if (unlikely(end_ptr_ < current_ptr_)) {
-      return on_error();
-    }
-    current_ptr_ += std::snprintf(current_ptr_, reserved_size, "%d", x);
-    return *this;
+    return print_signed(x);
   }
 
   StringBuilder &operator<<(unsigned int x) {
-    if (unlikely(end_ptr_ < current_ptr_)) {
-      return on_error();
-    }
-    current_ptr_ += std::snprintf(current_ptr_, reserved_size, "%u", x);
-    return *this;
+    return print_unsigned(x);
   }
 
   StringBuilder &operator<<(long int x) {
-    if (unlikely(end_ptr_ < current_ptr_)) {
-      return on_error();
-    }
-    current_ptr_ += std::snprintf(current_ptr_, reserved_size, "%ld", x);
-    return *this;
+    return print_signed(x);
   }
 
   StringBuilder &operator<<(long unsigned int x) {
-    if (unlikely(end_ptr_ < current_ptr_)) {
-      return on_error();
-    }
-    current_ptr_ += std::snprintf(current_ptr_, reserved_size, "%lu", x);
-    return *this;
+    return print_unsigned(x);
   }
 
   StringBuilder &operator<<(long long int x) {
-    if (unlikely(end_ptr_ < current_ptr_)) {
-      return on_error();
-    }
-    current_ptr_ += std::snprintf(current_ptr_, reserved_size, "%lld", x);
-    return *this;
+    return print_signed(x);
   }
 
   StringBuilder &operator<<(long long unsigned int x) {
-    if (unlikely(end_ptr_ < current_ptr_)) {
-      return on_error();
-    }
-    current_ptr_ += std::snprintf(current_ptr_, reserved_size, "%llu", x);
-    return *this;
+    return print_unsigned(x);
   }
 
   StringBuilder &operator<<(double x) {
@@ -189,6 +164,44 @@ class StringBuilder {
     error_flag_ = true;
     return *this;
   }
+
+  // integers are printed manually, because snprintf is too slow for JSON and log output
+  template <class T>
+  void print_digits(T x) {
+    char digits[20];
+    int length = 0;
+    do {
+      digits[length++] = static_cast<char>('0' + x % 10);
+      x /= 10;
+    } while (x != 0);
+    while (length > 0) {
+      *current_ptr_++ = digits[--length];
+    }
+  }
+
+  template <class T>
+  StringBuilder &print_unsigned(T x) {
+    if (unlikely(end_ptr_ < current_ptr_)) {
+      return on_error();
+    }
+    print_digits(x);
+    return *this;
+  }
+
+  template <class T>
+  StringBuilder &print_signed(T x) {
+    if (unlikely(end_ptr_ < current_ptr_)) {
+      return on_error();
+    }
+    using UnsignedT = typename std::make_unsigned<T>::type;
+    auto value = static_cast<UnsignedT>(x);
+    if (x < 0) {
+      *current_ptr_++ = '-';
+      value = static_cast<UnsignedT>(0) - value;
+    }
+    print_digits(value);
+    return *this;
+  }
 };
 
 template <class T>
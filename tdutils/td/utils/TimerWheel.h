@@ -0,0 +1,279 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2018
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/common.h"
+#include "td/utils/Heap.h"
+#include "td/utils/logging.h"
+
+#include <array>
+#include <cmath>
+#include <limits>
+
+namespace td {
+
+// Hierarchical timing wheel, which can be used instead of KHeap<double> for timeouts.
+// Uses the same HeapNode, but HeapNode::is_top is meaningless for it.
+// insert, fix and erase are O(1). Keys are rounded up to the resolution, so nodes expire not earlier than their key
+// and at most one tick later.
+class TimerWheel {
+ public:
+  explicit TimerWheel(double resolution = 0.001) : resolution_(resolution) {
+    heads_.fill(-1);
+    bits_.fill(0);
+  }
+
+  bool empty() const {
+    return size_ == 0;
+  }
+  size_t size() const {
+    return size_;
+  }
+
+  void insert(double key, HeapNode *node) {
+    CHECK(!node->in_heap());
+    int32 pos;
+    if (free_pos_.empty()) {
+      pos = static_cast<int32>(items_.size());
+      items_.emplace_back();
+    } else {
+      pos = free_pos_.back();
+      free_pos_.pop_back();
+    }
+    size_++;
+    auto &item = items_[pos];
+    item.tick = to_tick(key);
+    item.node = node;
+    node->pos_ = pos;
+    link(pos);
+  }
+
+  void fix(double key, HeapNode *node) {
+    CHECK(node->in_heap());
+    int32 pos = node->pos_;
+    auto &item = items_[pos];
+    item.tick = to_tick(key);
+    if (get_slot_id(item.tick) != item.slot_id) {
+      unlink(pos);
+      link(pos);
+    }
+  }
+
+  void erase(HeapNode *node) {
+    CHECK(node->in_heap());
+    int32 pos = node->pos_;
+    node->remove();
+    erase(pos);
+  }
+
+  // returns a node with key not greater than now or nullptr, if there are no such nodes
+  HeapNode *pop_expired(double now) {
+    int64 now_tick = static_cast<int64>(std::floor(now / resolution_));
+    if (empty()) {
+      if (now_tick > cur_tick_) {
+        cur_tick_ = now_tick;
+      }
+      return nullptr;
+    }
+    while (true) {
+      int32 pos = heads_[slot_id(0, static_cast<int32>(cur_tick_ & SLOT_MASK))];
+      if (pos != -1) {
+        HeapNode *result = items_[pos].node;
+        result->remove();
+        erase(pos);
+        return result;
+      }
+      if (cur_tick_ >= now_tick) {
+        return nullptr;
+      }
+      int64 next_tick = get_next_tick();
+      if (next_tick > now_tick) {
+        // there is nothing to cascade or to expire before now_tick
+        cur_tick_ = now_tick;
+        return nullptr;
+      }
+      cur_tick_ = next_tick;
+      cascade();
+    }
+  }
+
+  // returns lower bound for the time when some node will be returned by pop_expired,
+  // or a time not later than the last time passed to pop_expired, if there are already expired nodes
+  double next_key() const {
+    CHECK(!empty());
+    if (heads_[slot_id(0, static_cast<int32>(cur_tick_ & SLOT_MASK))] != -1) {
+      return static_cast<double>(cur_tick_) * resolution_;
+    }
+    return static_cast<double>(get_next_tick()) * resolution_;
+  }
+
+ private:
+  static constexpr int32 LEVEL_BITS = 8;
+  static constexpr int32 LEVEL_COUNT = 4;
+  static constexpr int32 SLOT_COUNT = 1 << LEVEL_BITS;
+  static constexpr int64 SLOT_MASK = SLOT_COUNT - 1;
+  static constexpr int32 WORD_COUNT = SLOT_COUNT / 64;
+  static constexpr int32 OVERFLOW_SLOT_ID = LEVEL_COUNT * SLOT_COUNT;
+
+  struct Item {
+    int64 tick;
+    HeapNode *node;
+    int32 slot_id;
+    int32 prev;
+    int32 next;
+  };
+
+  double resolution_;
+  int64 cur_tick_ = 0;
+  size_t size_ = 0;
+  vector<Item> items_;
+  vector<int32> free_pos_;
+  std::array<int32, OVERFLOW_SLOT_ID + 1> heads_;
+  std::array<uint64, LEVEL_COUNT * WORD_COUNT> bits_;  // non-empty slots
+
+  int64 to_tick(double key) const {
+    return static_cast<int64>(std::ceil(key / resolution_));
+  }
+
+  static int32 slot_id(int32 level, int32 slot) {
+    return level * SLOT_COUNT + slot;
+  }
+
+  static int32 count_trailing_zeros(uint64 x) {
+#if TD_GCC || TD_CLANG
+    return __builtin_ctzll(x);
+#else
+    int32 res = 0;
+    while ((x & 1) == 0) {
+      x >>= 1;
+      res++;
+    }
+    return res;
+#endif
+  }
+
+  // returns first non-empty slot of the level with index greater than or equal to from, or -1
+  int32 find_slot(int32 level, int32 from) const {
+    for (int32 word = from / 64; word < WORD_COUNT; word++) {
+      uint64 x = bits_[level * WORD_COUNT + word];
+      if (word == from / 64) {
+        x &= std::numeric_limits<uint64>::max() << (from % 64);
+      }
+      if (x != 0) {
+        return word * 64 + count_trailing_zeros(x);
+      }
+    }
+    return -1;
+  }
+
+  // returns first tick greater than cur_tick_ at which a node can expire or must be cascaded
+  int64 get_next_tick() const {
+    int64 result = std::numeric_limits<int64>::max();
+    for (int32 level = 0; level < LEVEL_COUNT; level++) {
+      int32 shift = level * LEVEL_BITS;
+      int32 cur_slot = static_cast<int32>((cur_tick_ >> shift) & SLOT_MASK);
+      if (cur_slot + 1 < SLOT_COUNT) {
+        int32 slot = find_slot(level, cur_slot + 1);
+        if (slot != -1) {
+          int64 tick =
+              ((cur_tick_ >> (shift + LEVEL_BITS)) << (shift + LEVEL_BITS)) | (static_cast<int64>(slot) << shift);
+          if (tick < result) {
+            result = tick;
+          }
+        }
+      }
+    }
+    if (heads_[OVERFLOW_SLOT_ID] != -1) {
+      int32 shift = LEVEL_COUNT * LEVEL_BITS;
+      int64 tick = ((cur_tick_ >> shift) + 1) << shift;
+      if (tick < result) {
+        result = tick;
+      }
+    }
+    return result;
+  }
+
+  // redistributes nodes from the slots, which start at cur_tick_
+  void cascade() {
+    if ((cur_tick_ & ((static_cast<int64>(1) << (LEVEL_COUNT * LEVEL_BITS)) - 1)) == 0) {
+      relink_slot(OVERFLOW_SLOT_ID);
+    }
+    for (int32 level = LEVEL_COUNT - 1; level > 0; level--) {
+      int32 shift = level * LEVEL_BITS;
+      if ((cur_tick_ & ((static_cast<int64>(1) << shift) - 1)) == 0) {
+        relink_slot(slot_id(level, static_cast<int32>((cur_tick_ >> shift) & SLOT_MASK)));
+      }
+    }
+  }
+
+  void relink_slot(int32 id) {
+    int32 pos = heads_[id];
+    while (pos != -1) {
+      int32 next = items_[pos].next;
+      unlink(pos);
+      link(pos);
+      pos = next;
+    }
+  }
+
+  int32 get_slot_id(int64 tick) const {
+    if (tick <= cur_tick_) {
+      return slot_id(0, static_cast<int32>(cur_tick_ & SLOT_MASK));
+    }
+    int64 diff = tick ^ cur_tick_;
+    int32 level = 0;
+    while (level < LEVEL_COUNT && (diff >> ((level + 1) * LEVEL_BITS)) != 0) {
+      level++;
+    }
+    if (level == LEVEL_COUNT) {
+      return OVERFLOW_SLOT_ID;
+    }
+    return slot_id(level, static_cast<int32>((tick >> (level * LEVEL_BITS)) & SLOT_MASK));
+  }
+
+  void link(int32 pos) {
+    auto &item = items_[pos];
+    int32 id = get_slot_id(item.tick);
+    item.slot_id = id;
+    item.prev = -1;
+    item.next = heads_[id];
+    if (item.next != -1) {
+      items_[item.next].prev = pos;
+    } else if (id != OVERFLOW_SLOT_ID) {
+      bits_[id / 64] |= static_cast<uint64>(1) << (id % 64);
+    }
+    heads_[id] = pos;
+  }
+
+  void unlink(int32 pos) {
+    auto &item = items_[pos];
+    if (item.prev != -1) {
+      items_[item.prev].next = item.next;
+    } else {
+      heads_[item.slot_id] = item.next;
+      if (item.next == -1 && item.slot_id != OVERFLOW_SLOT_ID) {
+        bits_[item.slot_id / 64] &= ~(static_cast<uint64>(1) << (item.slot_id % 64));
+      }
+    }
+    if (item.next != -1) {
+      items_[item.next].prev = item.prev;
+    }
+  }
+
+  void erase(int32 pos) {
+    unlink(pos);
+    size_--;
+    if (size_ == 0) {
+      items_.clear();
+      free_pos_.clear();
+    } else {
+      free_pos_.push_back(pos);
+    }
+  }
+};
+
+}  // namespace td
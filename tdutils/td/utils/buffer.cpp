@@ -6,12 +6,212 @@
 //
 #include "td/utils/buffer.h"
 
+#include "td/utils/misc.h"
 #include "td/utils/port/thread_local.h"
 
+#include <array>
+#include <mutex>
 #include <new>
+#include <unordered_set>
 
 namespace td {
 
+namespace {
+
+// BufferRaw with data_size_ up to 2^MAX_POOLED_BUFFER_SIZE_LOG are allocated from pools with block sizes
+// offsetof(BufferRaw, data_) + 2^k; ChainBufferNode has its own pool
+constexpr size_t MIN_POOLED_BUFFER_SIZE_LOG = 9;
+constexpr size_t MAX_POOLED_BUFFER_SIZE_LOG = 16;
+constexpr size_t BUFFER_POOL_COUNT = MAX_POOLED_BUFFER_SIZE_LOG - MIN_POOLED_BUFFER_SIZE_LOG + 1;
+constexpr size_t CHAIN_BUFFER_NODE_POOL_ID = BUFFER_POOL_COUNT;
+constexpr size_t POOL_COUNT = BUFFER_POOL_COUNT + 1;
+
+// Global part of a pool of free memory blocks of the same size. Each thread caches free blocks in its own list,
+// and whole batches of blocks are moved between threads through the depot, because buffers are often allocated
+// in one thread and freed in another.
+class BlockPool {
+ public:
+  void init(size_t block_size) {
+    block_size_ = block_size;
+    batch_size_ = clamp(static_cast<size_t>(1 << 18) / block_size, static_cast<size_t>(4), static_cast<size_t>(64));
+  }
+
+  size_t block_size() const {
+    return block_size_;
+  }
+  size_t batch_size() const {
+    return batch_size_;
+  }
+
+  bool get_batch(vector<void *> &blocks) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (depot_.empty()) {
+      return false;
+    }
+    std::swap(blocks, depot_.back());
+    depot_.pop_back();
+    return true;
+  }
+
+  // returns false, if the depot is full and the blocks must be freed
+  bool put_batch(vector<void *> &&blocks) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (depot_.size() >= MAX_DEPOT_BATCH_COUNT) {
+      return false;
+    }
+    depot_.push_back(std::move(blocks));
+    return true;
+  }
+
+ private:
+  static constexpr size_t MAX_DEPOT_BATCH_COUNT = 16;
+
+  size_t block_size_ = 0;
+  size_t batch_size_ = 0;
+  std::mutex mutex_;
+  vector<vector<void *>> depot_;
+};
+
+struct BlockPoolsTls;
+
+struct BlockPools {
+  std::array<BlockPool, POOL_COUNT> pools;
+
+  std::mutex mutex;
+  std::unordered_set<BlockPoolsTls *> threads;
+  std::atomic<size_t> depot_mem{0};
+
+  BlockPools() {
+    for (size_t i = 0; i < BUFFER_POOL_COUNT; i++) {
+      pools[i].init(offsetof(BufferRaw, data_) + (static_cast<size_t>(1) << (i + MIN_POOLED_BUFFER_SIZE_LOG)));
+    }
+    pools[CHAIN_BUFFER_NODE_POOL_ID].init(sizeof(ChainBufferNode));
+  }
+
+  bool get_batch(size_t pool_id, vector<void *> &blocks) {
+    if (!pools[pool_id].get_batch(blocks)) {
+      return false;
+    }
+    depot_mem.fetch_sub(blocks.size() * pools[pool_id].block_size(), std::memory_order_relaxed);
+    return true;
+  }
+
+  void put_batch(size_t pool_id, vector<void *> &&blocks) {
+    auto size = blocks.size() * pools[pool_id].block_size();
+    if (pools[pool_id].put_batch(std::move(blocks))) {
+      depot_mem.fetch_add(size, std::memory_order_relaxed);
+      return;
+    }
+    for (auto ptr : blocks) {
+      delete[] static_cast<char *>(ptr);
+    }
+    blocks.clear();
+  }
+
+  size_t get_cached_mem();
+};
+
+BlockPools &get_block_pools() {
+  static BlockPools *pools = new BlockPools();  // intentionally leaked, because buffers can be freed after exit
+  return *pools;
+}
+
+// free blocks cached by a thread
+struct BlockPoolsTls {
+  BlockPools *pools;
+  std::array<vector<void *>, POOL_COUNT> blocks;
+  std::atomic<size_t> cached_mem{0};  // is changed only by the owning thread
+
+  BlockPoolsTls() : pools(&get_block_pools()) {
+    std::lock_guard<std::mutex> lock(pools->mutex);
+    pools->threads.insert(this);
+  }
+  BlockPoolsTls(const BlockPoolsTls &) = delete;
+  BlockPoolsTls &operator=(const BlockPoolsTls &) = delete;
+  BlockPoolsTls(BlockPoolsTls &&) = delete;
+  BlockPoolsTls &operator=(BlockPoolsTls &&) = delete;
+  ~BlockPoolsTls() {
+    {
+      std::lock_guard<std::mutex> lock(pools->mutex);
+      pools->threads.erase(this);
+    }
+    for (size_t i = 0; i < POOL_COUNT; i++) {
+      if (!blocks[i].empty()) {
+        pools->put_batch(i, std::move(blocks[i]));
+      }
+    }
+  }
+
+  void add_cached_mem(size_t size) {
+    cached_mem.store(cached_mem.load(std::memory_order_relaxed) + size, std::memory_order_relaxed);
+  }
+  void sub_cached_mem(size_t size) {
+    cached_mem.store(cached_mem.load(std::memory_order_relaxed) - size, std::memory_order_relaxed);
+  }
+};
+
+size_t BlockPools::get_cached_mem() {
+  size_t result = depot_mem.load(std::memory_order_relaxed);
+  std::lock_guard<std::mutex> lock(mutex);
+  for (auto tls : threads) {
+    result += tls->cached_mem.load(std::memory_order_relaxed);
+  }
+  return result;
+}
+
+TD_THREAD_LOCAL BlockPoolsTls *block_pools_tls;  // static zero-initialized
+
+void *allocate_block(size_t pool_id) {
+  init_thread_local<BlockPoolsTls>(block_pools_tls);
+  auto *tls = block_pools_tls;
+  auto &blocks = tls->blocks[pool_id];
+  auto block_size = tls->pools->pools[pool_id].block_size();
+  if (blocks.empty()) {
+    if (!tls->pools->get_batch(pool_id, blocks)) {
+      return new char[block_size];
+    }
+    tls->add_cached_mem(blocks.size() * block_size);
+  }
+  auto ptr = blocks.back();
+  blocks.pop_back();
+  tls->sub_cached_mem(block_size);
+  return ptr;
+}
+
+void free_block(size_t pool_id, void *ptr) {
+  auto *tls = block_pools_tls;
+  if (tls == nullptr) {
+    // thread local storage must not be created here, because blocks can be freed by thread local destructors
+    delete[] static_cast<char *>(ptr);
+    return;
+  }
+  auto &pool = tls->pools->pools[pool_id];
+  auto &blocks = tls->blocks[pool_id];
+  if (blocks.size() >= 2 * pool.batch_size()) {
+    auto batch_begin = blocks.end() - pool.batch_size();
+    vector<void *> batch(batch_begin, blocks.end());
+    blocks.erase(batch_begin, blocks.end());
+    tls->sub_cached_mem(batch.size() * pool.block_size());
+    tls->pools->put_batch(pool_id, std::move(batch));
+  }
+  blocks.push_back(ptr);
+  tls->add_cached_mem(pool.block_size());
+}
+
+// returns identifier of the pool for BufferRaw with the given data size or POOL_COUNT if it isn't pooled
+size_t get_buffer_pool_id(size_t data_size) {
+  if (data_size > (static_cast<size_t>(1) << MAX_POOLED_BUFFER_SIZE_LOG)) {
+    return POOL_COUNT;
+  }
+  size_t pool_id = 0;
+  while ((static_cast<size_t>(1) << (pool_id + MIN_POOLED_BUFFER_SIZE_LOG)) < data_size) {
+    pool_id++;
+  }
+  return pool_id;
+}
+
+}  // namespace
+
 TD_THREAD_LOCAL BufferAllocator::BufferRawTls *BufferAllocator::buffer_raw_tls;  // static zero-initialized
 
 std::atomic<size_t> BufferAllocator::buffer_mem;
@@ -20,6 +220,10 @@ size_t BufferAllocator::get_buffer_mem() {
   return buffer_mem;
 }
 
+size_t BufferAllocator::get_buffer_pool_mem() {
+  return get_block_pools().get_cached_mem();
+}
+
 BufferAllocator::WriterPtr BufferAllocator::create_writer(size_t size) {
   if (size < 512) {
     size = 512;
@@ -78,8 +282,13 @@ void BufferAllocator::dec_ref_cnt(BufferRaw *ptr) {
   if (left == 1) {
     auto buf_size = std::max(sizeof(BufferRaw), offsetof(BufferRaw, data_) + ptr->data_size_);
     buffer_mem -= buf_size;
+    auto pool_id = get_buffer_pool_id(ptr->data_size_);
     ptr->~BufferRaw();
-    delete[] ptr;
+    if (pool_id < POOL_COUNT) {
+      free_block(pool_id, ptr);
+    } else {
+      delete[] reinterpret_cast<char *>(ptr);
+    }
   }
 }
 
@@ -91,7 +300,8 @@ BufferRaw *BufferAllocator::create_buffer_raw(size_t size) {
     buf_size = sizeof(BufferRaw);
   }
   buffer_mem += buf_size;
-  auto *buffer_raw = reinterpret_cast<BufferRaw *>(new char[buf_size]);
+  auto pool_id = get_buffer_pool_id(size);
+  auto *buffer_raw = static_cast<BufferRaw *>(pool_id < POOL_COUNT ? allocate_block(pool_id) : new char[buf_size]);
   new (buffer_raw) BufferRaw();
   buffer_raw->data_size_ = size;
   buffer_raw->begin_ = 0;
@@ -102,4 +312,14 @@ BufferRaw *BufferAllocator::create_buffer_raw(size_t size) {
   buffer_raw->was_reader_ = false;
   return buffer_raw;
 }
+
+void *ChainBufferNode::operator new(size_t size) {
+  CHECK(size == sizeof(ChainBufferNode));
+  return allocate_block(CHAIN_BUFFER_NODE_POOL_ID);
+}
+
+void ChainBufferNode::operator delete(void *ptr) {
+  free_block(CHAIN_BUFFER_NODE_POOL_ID, ptr);
+}
+
 }  // namespace td
@@ -68,6 +68,9 @@ class BufferAllocator {
 
   static size_t get_buffer_mem();
 
+  // returns size of free memory, cached by the allocator for reuse
+  static size_t get_buffer_pool_mem();
+
   static void clear_thread_local();
 
  private:
@@ -329,6 +332,10 @@ struct ChainBufferNode {
   ChainBufferNode(BufferSlice slice, bool sync_flag) : slice_(std::move(slice)), sync_flag_(sync_flag) {
   }
 
+  // nodes are allocated from a pool of BufferAllocator
+  static void *operator new(size_t size);
+  static void operator delete(void *ptr);
+
   // reader
   // There are two options
   // 1. Fixed slice of Buffer
@@ -353,7 +360,6 @@ struct ChainBufferNode {
     int left = --ptr->ref_cnt_;
     if (left == 0) {
       clear_nonrecursive(std::move(ptr->next_));
-      // TODO(refact): move memory management into allocator (?)
       delete ptr;
     }
   }
@@ -532,6 +538,39 @@ class ChainBufferReader {
     begin_.confirm_read(size);
   }
 
+  // stores up to max_slice_count first consecutive parts of the data to slices without reading them
+  // returns number of the stored slices; the slices can be passed to writev and then skipped with advance
+  size_t prepare_readv(Slice *slices, size_t max_slice_count) {
+    size_t slice_count = 0;
+    size_t left = size();
+    if (left == 0 || max_slice_count == 0) {
+      return 0;
+    }
+    auto slice = prepare_read();
+    if (slice.empty()) {
+      return 0;
+    }
+    slices[slice_count++] = slice;
+    left -= slice.size();
+    if (left == 0 || slice_count == max_slice_count) {
+      return slice_count;
+    }
+
+    auto it = begin_.clone();
+    it.confirm_read(slice.size());
+    while (left > 0 && slice_count < max_slice_count) {
+      slice = it.prepare_read();
+      if (slice.empty()) {
+        break;
+      }
+      slice.truncate(left);
+      slices[slice_count++] = slice;
+      left -= slice.size();
+      it.confirm_read(slice.size());
+    }
+    return slice_count;
+  }
+
   size_t advance(size_t offset, MutableSlice dest = MutableSlice()) {
     CHECK(offset <= size());
     return begin_.advance(offset, dest);
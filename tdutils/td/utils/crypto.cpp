@@ -9,6 +9,7 @@
 #include "td/utils/BigNum.h"
 #include "td/utils/logging.h"
 #include "td/utils/misc.h"
+#include "td/utils/port/cpu.h"
 #include "td/utils/port/RwMutex.h"
 #include "td/utils/port/thread_local.h"
 #include "td/utils/Random.h"
@@ -26,7 +27,12 @@
 #include <zlib.h>
 #endif
 
+#if TD_HAVE_CPU_DISPATCH
+#include <immintrin.h>
+#endif
+
 #include <algorithm>
+#include <array>
 #include <cstring>
 #include <utility>
 
@@ -250,12 +256,215 @@ static void aes_ige_xcrypt(const UInt256 &aes_key, UInt256 *aes_iv, Slice from,
   AES_ige_encrypt(from.ubegin(), to.ubegin(), from.size(), &key, aes_iv->raw, encrypt_flag);
 }
 
+#if TD_HAVE_CPU_DISPATCH
+namespace {
+
+struct AesNiIgeLane {
+  __m128i round_keys[15];
+  __m128i iv1;  // previous ciphertext block
+  __m128i iv2;  // previous plaintext block
+  const AesIgeTask *task;
+  const unsigned char *from;
+  unsigned char *to;
+  size_t block_count;
+};
+
+TD_TARGET("aes") inline __m128i aes_ni_expand_key_odd(__m128i key, __m128i assist) {
+  assist = _mm_shuffle_epi32(assist, 0xff);
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 8));
+  return _mm_xor_si128(key, assist);
+}
+
+TD_TARGET("aes") inline __m128i aes_ni_expand_key_even(__m128i prev_key, __m128i key) {
+  auto assist = _mm_shuffle_epi32(_mm_aeskeygenassist_si128(prev_key, 0x00), 0xaa);
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 8));
+  return _mm_xor_si128(key, assist);
+}
+
+TD_TARGET("aes") void aes_ni_set_key(const UInt256 &aes_key, bool encrypt_flag, __m128i *round_keys) {
+  __m128i keys[15];
+  keys[0] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(aes_key.raw));
+  keys[1] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(aes_key.raw + 16));
+  keys[2] = aes_ni_expand_key_odd(keys[0], _mm_aeskeygenassist_si128(keys[1], 0x01));
+  keys[3] = aes_ni_expand_key_even(keys[2], keys[1]);
+  keys[4] = aes_ni_expand_key_odd(keys[2], _mm_aeskeygenassist_si128(keys[3], 0x02));
+  keys[5] = aes_ni_expand_key_even(keys[4], keys[3]);
+  keys[6] = aes_ni_expand_key_odd(keys[4], _mm_aeskeygenassist_si128(keys[5], 0x04));
+  keys[7] = aes_ni_expand_key_even(keys[6], keys[5]);
+  keys[8] = aes_ni_expand_key_odd(keys[6], _mm_aeskeygenassist_si128(keys[7], 0x08));
+  keys[9] = aes_ni_expand_key_even(keys[8], keys[7]);
+  keys[10] = aes_ni_expand_key_odd(keys[8], _mm_aeskeygenassist_si128(keys[9], 0x10));
+  keys[11] = aes_ni_expand_key_even(keys[10], keys[9]);
+  keys[12] = aes_ni_expand_key_odd(keys[10], _mm_aeskeygenassist_si128(keys[11], 0x20));
+  keys[13] = aes_ni_expand_key_even(keys[12], keys[11]);
+  keys[14] = aes_ni_expand_key_odd(keys[12], _mm_aeskeygenassist_si128(keys[13], 0x40));
+
+  if (encrypt_flag) {
+    std::copy(keys, keys + 15, round_keys);
+  } else {
+    round_keys[0] = keys[14];
+    for (int i = 1; i < 14; i++) {
+      round_keys[i] = _mm_aesimc_si128(keys[14 - i]);
+    }
+    round_keys[14] = keys[0];
+  }
+}
+
+template <size_t N, bool encrypt_flag>
+TD_TARGET("aes") void aes_ni_ige_xcrypt_lanes(AesNiIgeLane *lanes, size_t block_count) {
+  __m128i iv1[N];
+  __m128i iv2[N];
+  for (size_t l = 0; l < N; l++) {
+    iv1[l] = lanes[l].iv1;
+    iv2[l] = lanes[l].iv2;
+  }
+  for (size_t i = 0; i < block_count; i++) {
+    __m128i in[N];
+    __m128i x[N];
+    for (size_t l = 0; l < N; l++) {
+      in[l] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lanes[l].from + i * 16));
+      x[l] = _mm_xor_si128(_mm_xor_si128(in[l], encrypt_flag ? iv1[l] : iv2[l]), lanes[l].round_keys[0]);
+    }
+    for (int r = 1; r < 14; r++) {
+      for (size_t l = 0; l < N; l++) {
+        x[l] = encrypt_flag ? _mm_aesenc_si128(x[l], lanes[l].round_keys[r])
+                            : _mm_aesdec_si128(x[l], lanes[l].round_keys[r]);
+      }
+    }
+    for (size_t l = 0; l < N; l++) {
+      x[l] = encrypt_flag ? _mm_aesenclast_si128(x[l], lanes[l].round_keys[14])
+                          : _mm_aesdeclast_si128(x[l], lanes[l].round_keys[14]);
+      auto out = _mm_xor_si128(x[l], encrypt_flag ? iv2[l] : iv1[l]);
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes[l].to + i * 16), out);
+      iv1[l] = encrypt_flag ? out : in[l];
+      iv2[l] = encrypt_flag ? in[l] : out;
+    }
+  }
+  for (size_t l = 0; l < N; l++) {
+    lanes[l].iv1 = iv1[l];
+    lanes[l].iv2 = iv2[l];
+    lanes[l].from += block_count * 16;
+    lanes[l].to += block_count * 16;
+    lanes[l].block_count -= block_count;
+  }
+}
+
+// several independent chains are needed to hide latency of AES instructions
+constexpr size_t AES_NI_MAX_LANES = 8;
+
+template <bool encrypt_flag>
+TD_TARGET("aes") void aes_ni_ige_xcrypt_batch(const AesIgeTask *tasks, size_t task_count) {
+  AesNiIgeLane lanes[AES_NI_MAX_LANES];
+  size_t lane_count = 0;
+  size_t next_task = 0;
+  while (true) {
+    while (lane_count < AES_NI_MAX_LANES && next_task < task_count) {
+      auto &task = tasks[next_task++];
+      CHECK(task.from.size() % 16 == 0);
+      CHECK(task.from.size() <= task.to.size());
+      if (task.from.empty()) {
+        continue;
+      }
+      auto &lane = lanes[lane_count++];
+      aes_ni_set_key(*task.aes_key, encrypt_flag, lane.round_keys);
+      lane.iv1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(task.aes_iv->raw));
+      lane.iv2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(task.aes_iv->raw + 16));
+      lane.task = &task;
+      lane.from = task.from.ubegin();
+      lane.to = task.to.ubegin();
+      lane.block_count = task.from.size() / 16;
+    }
+    if (lane_count == 0) {
+      break;
+    }
+
+    size_t block_count = lanes[0].block_count;
+    for (size_t l = 1; l < lane_count; l++) {
+      block_count = std::min(block_count, lanes[l].block_count);
+    }
+    switch (lane_count) {
+      case 1:
+        aes_ni_ige_xcrypt_lanes<1, encrypt_flag>(lanes, block_count);
+        break;
+      case 2:
+        aes_ni_ige_xcrypt_lanes<2, encrypt_flag>(lanes, block_count);
+        break;
+      case 3:
+        aes_ni_ige_xcrypt_lanes<3, encrypt_flag>(lanes, block_count);
+        break;
+      case 4:
+        aes_ni_ige_xcrypt_lanes<4, encrypt_flag>(lanes, block_count);
+        break;
+      case 5:
+        aes_ni_ige_xcrypt_lanes<5, encrypt_flag>(lanes, block_count);
+        break;
+      case 6:
+        aes_ni_ige_xcrypt_lanes<6, encrypt_flag>(lanes, block_count);
+        break;
+      case 7:
+        aes_ni_ige_xcrypt_lanes<7, encrypt_flag>(lanes, block_count);
+        break;
+      case 8:
+        aes_ni_ige_xcrypt_lanes<8, encrypt_flag>(lanes, block_count);
+        break;
+      default:
+        UNREACHABLE();
+    }
+
+    size_t new_lane_count = 0;
+    for (size_t l = 0; l < lane_count; l++) {
+      if (lanes[l].block_count == 0) {
+        auto *iv = lanes[l].task->aes_iv->raw;
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(iv), lanes[l].iv1);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(iv + 16), lanes[l].iv2);
+        continue;
+      }
+      if (l != new_lane_count) {
+        lanes[new_lane_count] = lanes[l];
+      }
+      new_lane_count++;
+    }
+    lane_count = new_lane_count;
+  }
+}
+
+}  // namespace
+#endif
+
+void aes_ige_encrypt_batch(const AesIgeTask *tasks, size_t task_count) {
+#if TD_HAVE_CPU_DISPATCH
+  if (cpu_has_aes_ni()) {
+    aes_ni_ige_xcrypt_batch<true>(tasks, task_count);
+    return;
+  }
+#endif
+  for (size_t i = 0; i < task_count; i++) {
+    aes_ige_xcrypt(*tasks[i].aes_key, tasks[i].aes_iv, tasks[i].from, tasks[i].to, true);
+  }
+}
+
+void aes_ige_decrypt_batch(const AesIgeTask *tasks, size_t task_count) {
+#if TD_HAVE_CPU_DISPATCH
+  if (cpu_has_aes_ni()) {
+    aes_ni_ige_xcrypt_batch<false>(tasks, task_count);
+    return;
+  }
+#endif
+  for (size_t i = 0; i < task_count; i++) {
+    aes_ige_xcrypt(*tasks[i].aes_key, tasks[i].aes_iv, tasks[i].from, tasks[i].to, false);
+  }
+}
+
 void aes_ige_encrypt(const UInt256 &aes_key, UInt256 *aes_iv, Slice from, MutableSlice to) {
-  aes_ige_xcrypt(aes_key, aes_iv, from, to, true);
+  AesIgeTask task{&aes_key, aes_iv, from, to};
+  aes_ige_encrypt_batch(&task, 1);
 }
 
 void aes_ige_decrypt(const UInt256 &aes_key, UInt256 *aes_iv, Slice from, MutableSlice to) {
-  aes_ige_xcrypt(aes_key, aes_iv, from, to, false);
+  AesIgeTask task{&aes_key, aes_iv, from, to};
+  aes_ige_decrypt_batch(&task, 1);
 }
 
 static void aes_cbc_xcrypt(const UInt256 &aes_key, UInt128 *aes_iv, Slice from, MutableSlice to, bool encrypt_flag) {
@@ -282,34 +491,34 @@ void aes_cbc_decrypt(const UInt256 &aes_key, UInt128 *aes_iv, Slice from, Mutabl
 class AesCtrState::Impl {
  public:
   Impl(const UInt256 &key, const UInt128 &iv) {
-    if (AES_set_encrypt_key(key.raw, 256, &aes_key) < 0) {
-      LOG(FATAL) << "Failed to set encrypt key";
-    }
-    MutableSlice(counter, AES_BLOCK_SIZE).copy_from({iv.raw, AES_BLOCK_SIZE});
-    current_pos = 0;
+    ctx_ = EVP_CIPHER_CTX_new();
+    LOG_IF(FATAL, ctx_ == nullptr);
+    int err = EVP_EncryptInit_ex(ctx_, EVP_aes_256_ctr(), nullptr, key.raw, iv.raw);
+    LOG_IF(FATAL, err != 1) << "Failed to set encrypt key";
+  }
+  Impl(const Impl &from) = delete;
+  Impl &operator=(const Impl &from) = delete;
+  Impl(Impl &&from) = delete;
+  Impl &operator=(Impl &&from) = delete;
+  ~Impl() {
+    EVP_CIPHER_CTX_free(ctx_);
   }
 
   void encrypt(Slice from, MutableSlice to) {
     CHECK(to.size() >= from.size());
-    for (size_t i = 0; i < from.size(); i++) {
-      if (current_pos == 0) {
-        AES_encrypt(counter, encrypted_counter, &aes_key);
-        for (int j = 15; j >= 0; j--) {
-          if (++counter[j] != 0) {
-            break;
-          }
-        }
-      }
-      to[i] = static_cast<char>(from[i] ^ encrypted_counter[current_pos]);
-      current_pos = (current_pos + 1) & 15;
+    // the whole blocks are encrypted by OpenSSL in parallel
+    while (!from.empty()) {
+      auto size = static_cast<int>(std::min(from.size(), static_cast<size_t>(1 << 30)));
+      int out_size = 0;
+      int err = EVP_EncryptUpdate(ctx_, to.ubegin(), &out_size, from.ubegin(), size);
+      LOG_IF(FATAL, err != 1 || out_size != size);
+      from.remove_prefix(size);
+      to.remove_prefix(size);
     }
   }
 
  private:
-  AES_KEY aes_key;
-  uint8 counter[AES_BLOCK_SIZE];
-  uint8 encrypted_counter[AES_BLOCK_SIZE];
-  uint8 current_pos;
+  EVP_CIPHER_CTX *ctx_;
 };
 
 AesCtrState::AesCtrState() = default;
@@ -334,10 +543,184 @@ void sha1(Slice data, unsigned char output[20]) {
   CHECK(result == output);
 }
 
+#if TD_HAVE_CPU_DISPATCH
+namespace {
+
+struct Sha256NiState {
+  __m128i abef;
+  __m128i cdgh;
+};
+
+alignas(16) const uint32 SHA256_K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+// processes rounds from 4 * i to 4 * i + 3 for every lane; msg[l][J] contains message words from 4 * i - 16
+template <size_t N, size_t J>
+TD_TARGET("sha,sse4.1") inline void sha256_ni_rounds(Sha256NiState *states, __m128i (*msg)[4], size_t i,
+                                                     const unsigned char *const *blocks) {
+  static_assert(J < 4, "");
+  auto k = _mm_load_si128(reinterpret_cast<const __m128i *>(SHA256_K + i * 4));
+  for (size_t l = 0; l < N; l++) {
+    __m128i w;
+    if (i < 4) {
+      auto mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+      w = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(blocks[l] + i * 16)), mask);
+    } else {
+      w = _mm_sha256msg1_epu32(msg[l][J], msg[l][(J + 1) % 4]);
+      w = _mm_add_epi32(w, _mm_alignr_epi8(msg[l][(J + 3) % 4], msg[l][(J + 2) % 4], 4));
+      w = _mm_sha256msg2_epu32(w, msg[l][(J + 3) % 4]);
+    }
+    msg[l][J] = w;
+
+    w = _mm_add_epi32(w, k);
+    states[l].cdgh = _mm_sha256rnds2_epu32(states[l].cdgh, states[l].abef, w);
+    states[l].abef = _mm_sha256rnds2_epu32(states[l].abef, states[l].cdgh, _mm_shuffle_epi32(w, 0x0e));
+  }
+}
+
+template <size_t N>
+TD_TARGET("sha,sse4.1") void sha256_ni_compress(Sha256NiState *states, const unsigned char *const *blocks) {
+  Sha256NiState saved_states[N];
+  __m128i msg[N][4];
+  for (size_t l = 0; l < N; l++) {
+    saved_states[l] = states[l];
+  }
+  for (size_t i = 0; i < 16; i += 4) {
+    sha256_ni_rounds<N, 0>(states, msg, i, blocks);
+    sha256_ni_rounds<N, 1>(states, msg, i + 1, blocks);
+    sha256_ni_rounds<N, 2>(states, msg, i + 2, blocks);
+    sha256_ni_rounds<N, 3>(states, msg, i + 3, blocks);
+  }
+  for (size_t l = 0; l < N; l++) {
+    states[l].abef = _mm_add_epi32(states[l].abef, saved_states[l].abef);
+    states[l].cdgh = _mm_add_epi32(states[l].cdgh, saved_states[l].cdgh);
+  }
+}
+
+class Sha256NiLane {
+ public:
+  Sha256NiLane(Slice data, MutableSlice output) : data_(data), output_(output) {
+    CHECK(output.size() >= 32);
+    full_block_count_ = data.size() / 64;
+    auto tail_size = data.size() % 64;
+    std::memcpy(tail_, data.ubegin() + full_block_count_ * 64, tail_size);
+    tail_[tail_size] = 0x80;
+    block_count_ = full_block_count_ + (tail_size < 56 ? 1 : 2);
+    auto tail_end = tail_ + (block_count_ - full_block_count_) * 64;
+    std::memset(tail_ + tail_size + 1, 0, tail_end - 8 - (tail_ + tail_size + 1));
+    auto bit_length = static_cast<uint64>(data.size()) * 8;
+    for (int i = 0; i < 8; i++) {
+      tail_end[i - 8] = static_cast<unsigned char>(bit_length >> (56 - 8 * i));
+    }
+  }
+
+  size_t get_block_count() const {
+    return block_count_;
+  }
+
+  const unsigned char *get_block(size_t i) const {
+    if (i < full_block_count_) {
+      return data_.ubegin() + i * 64;
+    }
+    return tail_ + (i - full_block_count_) * 64;
+  }
+
+  MutableSlice get_output() const {
+    return output_;
+  }
+
+ private:
+  Slice data_;
+  MutableSlice output_;
+  size_t full_block_count_;
+  size_t block_count_;
+  unsigned char tail_[128];
+};
+
+TD_TARGET("sha,sse4.1") void sha256_ni_init(Sha256NiState *state) {
+  state->abef = _mm_set_epi32(0x6a09e667, static_cast<int>(0xbb67ae85), 0x510e527f, static_cast<int>(0x9b05688c));
+  state->cdgh = _mm_set_epi32(0x3c6ef372, static_cast<int>(0xa54ff53a), 0x1f83d9ab, 0x5be0cd19);
+}
+
+TD_TARGET("sha,sse4.1") void sha256_ni_final(const Sha256NiState &state, MutableSlice output) {
+  uint32 words[8] = {static_cast<uint32>(_mm_extract_epi32(state.abef, 3)),
+                     static_cast<uint32>(_mm_extract_epi32(state.abef, 2)),
+                     static_cast<uint32>(_mm_extract_epi32(state.cdgh, 3)),
+                     static_cast<uint32>(_mm_extract_epi32(state.cdgh, 2)),
+                     static_cast<uint32>(_mm_extract_epi32(state.abef, 1)),
+                     static_cast<uint32>(_mm_extract_epi32(state.abef, 0)),
+                     static_cast<uint32>(_mm_extract_epi32(state.cdgh, 1)),
+                     static_cast<uint32>(_mm_extract_epi32(state.cdgh, 0))};
+  for (size_t i = 0; i < 32; i++) {
+    output[i] = static_cast<char>(words[i / 4] >> (24 - 8 * (i % 4)));
+  }
+}
+
+TD_TARGET("sha,sse4.1") void sha256_ni_batch(const Slice *data, const MutableSlice *output, size_t count) {
+  for (size_t i = 0; i < count; i += 2) {
+    if (i + 1 == count) {
+      Sha256NiLane lane(data[i], output[i]);
+      Sha256NiState state;
+      sha256_ni_init(&state);
+      for (size_t j = 0; j < lane.get_block_count(); j++) {
+        auto block = lane.get_block(j);
+        sha256_ni_compress<1>(&state, &block);
+      }
+      sha256_ni_final(state, lane.get_output());
+      break;
+    }
+
+    // hash two inputs simultaneously, while both of them have blocks left
+    Sha256NiLane lanes[2] = {Sha256NiLane(data[i], output[i]), Sha256NiLane(data[i + 1], output[i + 1])};
+    Sha256NiState states[2];
+    sha256_ni_init(&states[0]);
+    sha256_ni_init(&states[1]);
+    auto common_block_count = std::min(lanes[0].get_block_count(), lanes[1].get_block_count());
+    for (size_t j = 0; j < common_block_count; j++) {
+      const unsigned char *blocks[2] = {lanes[0].get_block(j), lanes[1].get_block(j)};
+      sha256_ni_compress<2>(states, blocks);
+    }
+    for (size_t l = 0; l < 2; l++) {
+      for (size_t j = common_block_count; j < lanes[l].get_block_count(); j++) {
+        auto block = lanes[l].get_block(j);
+        sha256_ni_compress<1>(&states[l], &block);
+      }
+      sha256_ni_final(states[l], lanes[l].get_output());
+    }
+  }
+}
+
+}  // namespace
+#endif
+
 void sha256(Slice data, MutableSlice output) {
-  CHECK(output.size() >= 32);
-  auto result = SHA256(data.ubegin(), data.size(), output.ubegin());
-  CHECK(result == output.ubegin());
+  sha256_batch(&data, &output, 1);
+}
+
+void sha256_batch(const Slice *data, const MutableSlice *output, size_t count) {
+#if TD_HAVE_CPU_DISPATCH
+  if (cpu_has_sha_ni()) {
+    sha256_ni_batch(data, output, count);
+    return;
+  }
+#endif
+  for (size_t i = 0; i < count; i++) {
+    CHECK(output[i].size() >= 32);
+    SHA256_CTX ctx;
+    int err = SHA256_Init(&ctx);
+    LOG_IF(FATAL, err != 1);
+    err = SHA256_Update(&ctx, data[i].ubegin(), data[i].size());
+    LOG_IF(FATAL, err != 1);
+    err = SHA256_Final(output[i].ubegin(), &ctx);
+    LOG_IF(FATAL, err != 1);
+  }
 }
 
 struct Sha256StateImpl {
@@ -466,12 +849,158 @@ void init_openssl_threads() {
 }
 #endif
 
+#if TD_HAVE_CPU_DISPATCH
+namespace {
+
+// Folding of reflected CRCs with carry-less multiplication, see
+// "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction" by Intel.
+// For a fold by d bits the low half of a 128-bit chunk is multiplied by x^(d+63) mod P
+// and the high half by x^(d-1) mod P, both bit-reflected as 64-bit numbers.
+struct CrcFoldConstants {
+  alignas(16) uint64 fold_by_64_bytes[2];
+  alignas(16) uint64 fold_by_16_bytes[2];
+};
+
+const CrcFoldConstants CRC32_FOLD_CONSTANTS = {{0x653d982200000000, 0xcad38e8f00000000},
+                                               {0x65673b4600000000, 0x9ba54c6f00000000}};
+const CrcFoldConstants CRC32C_FOLD_CONSTANTS = {{0x1c19243b00000000, 0x75bba45b00000000},
+                                                {0x3743f7bd00000000, 0x3171d43000000000}};
+const CrcFoldConstants CRC64_FOLD_CONSTANTS = {{0x6ae3efbb9dd441f3, 0x081f6054a7842df4},
+                                               {0xe05dd497ca393ae4, 0xdabe95afc7875f40}};
+
+constexpr size_t CRC_PCLMUL_MIN_SIZE = 64;
+
+TD_TARGET("pclmul") inline __m128i crc_fold_16_bytes(__m128i chunk, __m128i constants) {
+  return _mm_xor_si128(_mm_clmulepi64_si128(chunk, constants, 0x00), _mm_clmulepi64_si128(chunk, constants, 0x11));
+}
+
+// folds data, which size must be a multiple of 16 and at least CRC_PCLMUL_MIN_SIZE, into 16 bytes with the same CRC
+// starting from zero state; crc is the state before the data
+TD_TARGET("pclmul")
+void crc_pclmul_fold(const unsigned char *data, size_t size, uint64 crc, const CrcFoldConstants &constants,
+                     unsigned char result[16]) {
+  auto load = [](const unsigned char *ptr) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr)); };
+
+  __m128i x0 = _mm_xor_si128(load(data), _mm_set_epi64x(0, static_cast<long long>(crc)));
+  __m128i x1 = load(data + 16);
+  __m128i x2 = load(data + 32);
+  __m128i x3 = load(data + 48);
+  data += 64;
+  size -= 64;
+
+  // four independent chains hide latency of the multiplication
+  __m128i k = _mm_load_si128(reinterpret_cast<const __m128i *>(constants.fold_by_64_bytes));
+  while (size >= 64) {
+    x0 = _mm_xor_si128(crc_fold_16_bytes(x0, k), load(data));
+    x1 = _mm_xor_si128(crc_fold_16_bytes(x1, k), load(data + 16));
+    x2 = _mm_xor_si128(crc_fold_16_bytes(x2, k), load(data + 32));
+    x3 = _mm_xor_si128(crc_fold_16_bytes(x3, k), load(data + 48));
+    data += 64;
+    size -= 64;
+  }
+
+  k = _mm_load_si128(reinterpret_cast<const __m128i *>(constants.fold_by_16_bytes));
+  x0 = _mm_xor_si128(crc_fold_16_bytes(x0, k), x1);
+  x0 = _mm_xor_si128(crc_fold_16_bytes(x0, k), x2);
+  x0 = _mm_xor_si128(crc_fold_16_bytes(x0, k), x3);
+  while (size >= 16) {
+    x0 = _mm_xor_si128(crc_fold_16_bytes(x0, k), load(data));
+    data += 16;
+    size -= 16;
+  }
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(result), x0);
+}
+
+}  // namespace
+#endif
+
 #if TD_HAVE_ZLIB
+static uint32 crc32_partial(Slice data, uint32 crc) {
+  // zlib inverts the state before and after processing
+  return ~static_cast<uint32>(::crc32(~crc, data.ubegin(), static_cast<uint32>(data.size())));
+}
+
 uint32 crc32(Slice data) {
-  return static_cast<uint32>(::crc32(0, data.ubegin(), static_cast<uint32>(data.size())));
+  uint32 crc = static_cast<uint32>(-1);
+#if TD_HAVE_CPU_DISPATCH
+  if (data.size() >= CRC_PCLMUL_MIN_SIZE && cpu_has_pclmul()) {
+    unsigned char folded[16];
+    size_t fold_size = data.size() & ~static_cast<size_t>(15);
+    crc_pclmul_fold(data.ubegin(), fold_size, crc, CRC32_FOLD_CONSTANTS, folded);
+    crc = crc32_partial(Slice(folded, 16), 0);
+    data.remove_prefix(fold_size);
+  }
+#endif
+  return crc32_partial(data, crc) ^ static_cast<uint32>(-1);
 }
 #endif
 
+static uint32 crc32c_table_value(uint32 index) {
+  uint32 crc = index;
+  for (int i = 0; i < 8; i++) {
+    crc = (crc >> 1) ^ (0x82f63b78 & (0 - (crc & 1)));
+  }
+  return crc;
+}
+
+static uint32 crc32c_partial(Slice data, uint32 crc) {
+  static const auto crc32c_table = [] {
+    std::array<uint32, 256> table;
+    for (uint32 i = 0; i < 256; i++) {
+      table[i] = crc32c_table_value(i);
+    }
+    return table;
+  }();
+  const char *p = data.begin();
+  for (auto len = data.size(); len > 0; len--) {
+    crc = crc32c_table[(crc ^ *p++) & 0xff] ^ (crc >> 8);
+  }
+  return crc;
+}
+
+#if TD_HAVE_CPU_DISPATCH
+TD_TARGET("sse4.2") static uint32 crc32c_sse42(Slice data, uint32 crc) {
+  const unsigned char *p = data.ubegin();
+  size_t len = data.size();
+#if defined(__x86_64__) || defined(_M_X64)
+  uint64 crc64 = crc;
+  for (; len >= 8; len -= 8, p += 8) {
+    uint64 value;
+    std::memcpy(&value, p, 8);
+    crc64 = _mm_crc32_u64(crc64, value);
+  }
+  crc = static_cast<uint32>(crc64);
+#endif
+  for (; len >= 4; len -= 4, p += 4) {
+    uint32 value;
+    std::memcpy(&value, p, 4);
+    crc = _mm_crc32_u32(crc, value);
+  }
+  for (; len > 0; len--) {
+    crc = _mm_crc32_u8(crc, *p++);
+  }
+  return crc;
+}
+#endif
+
+uint32 crc32c(Slice data) {
+  uint32 crc = static_cast<uint32>(-1);
+#if TD_HAVE_CPU_DISPATCH
+  // CRC32 instruction has latency of 3 cycles, so folding is faster for long inputs
+  if (data.size() >= CRC_PCLMUL_MIN_SIZE && cpu_has_pclmul()) {
+    unsigned char folded[16];
+    size_t fold_size = data.size() & ~static_cast<size_t>(15);
+    crc_pclmul_fold(data.ubegin(), fold_size, crc, CRC32C_FOLD_CONSTANTS, folded);
+    crc = crc32c_partial(Slice(folded, 16), 0);
+    data.remove_prefix(fold_size);
+  }
+  if (cpu_has_sse42()) {
+    return crc32c_sse42(data, crc) ^ static_cast<uint32>(-1);
+  }
+#endif
+  return crc32c_partial(data, crc) ^ static_cast<uint32>(-1);
+}
+
 static const uint64 crc64_table[256] = {
     0x0000000000000000, 0xb32e4cbe03a75f6f, 0xf4843657a840a05b, 0x47aa7ae9abe7ff34, 0x7bd0c384ff8f5e33,
     0xc8fe8f3afc28015c, 0x8f54f5d357cffe68, 0x3c7ab96d5468a107, 0xf7a18709ff1ebc66, 0x448fcbb7fcb9e309,
@@ -535,7 +1064,17 @@ static uint64 crc64_partial(Slice data, uint64 crc) {
 }
 
 uint64 crc64(Slice data) {
-  return crc64_partial(data, static_cast<uint64>(-1)) ^ static_cast<uint64>(-1);
+  uint64 crc = static_cast<uint64>(-1);
+#if TD_HAVE_CPU_DISPATCH
+  if (data.size() >= CRC_PCLMUL_MIN_SIZE && cpu_has_pclmul()) {
+    unsigned char folded[16];
+    size_t fold_size = data.size() & ~static_cast<size_t>(15);
+    crc_pclmul_fold(data.ubegin(), fold_size, crc, CRC64_FOLD_CONSTANTS, folded);
+    crc = crc64_partial(Slice(folded, 16), 0);
+    data.remove_prefix(fold_size);
+  }
+#endif
+  return crc64_partial(data, crc) ^ static_cast<uint64>(-1);
 }
 
 }  // namespace td
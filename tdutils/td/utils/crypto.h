@@ -21,6 +21,18 @@ int pq_factorize(Slice pq_str, string *p_str, string *q_str);
 void aes_ige_encrypt(const UInt256 &aes_key, UInt256 *aes_iv, Slice from, MutableSlice to);
 void aes_ige_decrypt(const UInt256 &aes_key, UInt256 *aes_iv, Slice from, MutableSlice to);
 
+struct AesIgeTask {
+  const UInt256 *aes_key;
+  UInt256 *aes_iv;
+  Slice from;
+  MutableSlice to;
+};
+
+// the same as calling aes_ige_encrypt/aes_ige_decrypt for every task, but with AES-NI
+// IGE chains of different tasks are interleaved, so the CPU isn't waiting for each block to be encrypted
+void aes_ige_encrypt_batch(const AesIgeTask *tasks, size_t task_count);
+void aes_ige_decrypt_batch(const AesIgeTask *tasks, size_t task_count);
+
 void aes_cbc_encrypt(const UInt256 &aes_key, UInt128 *aes_iv, Slice from, MutableSlice to);
 void aes_cbc_decrypt(const UInt256 &aes_key, UInt128 *aes_iv, Slice from, MutableSlice to);
 
@@ -48,6 +60,9 @@ void sha1(Slice data, unsigned char output[20]);
 
 void sha256(Slice data, MutableSlice output);
 
+// the same as calling sha256 for every input, but with SHA extensions pairs of inputs are hashed simultaneously
+void sha256_batch(const Slice *data, const MutableSlice *output, size_t count);
+
 struct Sha256StateImpl;
 
 struct Sha256State {
@@ -74,6 +89,9 @@ void init_openssl_threads();
 uint32 crc32(Slice data);
 #endif
 
+// CRC-32C (Castagnoli), which can be computed with SSE4.2 instructions; prefer it to crc32 in new formats
+uint32 crc32c(Slice data);
+
 uint64 crc64(Slice data);
 
 }  // namespace td
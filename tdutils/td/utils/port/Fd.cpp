@@ -12,6 +12,8 @@
 #include "td/utils/misc.h"
 #include "td/utils/Observer.h"
 
+#include <algorithm>
+
 #if TD_PORT_POSIX
 
 #include <atomic>
@@ -19,6 +21,7 @@
 #include <fcntl.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #endif
@@ -28,13 +31,14 @@
 #include "td/utils/buffer.h"
 #include "td/utils/misc.h"
 
-#include <algorithm>
 #include <cstring>
 
 #endif
 
 namespace td {
 
+constexpr size_t Fd::MAX_IO_SLICES;
+
 #if TD_PORT_POSIX
 
 Fd::InfoSet::InfoSet() {
@@ -292,7 +296,22 @@ Result<size_t> Fd::write_unsafe(Slice slice) {
 Result<size_t> Fd::write(Slice slice) {
   int native_fd = get_native_fd();
   auto write_res = skip_eintr([&] { return ::write(native_fd, slice.begin(), slice.size()); });
-  auto write_errno = errno;
+  return process_write_result(write_res, errno);
+}
+
+Result<size_t> Fd::writev(const Slice *slices, size_t slice_count) {
+  int native_fd = get_native_fd();
+  struct iovec iov[MAX_IO_SLICES];
+  slice_count = std::min(slice_count, MAX_IO_SLICES);
+  for (size_t i = 0; i < slice_count; i++) {
+    iov[i].iov_base = const_cast<char *>(slices[i].begin());
+    iov[i].iov_len = slices[i].size();
+  }
+  auto write_res = skip_eintr([&] { return ::writev(native_fd, iov, narrow_cast<int>(slice_count)); });
+  return process_write_result(write_res, errno);
+}
+
+Result<size_t> Fd::process_write_result(int64 write_res, int write_errno) {
   if (write_res >= 0) {
     return narrow_cast<size_t>(write_res);
   }
@@ -306,7 +325,7 @@ Result<size_t> Fd::write(Slice slice) {
     return 0;
   }
 
-  auto error = Status::PosixError(write_errno, PSLICE("Write to [fd=%d] has failed", native_fd));
+  auto error = Status::PosixError(write_errno, PSLICE("Write to [fd=%d] has failed", get_native_fd()));
   switch (write_errno) {
     case EBADF:
     case ENXIO:
@@ -335,7 +354,23 @@ Result<size_t> Fd::read(MutableSlice slice) {
   int native_fd = get_native_fd();
   CHECK(slice.size() > 0);
   auto read_res = skip_eintr([&] { return ::read(native_fd, slice.begin(), slice.size()); });
-  auto read_errno = errno;
+  return process_read_result(read_res, errno);
+}
+
+Result<size_t> Fd::readv(const MutableSlice *slices, size_t slice_count) {
+  int native_fd = get_native_fd();
+  CHECK(slice_count > 0);
+  struct iovec iov[MAX_IO_SLICES];
+  slice_count = std::min(slice_count, MAX_IO_SLICES);
+  for (size_t i = 0; i < slice_count; i++) {
+    iov[i].iov_base = slices[i].begin();
+    iov[i].iov_len = slices[i].size();
+  }
+  auto read_res = skip_eintr([&] { return ::readv(native_fd, iov, narrow_cast<int>(slice_count)); });
+  return process_read_result(read_res, errno);
+}
+
+Result<size_t> Fd::process_read_result(int64 read_res, int read_errno) {
   if (read_res >= 0) {
     if (read_res == 0) {
       errno = 0;
@@ -352,7 +387,7 @@ Result<size_t> Fd::read(MutableSlice slice) {
     clear_flags(Read);
     return 0;
   }
-  auto error = Status::PosixError(read_errno, PSLICE("Read from [fd=%d] has failed", native_fd));
+  auto error = Status::PosixError(read_errno, PSLICE("Read from [fd=%d] has failed", get_native_fd()));
   switch (read_errno) {
     case EISDIR:
     case EBADF:
@@ -941,6 +976,30 @@ Result<size_t> Fd::write(Slice slice) {
   return impl_->write(slice);
 }
 
+Result<size_t> Fd::writev(const Slice *slices, size_t slice_count) {
+  size_t result = 0;
+  for (size_t i = 0; i < slice_count && i < MAX_IO_SLICES; i++) {
+    TRY_RESULT(written, write(slices[i]));
+    result += written;
+    if (written != slices[i].size()) {
+      break;
+    }
+  }
+  return result;
+}
+
+Result<size_t> Fd::readv(const MutableSlice *slices, size_t slice_count) {
+  size_t result = 0;
+  for (size_t i = 0; i < slice_count && i < MAX_IO_SLICES; i++) {
+    TRY_RESULT(read_size, read(slices[i]));
+    result += read_size;
+    if (read_size != slices[i].size()) {
+      break;
+    }
+  }
+  return result;
+}
+
 bool Fd::empty() const {
   return !impl_;
 }
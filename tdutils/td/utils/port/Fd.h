@@ -98,6 +98,11 @@ class Fd {
   Result<size_t> write(Slice slice) TD_WARN_UNUSED_RESULT;
   Result<size_t> read(MutableSlice slice) TD_WARN_UNUSED_RESULT;
 
+  // scatter/gather versions of write and read; at most MAX_IO_SLICES slices are processed at once
+  static constexpr size_t MAX_IO_SLICES = 16;
+  Result<size_t> writev(const Slice *slices, size_t slice_count) TD_WARN_UNUSED_RESULT;
+  Result<size_t> readv(const MutableSlice *slices, size_t slice_count) TD_WARN_UNUSED_RESULT;
+
   Status set_is_blocking(bool is_blocking);
 
 #if TD_PORT_POSIX
@@ -156,6 +161,9 @@ class Fd {
   void close_ref();
   void close_own();
 
+  Result<size_t> process_write_result(int64 write_res, int write_errno);
+  Result<size_t> process_read_result(int64 read_res, int read_errno);
+
   int fd_ = -1;
 #endif
 #if TD_PORT_WINDOWS
@@ -16,6 +16,7 @@
 #include "td/utils/port/sleep.h"
 #include "td/utils/StringBuilder.h"
 
+#include <algorithm>
 #include <cstring>
 
 #if TD_PORT_POSIX
@@ -193,12 +194,37 @@ Result<size_t> FileFd::write(Slice slice) {
   CHECK(!fd_.empty());
   int native_fd = get_native_fd();
   auto write_res = skip_eintr([&] { return ::write(native_fd, slice.begin(), slice.size()); });
+  return process_write_result(write_res, errno, "Write");
+#elif TD_PORT_WINDOWS
+  return fd_.write(slice);
+#endif
+}
+
+Result<size_t> FileFd::writev(const Slice *slices, size_t slice_count) {
+#if TD_PORT_POSIX
+  CHECK(!fd_.empty());
+  int native_fd = get_native_fd();
+  struct iovec iov[Fd::MAX_IO_SLICES];
+  slice_count = std::min(slice_count, Fd::MAX_IO_SLICES);
+  for (size_t i = 0; i < slice_count; i++) {
+    iov[i].iov_base = const_cast<char *>(slices[i].begin());
+    iov[i].iov_len = slices[i].size();
+  }
+  auto write_res = skip_eintr([&] { return ::writev(native_fd, iov, narrow_cast<int>(slice_count)); });
+  return process_write_result(write_res, errno, "Writev");
+#elif TD_PORT_WINDOWS
+  return fd_.writev(slices, slice_count);
+#endif
+}
+
+#if TD_PORT_POSIX
+Result<size_t> FileFd::process_write_result(int64 write_res, int write_errno, Slice operation) {
   if (write_res >= 0) {
     return narrow_cast<size_t>(write_res);
   }
 
-  auto write_errno = errno;
-  auto error = Status::PosixError(write_errno, PSLICE() << "Write to [fd = " << native_fd << "] has failed");
+  auto error =
+      Status::PosixError(write_errno, PSLICE() << operation << " to [fd = " << get_native_fd() << "] has failed");
   if (write_errno != EAGAIN
 #if EAGAIN != EWOULDBLOCK
       && write_errno != EWOULDBLOCK
@@ -207,10 +233,8 @@ Result<size_t> FileFd::write(Slice slice) {
     LOG(ERROR) << error;
   }
   return std::move(error);
-#elif TD_PORT_WINDOWS
-  return fd_.write(slice);
-#endif
 }
+#endif
 
 Result<size_t> FileFd::read(MutableSlice slice) {
 #if TD_PORT_POSIX
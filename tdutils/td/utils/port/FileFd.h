@@ -28,6 +28,7 @@ class FileFd {
   static Result<FileFd> open(CSlice filepath, int32 flags, int32 mode = 0600) TD_WARN_UNUSED_RESULT;
 
   Result<size_t> write(Slice slice) TD_WARN_UNUSED_RESULT;
+  Result<size_t> writev(const Slice *slices, size_t slice_count) TD_WARN_UNUSED_RESULT;
   Result<size_t> read(MutableSlice slice) TD_WARN_UNUSED_RESULT;
 
   Result<size_t> pwrite(Slice slice, int64 offset) TD_WARN_UNUSED_RESULT;
@@ -58,6 +59,10 @@ class FileFd {
 
  private:
   Fd fd_;
+
+#if TD_PORT_POSIX
+  Result<size_t> process_write_result(int64 write_res, int write_errno, Slice operation);
+#endif
 };
 
 }  // namespace td
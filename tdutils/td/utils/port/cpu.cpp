@@ -0,0 +1,97 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2018
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/utils/port/cpu.h"
+
+#if TD_HAVE_CPU_DISPATCH
+#if TD_MSVC
+#include <immintrin.h>
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace td {
+
+namespace {
+
+struct CpuFeatures {
+  bool avx2 = false;
+  bool aes_ni = false;
+  bool sha_ni = false;
+  bool sse42 = false;
+  bool pclmul = false;
+
+  CpuFeatures() {
+#if TD_HAVE_CPU_DISPATCH
+#if TD_MSVC
+    int info[4];
+    __cpuid(info, 0);
+    int max_leaf = info[0];
+    __cpuid(info, 1);
+    bool has_avx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0;  // OSXSAVE and AVX
+    bool has_sse41 = (info[2] & (1 << 19)) != 0;
+    aes_ni = (info[2] & (1 << 25)) != 0;
+    sse42 = (info[2] & (1 << 20)) != 0;
+    pclmul = (info[2] & (1 << 1)) != 0;
+    if (max_leaf >= 7) {
+      __cpuidex(info, 7, 0);
+      // XMM and YMM registers must be saved by the OS
+      avx2 = has_avx && (_xgetbv(0) & 6) == 6 && (info[1] & (1 << 5)) != 0;
+      sha_ni = has_sse41 && (info[1] & (1 << 29)) != 0;
+    }
+#else
+    __builtin_cpu_init();
+    avx2 = __builtin_cpu_supports("avx2") != 0;
+
+    unsigned int eax;
+    unsigned int ebx;
+    unsigned int ecx;
+    unsigned int edx;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) != 0) {
+      bool has_sse41 = (ecx & (1 << 19)) != 0;
+      aes_ni = (ecx & (1 << 25)) != 0;
+      sse42 = (ecx & (1 << 20)) != 0;
+      pclmul = (ecx & (1 << 1)) != 0;
+      if (__get_cpuid_max(0, nullptr) >= 7) {
+        __cpuid_count(7, 0, eax, ebx, ecx, edx);
+        sha_ni = has_sse41 && (ebx & (1 << 29)) != 0;
+      }
+    }
+#endif
+#endif
+  }
+};
+
+const CpuFeatures &get_cpu_features() {
+  static const CpuFeatures features;
+  return features;
+}
+
+}  // namespace
+
+bool cpu_has_avx2() {
+  return get_cpu_features().avx2;
+}
+
+bool cpu_has_aes_ni() {
+  return get_cpu_features().aes_ni;
+}
+
+bool cpu_has_sha_ni() {
+  return get_cpu_features().sha_ni;
+}
+
+bool cpu_has_sse42() {
+  return get_cpu_features().sse42;
+}
+
+bool cpu_has_pclmul() {
+  return get_cpu_features().pclmul;
+}
+
+}  // namespace td
@@ -0,0 +1,60 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2018
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/port/platform.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define TD_X86 1
+#endif
+
+// SSE2 is a part of x86-64, so it can be used without runtime checks
+#if TD_X86 && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define TD_HAVE_SSE2 1
+#endif
+
+#if TD_HAVE_SSE2
+#include <emmintrin.h>
+#endif
+
+// functions using instructions from newer extensions must be marked with TD_TARGET
+// and can be called only after a successful runtime check
+#if TD_X86 && (TD_GCC || TD_CLANG)
+#define TD_HAVE_CPU_DISPATCH 1
+#define TD_TARGET(features) __attribute__((target(features)))
+#elif TD_X86 && TD_MSVC
+#define TD_HAVE_CPU_DISPATCH 1
+#define TD_TARGET(features)
+#endif
+
+namespace td {
+
+// returns true if AVX2 instructions are supported by both the CPU and the OS
+bool cpu_has_avx2();
+
+// returns true if AES-NI instructions are supported
+bool cpu_has_aes_ni();
+
+// returns true if SHA extensions and SSE4.1 instructions are supported
+bool cpu_has_sha_ni();
+
+// returns true if SSE4.2 instructions, including CRC32, are supported
+bool cpu_has_sse42();
+
+// returns true if PCLMULQDQ instruction is supported
+bool cpu_has_pclmul();
+
+// must be called on each iteration of a busy-wait loop to save power and to not slow down the other hyper-thread
+inline void cpu_relax() {
+#if TD_HAVE_SSE2
+  _mm_pause();
+#elif (TD_GCC || TD_CLANG) && defined(__aarch64__)
+  __asm__ __volatile__("yield");
+#endif
+}
+
+}  // namespace td
@@ -21,6 +21,7 @@
 
 #include <pthread.h>
 #include <sched.h>
+#include <unistd.h>
 
 namespace td {
 namespace detail {
@@ -53,6 +54,12 @@ class ThreadPthread {
   }
 
   static unsigned hardware_concurrency() {
+#if defined(_SC_NPROCESSORS_ONLN)
+    auto res = sysconf(_SC_NPROCESSORS_ONLN);
+    if (res > 0) {
+      return static_cast<unsigned>(res);
+    }
+#endif
     return 8;
   }
 
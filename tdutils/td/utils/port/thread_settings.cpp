@@ -0,0 +1,130 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2018
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/utils/port/thread_settings.h"
+
+#include "td/utils/port/config.h"
+
+#include "td/utils/logging.h"
+
+#if TD_LINUX || TD_ANDROID
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#if TD_DARWIN
+#include <pthread.h>
+#endif
+
+#include <cerrno>
+
+namespace td {
+
+Status set_current_thread_name(Slice name) {
+#if TD_LINUX || TD_ANDROID
+  auto err = pthread_setname_np(pthread_self(), name.substr(0, 15).str().c_str());
+  if (err != 0) {
+    return Status::PosixError(err, "pthread_setname_np failed");
+  }
+  return Status::OK();
+#elif TD_DARWIN
+  auto err = pthread_setname_np(name.str().c_str());
+  if (err != 0) {
+    return Status::PosixError(err, "pthread_setname_np failed");
+  }
+  return Status::OK();
+#else
+  return Status::Error("Thread names aren't supported");
+#endif
+}
+
+Status set_current_thread_affinity(const vector<int32> &cpus) {
+  if (cpus.empty()) {
+    return Status::Error("CPU list must be non-empty");
+  }
+#if TD_LINUX || TD_ANDROID
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  for (auto cpu : cpus) {
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+      return Status::Error(PSLICE() << "Wrong CPU " << cpu);
+    }
+    CPU_SET(cpu, &cpu_set);
+  }
+  if (sched_setaffinity(0, sizeof(cpu_set), &cpu_set) != 0) {
+    return OS_ERROR("sched_setaffinity failed");
+  }
+  return Status::OK();
+#elif TD_WINDOWS
+  DWORD_PTR mask = 0;
+  for (auto cpu : cpus) {
+    if (cpu < 0 || cpu >= static_cast<int32>(sizeof(DWORD_PTR) * 8)) {
+      return Status::Error(PSLICE() << "Wrong CPU " << cpu);
+    }
+    mask |= static_cast<DWORD_PTR>(1) << cpu;
+  }
+  if (SetThreadAffinityMask(GetCurrentThread(), mask) == 0) {
+    return OS_ERROR("SetThreadAffinityMask failed");
+  }
+  return Status::OK();
+#else
+  return Status::Error("Thread affinity isn't supported");
+#endif
+}
+
+Result<vector<int32>> get_current_thread_affinity() {
+#if TD_LINUX || TD_ANDROID
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  if (sched_getaffinity(0, sizeof(cpu_set), &cpu_set) != 0) {
+    return OS_ERROR("sched_getaffinity failed");
+  }
+  vector<int32> result;
+  for (int32 cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+    if (CPU_ISSET(cpu, &cpu_set)) {
+      result.push_back(cpu);
+    }
+  }
+  return std::move(result);
+#else
+  return Status::Error("Thread affinity isn't supported");
+#endif
+}
+
+Status set_current_thread_priority(int32 priority) {
+  if (priority < -20 || priority > 19) {
+    return Status::Error(PSLICE() << "Wrong thread priority " << priority);
+  }
+#if TD_LINUX || TD_ANDROID
+  // on Linux nice value is a per-thread attribute
+  auto tid = static_cast<id_t>(syscall(SYS_gettid));
+  if (setpriority(PRIO_PROCESS, tid, priority) != 0) {
+    return OS_ERROR("setpriority failed");
+  }
+  return Status::OK();
+#elif TD_WINDOWS
+  int thread_priority = THREAD_PRIORITY_NORMAL;
+  if (priority <= -10) {
+    thread_priority = THREAD_PRIORITY_HIGHEST;
+  } else if (priority < 0) {
+    thread_priority = THREAD_PRIORITY_ABOVE_NORMAL;
+  } else if (priority >= 10) {
+    thread_priority = THREAD_PRIORITY_LOWEST;
+  } else if (priority > 0) {
+    thread_priority = THREAD_PRIORITY_BELOW_NORMAL;
+  }
+  if (SetThreadPriority(GetCurrentThread(), thread_priority) == 0) {
+    return OS_ERROR("SetThreadPriority failed");
+  }
+  return Status::OK();
+#else
+  return Status::Error("Thread priority isn't supported");
+#endif
+}
+
+}  // namespace td
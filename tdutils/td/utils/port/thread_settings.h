@@ -0,0 +1,28 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2018
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/common.h"
+#include "td/utils/Slice.h"
+#include "td/utils/Status.h"
+
+namespace td {
+
+// all functions change settings of the calling thread and return an error if the setting isn't supported
+
+// the name can be truncated, for example, to 15 characters on Linux
+Status set_current_thread_name(Slice name) TD_WARN_UNUSED_RESULT;
+
+Status set_current_thread_affinity(const vector<int32> &cpus) TD_WARN_UNUSED_RESULT;
+
+Result<vector<int32>> get_current_thread_affinity() TD_WARN_UNUSED_RESULT;
+
+// priority is a hint in the usual nice scale from -20 (the highest) to 19 (the lowest);
+// real-time scheduling is never used
+Status set_current_thread_priority(int32 priority) TD_WARN_UNUSED_RESULT;
+
+}  // namespace td
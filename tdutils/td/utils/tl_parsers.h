@@ -15,13 +15,15 @@
 #include "td/utils/Status.h"
 #include "td/utils/utf8.h"
 
-#include <array>
 #include <cstring>
 #include <limits>
 #include <string>
 
 namespace td {
 
+// Reads data in place, so the slice must be kept alive while the parser is used.
+// The data doesn't need to be aligned, but strings and bytes can be returned as views of the parsed data
+// only if it is aligned.
 class TlParser {
   const unsigned char *data = nullptr;
   size_t data_len = 0;
@@ -29,10 +31,6 @@ class TlParser {
   size_t error_pos = std::numeric_limits<size_t>::max();
   std::string error;
 
-  unique_ptr<int32[]> data_buf;
-  static constexpr size_t SMALL_DATA_ARRAY_SIZE = 6;
-  std::array<int32, SMALL_DATA_ARRAY_SIZE> small_data_array;
-
   static const unsigned char empty_data[sizeof(UInt256)];
 
  public:
@@ -43,20 +41,7 @@ class TlParser {
     }
 
     data_len = left_len = slice.size();
-    if (is_aligned_pointer<4>(slice.begin())) {
-      data = slice.ubegin();
-    } else {
-      int32 *buf;
-      if (data_len <= small_data_array.size() * sizeof(int32)) {
-        buf = &small_data_array[0];
-      } else {
-        LOG(ERROR) << "Unexpected big unaligned data pointer of length " << slice.size() << " at " << slice.begin();
-        data_buf = make_unique<int32[]>(data_len / sizeof(int32));
-        buf = data_buf.get();
-      }
-      std::memcpy(static_cast<void *>(buf), static_cast<const void *>(slice.begin()), slice.size());
-      data = reinterpret_cast<unsigned char *>(buf);
-    }
+    data = slice.ubegin();
   }
 
   TlParser(const TlParser &other) = delete;
@@ -91,7 +76,8 @@ class TlParser {
   }
 
   int32 fetch_int_unsafe() {
-    int32 result = *reinterpret_cast<const int32 *>(data);
+    int32 result;
+    std::memcpy(reinterpret_cast<unsigned char *>(&result), data, sizeof(int32));
     data += sizeof(int32);
     return result;
   }
@@ -221,6 +207,8 @@ class TlBufferParser : public TlParser {
  private:
   const BufferSlice *parent_;
 
+  // returns a view of the parent buffer if possible; unaligned data is copied, because users of bytes fields
+  // expect them to be aligned
   BufferSlice as_buffer_slice(Slice slice) {
     if (is_aligned_pointer<4>(slice.data())) {
       return parent_->from_slice(slice);
@@ -8,6 +8,7 @@
 
 #include <cstring>
 
+#include "td/utils/buffer.h"
 #include "td/utils/int_types.h"
 #include "td/utils/logging.h"
 #include "td/utils/misc.h"
@@ -131,6 +132,119 @@ class TlStorerCalcLength {
   }
 };
 
+// stores data in one pass to a buffer, which grows as needed, so the length doesn't need to be calculated beforehand
+class TlStorerToBufferSlice {
+  BufferSlice buffer;
+  char *begin = nullptr;
+  char *buf = nullptr;
+  char *end = nullptr;
+
+  static constexpr size_t MIN_CAPACITY = 64;
+
+  void prepare(size_t size) {
+    if (unlikely(static_cast<size_t>(end - buf) < size)) {
+      grow(size);
+    }
+  }
+
+  void grow(size_t size) {
+    size_t used = buf - begin;
+    size_t capacity = static_cast<size_t>(end - begin) * 2;
+    if (capacity < MIN_CAPACITY) {
+      capacity = MIN_CAPACITY;
+    }
+    while (capacity < used + size) {
+      capacity *= 2;
+    }
+    BufferSlice new_buffer(capacity);
+    if (used != 0) {
+      std::memcpy(new_buffer.as_slice().begin(), begin, used);
+    }
+    buffer = std::move(new_buffer);
+    begin = buffer.as_slice().begin();
+    CHECK(is_aligned_pointer<4>(begin));
+    buf = begin + used;
+    end = begin + capacity;
+  }
+
+ public:
+  // the buffer is allocated once if the stored data isn't longer than capacity_hint
+  explicit TlStorerToBufferSlice(size_t capacity_hint = 0) {
+    if (capacity_hint != 0) {
+      grow(capacity_hint);
+    }
+  }
+
+  TlStorerToBufferSlice(const TlStorerToBufferSlice &other) = delete;
+  TlStorerToBufferSlice &operator=(const TlStorerToBufferSlice &other) = delete;
+
+  template <class T>
+  void store_binary(const T &x) {
+    prepare(sizeof(T));
+    std::memcpy(buf, reinterpret_cast<const unsigned char *>(&x), sizeof(T));
+    buf += sizeof(T);
+  }
+
+  void store_int(int32 x) {
+    store_binary<int32>(x);
+  }
+
+  void store_long(int64 x) {
+    store_binary<int64>(x);
+  }
+
+  void store_slice(Slice slice) {
+    prepare(slice.size());
+    std::memcpy(buf, slice.begin(), slice.size());
+    buf += slice.size();
+  }
+  void store_storer(const Storer &storer) {
+    prepare(storer.size());
+    size_t size = storer.store(reinterpret_cast<unsigned char *>(buf));
+    buf += size;
+  }
+
+  template <class T>
+  void store_string(const T &str) {
+    size_t len = str.size();
+    prepare(len + 7);
+    if (len < 254) {
+      *buf++ = static_cast<char>(len);
+      len++;
+    } else if (len < (1 << 24)) {
+      *buf++ = static_cast<char>(static_cast<unsigned char>(254));
+      *buf++ = static_cast<char>(len & 255);
+      *buf++ = static_cast<char>((len >> 8) & 255);
+      *buf++ = static_cast<char>(len >> 16);
+    } else {
+      LOG(FATAL) << "String size " << len << " is too big to be stored";
+    }
+    std::memcpy(buf, str.data(), str.size());
+    buf += str.size();
+
+    switch (len & 3) {
+      case 1:
+        *buf++ = '\0';
+      // fallthrough
+      case 2:
+        *buf++ = '\0';
+      // fallthrough
+      case 3:
+        *buf++ = '\0';
+    }
+  }
+
+  size_t get_length() const {
+    return buf - begin;
+  }
+
+  BufferSlice move_as_buffer_slice() {
+    buffer.truncate(get_length());
+    begin = buf = end = nullptr;
+    return std::move(buffer);
+  }
+};
+
 class TlStorerToString {
   std::string result;
   int shift = 0;
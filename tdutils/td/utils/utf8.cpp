@@ -7,11 +7,21 @@
 #include "td/utils/utf8.h"
 
 #include "td/utils/logging.h"  // for UNREACHABLE
+#include "td/utils/port/cpu.h"
 #include "td/utils/unicode.h"
 
+#if TD_HAVE_CPU_DISPATCH
+#include <immintrin.h>
+#elif TD_HAVE_SSE2
+#include <emmintrin.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+
 namespace td {
 
-bool check_utf8(CSlice str) {
+static bool check_utf8_scalar(CSlice str) {
   const char *data = str.data();
   const char *data_end = data + str.size();
   do {
@@ -20,6 +30,13 @@ bool check_utf8(CSlice str) {
       if (data == data_end + 1) {
         return true;
       }
+#if TD_HAVE_SSE2
+      // skip blocks of ASCII characters
+      while (data_end - data >= 16 &&
+             _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data))) == 0) {
+        data += 16;
+      }
+#endif
       continue;
     }
 
@@ -61,6 +78,229 @@ bool check_utf8(CSlice str) {
   return false;
 }
 
+#if TD_HAVE_CPU_DISPATCH
+// Validation algorithm by John Keiser and Daniel Lemire, "Validating UTF-8 In Less Than One Instruction Per Byte".
+// Every error in a pair of consecutive bytes is detected by looking up both nibbles of the first byte and the high
+// nibble of the second byte in tables of error bits; the tables have a common set bit only if the pair is invalid.
+// The only exception are pairs of continuation bytes, whose validity depends on the preceding lead byte.
+namespace {
+constexpr uint8 TOO_SHORT = 1 << 0;  // lead byte or ASCII after a lead byte
+constexpr uint8 TOO_LONG = 1 << 1;   // continuation byte after ASCII
+constexpr uint8 OVERLONG_3 = 1 << 2;
+constexpr uint8 TOO_LARGE = 1 << 3;
+constexpr uint8 SURROGATE = 1 << 4;
+constexpr uint8 OVERLONG_2 = 1 << 5;
+constexpr uint8 TOO_LARGE_1000 = 1 << 6;
+constexpr uint8 OVERLONG_4 = 1 << 6;
+constexpr uint8 TWO_CONTS = 1 << 7;  // two continuation bytes
+constexpr uint8 CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+alignas(16) const uint8 BYTE_1_HIGH_TABLE[16] = {
+    TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,  // 0___
+    TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,                                      // 10__
+    TOO_SHORT | OVERLONG_2,                                                          // 1100
+    TOO_SHORT,                                                                       // 1101
+    TOO_SHORT | OVERLONG_3 | SURROGATE,                                              // 1110
+    TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4                              // 1111
+};
+
+alignas(16) const uint8 BYTE_1_LOW_TABLE[16] = {
+    CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,  // 0000
+    CARRY | OVERLONG_2,                            // 0001
+    CARRY,
+    CARRY,
+    CARRY | TOO_LARGE,  // 0100
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,  // 1101
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000};
+
+alignas(16) const uint8 BYTE_2_HIGH_TABLE[16] = {
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,  // 0___
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,            // 1000
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,                              // 1001
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,                               // 1010
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,                               // 1011
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT                                               // 11__
+};
+}  // namespace
+
+TD_TARGET("avx2") static bool check_utf8_avx2(const unsigned char *data, size_t size) {
+  // lambdas can't be used here, because they don't inherit the target attribute
+  const __m256i byte_1_high_table =
+      _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i *>(BYTE_1_HIGH_TABLE)));
+  const __m256i byte_1_low_table =
+      _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i *>(BYTE_1_LOW_TABLE)));
+  const __m256i byte_2_high_table =
+      _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i *>(BYTE_2_HIGH_TABLE)));
+  const __m256i low_nibble_mask = _mm256_set1_epi8(0x0F);
+  const __m256i third_byte_threshold = _mm256_set1_epi8(static_cast<char>(0xE0 - 0x80));
+  const __m256i fourth_byte_threshold = _mm256_set1_epi8(static_cast<char>(0xF0 - 0x80));
+  const __m256i high_bit = _mm256_set1_epi8(static_cast<char>(0x80));
+  // the last 3 bytes of a block must not begin a character longer than the rest of the block
+  const __m256i incomplete_threshold =
+      _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                       -1, -1, -1, -1, -1, static_cast<char>(0xF0 - 1), static_cast<char>(0xE0 - 1),
+                       static_cast<char>(0xC0 - 1));
+
+  __m256i error = _mm256_setzero_si256();
+  __m256i prev_input = _mm256_setzero_si256();
+  __m256i prev_incomplete = _mm256_setzero_si256();
+  alignas(32) unsigned char last_block[32];
+  while (size > 0) {
+    __m256i input;
+    if (size >= 32) {
+      input = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data));
+      data += 32;
+      size -= 32;
+    } else {
+      std::memset(last_block, 0, sizeof(last_block));  // pad with ASCII zeros
+      std::memcpy(last_block, data, size);
+      input = _mm256_load_si256(reinterpret_cast<const __m256i *>(last_block));
+      size = 0;
+    }
+
+    if (_mm256_movemask_epi8(input) == 0) {
+      error = _mm256_or_si256(error, prev_incomplete);
+      prev_incomplete = _mm256_setzero_si256();
+    } else {
+      // prevN[i] == input[i - N], where bytes before the block are taken from the previous block
+      __m256i prev_shifted = _mm256_permute2x128_si256(prev_input, input, 0x21);
+      __m256i prev1 = _mm256_alignr_epi8(input, prev_shifted, 15);
+      __m256i prev2 = _mm256_alignr_epi8(input, prev_shifted, 14);
+      __m256i prev3 = _mm256_alignr_epi8(input, prev_shifted, 13);
+
+      __m256i byte_1_high =
+          _mm256_shuffle_epi8(byte_1_high_table, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), low_nibble_mask));
+      __m256i byte_1_low = _mm256_shuffle_epi8(byte_1_low_table, _mm256_and_si256(prev1, low_nibble_mask));
+      __m256i byte_2_high =
+          _mm256_shuffle_epi8(byte_2_high_table, _mm256_and_si256(_mm256_srli_epi16(input, 4), low_nibble_mask));
+      __m256i special_cases = _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+
+      // the third and the fourth bytes of a character must be continuation bytes and are the only allowed TWO_CONTS
+      __m256i is_third_byte = _mm256_subs_epu8(prev2, third_byte_threshold);
+      __m256i is_fourth_byte = _mm256_subs_epu8(prev3, fourth_byte_threshold);
+      __m256i must_be_continuation = _mm256_and_si256(_mm256_or_si256(is_third_byte, is_fourth_byte), high_bit);
+      error = _mm256_or_si256(error, _mm256_xor_si256(must_be_continuation, special_cases));
+      prev_incomplete = _mm256_subs_epu8(input, incomplete_threshold);
+    }
+    prev_input = input;
+  }
+  error = _mm256_or_si256(error, prev_incomplete);
+  return _mm256_testz_si256(error, error) != 0;
+}
+#endif
+
+bool check_utf8(CSlice str) {
+#if TD_HAVE_CPU_DISPATCH
+  if (str.size() >= 32 && cpu_has_avx2()) {
+    return check_utf8_avx2(str.ubegin(), str.size());
+  }
+#endif
+  return check_utf8_scalar(str);
+}
+
+// counts first code units of characters and, if IsUtf16, first code units of 4-byte characters,
+// which are encoded as surrogate pairs in UTF-16
+template <bool IsUtf16>
+static size_t utf8_length_scalar(const unsigned char *data, size_t size) {
+  size_t result = 0;
+  for (size_t i = 0; i < size; i++) {
+    auto c = data[i];
+    result += is_utf8_character_first_code_unit(c);
+    if (IsUtf16) {
+      result += c >= 0xf0;
+    }
+  }
+  return result;
+}
+
+#if TD_HAVE_SSE2
+template <bool IsUtf16>
+static size_t utf8_length_sse2(const unsigned char *data, size_t size) {
+  // signed c > 0xBF <=> c != 10xxxxxx
+  const __m128i first_code_unit_threshold = _mm_set1_epi8(static_cast<char>(0xBF));
+  const __m128i surrogate_threshold = _mm_set1_epi8(static_cast<char>(0xF0));
+  const size_t MAX_BLOCK_COUNT = IsUtf16 ? 127 : 255;  // maximum number of iterations without 8-bit counter overflow
+
+  size_t result = 0;
+  while (size >= 16) {
+    size_t block_count = std::min(size / 16, MAX_BLOCK_COUNT);
+    __m128i counts = _mm_setzero_si128();
+    for (size_t i = 0; i < block_count; i++) {
+      __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+      counts = _mm_sub_epi8(counts, _mm_cmpgt_epi8(input, first_code_unit_threshold));
+      if (IsUtf16) {
+        // unsigned c >= 0xF0 <=> max(c, 0xF0) == c
+        counts = _mm_sub_epi8(counts, _mm_cmpeq_epi8(_mm_max_epu8(input, surrogate_threshold), input));
+      }
+      data += 16;
+    }
+    size -= block_count * 16;
+    __m128i sums = _mm_sad_epu8(counts, _mm_setzero_si128());
+    result += static_cast<size_t>(_mm_cvtsi128_si32(sums)) + static_cast<size_t>(_mm_extract_epi16(sums, 4));
+  }
+  return result + utf8_length_scalar<IsUtf16>(data, size);
+}
+#endif
+
+#if TD_HAVE_CPU_DISPATCH
+template <bool IsUtf16>
+TD_TARGET("avx2") static size_t utf8_length_avx2(const unsigned char *data, size_t size) {
+  const __m256i first_code_unit_threshold = _mm256_set1_epi8(static_cast<char>(0xBF));
+  const __m256i surrogate_threshold = _mm256_set1_epi8(static_cast<char>(0xF0));
+  const size_t MAX_BLOCK_COUNT = IsUtf16 ? 127 : 255;
+
+  size_t result = 0;
+  while (size >= 32) {
+    size_t block_count = std::min(size / 32, MAX_BLOCK_COUNT);
+    __m256i counts = _mm256_setzero_si256();
+    for (size_t i = 0; i < block_count; i++) {
+      __m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data));
+      counts = _mm256_sub_epi8(counts, _mm256_cmpgt_epi8(input, first_code_unit_threshold));
+      if (IsUtf16) {
+        counts = _mm256_sub_epi8(counts, _mm256_cmpeq_epi8(_mm256_max_epu8(input, surrogate_threshold), input));
+      }
+      data += 32;
+    }
+    size -= block_count * 32;
+    __m256i sums = _mm256_sad_epu8(counts, _mm256_setzero_si256());
+    __m128i sums128 = _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+    result += static_cast<size_t>(_mm_cvtsi128_si32(sums128)) + static_cast<size_t>(_mm_extract_epi16(sums128, 4));
+  }
+  return result + utf8_length_scalar<IsUtf16>(data, size);
+}
+#endif
+
+template <bool IsUtf16>
+static size_t utf8_length_impl(Slice str) {
+#if TD_HAVE_CPU_DISPATCH
+  if (str.size() >= 64 && cpu_has_avx2()) {
+    return utf8_length_avx2<IsUtf16>(str.ubegin(), str.size());
+  }
+#endif
+#if TD_HAVE_SSE2
+  return utf8_length_sse2<IsUtf16>(str.ubegin(), str.size());
+#else
+  return utf8_length_scalar<IsUtf16>(str.ubegin(), str.size());
+#endif
+}
+
+size_t utf8_length(Slice str) {
+  return utf8_length_impl<false>(str);
+}
+
+size_t utf8_utf16_length(Slice str) {
+  return utf8_length_impl<true>(str);
+}
+
 void append_utf8_character(string &str, uint32 ch) {
   if (ch <= 0x7f) {
     str.push_back(static_cast<char>(ch));
@@ -0,0 +1,110 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2018
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/utils/common.h"
+#include "td/utils/FlatHashMap.h"
+#include "td/utils/FlatHashSet.h"
+#include "td/utils/logging.h"
+#include "td/utils/Random.h"
+#include "td/utils/tests.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+template <class MapT>
+static void test_flat_hash_map() {
+  MapT map;
+  std::unordered_map<td::int64, td::int32> expected;
+  for (int i = 0; i < 100000; i++) {
+    // keys with zero low bits check that weak hashes are randomized
+    auto key = static_cast<td::int64>(td::Random::fast(1, 5000)) << 20;
+    auto value = td::Random::fast(0, 1000000);
+    switch (td::Random::fast(0, 4)) {
+      case 0:
+        ASSERT_EQ(expected.erase(key), map.erase(key));
+        break;
+      case 1: {
+        auto it = map.find(key);
+        if (it != map.end()) {
+          ASSERT_EQ(key, it->first);
+          map.erase(it);
+          expected.erase(key);
+        }
+        break;
+      }
+      case 2:
+        ASSERT_EQ(expected.emplace(key, value).second, map.emplace(key, value).second);
+        break;
+      default:
+        expected[key] = value;
+        map[key] = value;
+        break;
+    }
+    auto it = map.find(key);
+    ASSERT_EQ(expected.count(key), map.count(key));
+    if (it != map.end()) {
+      ASSERT_EQ(expected[key], it->second);
+    }
+    ASSERT_EQ(expected.size(), map.size());
+  }
+
+  std::vector<std::pair<td::int64, td::int32>> elements;
+  for (auto &it : map) {
+    elements.emplace_back(it.first, it.second);
+  }
+  std::sort(elements.begin(), elements.end());
+  std::vector<std::pair<td::int64, td::int32>> expected_elements(expected.begin(), expected.end());
+  std::sort(expected_elements.begin(), expected_elements.end());
+  ASSERT_TRUE(elements == expected_elements);
+
+  map.clear();
+  ASSERT_TRUE(map.empty());
+  ASSERT_TRUE(map.begin() == map.end());
+}
+
+TEST(FlatHashMap, random) {
+  test_flat_hash_map<td::FlatHashMap<td::int64, td::int32>>();
+  test_flat_hash_map<td::FlatHashMapNodeStable<td::int64, td::int32>>();
+}
+
+TEST(FlatHashMap, node_stable) {
+  td::FlatHashMapNodeStable<td::int32, td::string> map;
+  std::vector<td::string *> values;
+  for (td::int32 i = 1; i <= 1000; i++) {
+    auto &value = map[i];
+    value = td::to_string(i);
+    values.push_back(&value);
+  }
+  for (td::int32 i = 1; i <= 500; i++) {
+    map.erase(i * 2);
+  }
+  for (td::int32 i = 1; i <= 1000; i += 2) {
+    ASSERT_EQ(values[i - 1], &map[i]);
+    ASSERT_EQ(td::to_string(i), *values[i - 1]);
+  }
+}
+
+TEST(FlatHashSet, random) {
+  td::FlatHashSet<td::uint64> set;
+  std::unordered_set<td::uint64> expected;
+  for (int i = 0; i < 100000; i++) {
+    auto key = static_cast<td::uint64>(td::Random::fast(1, 3000));
+    if (td::Random::fast(0, 1) == 0) {
+      ASSERT_EQ(expected.insert(key).second, set.insert(key).second);
+    } else {
+      ASSERT_EQ(expected.erase(key), set.erase(key));
+    }
+    ASSERT_EQ(expected.size(), set.size());
+  }
+  size_t count = 0;
+  for (auto key : set) {
+    ASSERT_EQ(1u, expected.count(key));
+    count++;
+  }
+  ASSERT_EQ(expected.size(), count);
+}
@@ -0,0 +1,70 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2018
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/utils/common.h"
+#include "td/utils/logging.h"
+#include "td/utils/MpscPollableQueue.h"
+#include "td/utils/port/thread.h"
+#include "td/utils/tests.h"
+
+#if !TD_EVENTFD_UNSUPPORTED && !TD_WINDOWS && !TD_THREAD_UNSUPPORTED
+template <class QueueT>
+static void test_mpsc_pollable_queue() {
+  QueueT queue;
+  queue.init();
+
+  int threads_n = 8;
+  int queries_n = 100000;
+  std::vector<td::thread> threads(threads_n);
+  for (int id = 0; id < threads_n; id++) {
+    threads[id] = td::thread([&, id] {
+      std::vector<int> batch;
+      for (int i = 0; i < queries_n; i++) {
+        if (id % 2 == 0) {
+          queue.writer_put(i * threads_n + id);
+        } else {
+          batch.push_back(i * threads_n + id);
+          if (batch.size() == 7 || i + 1 == queries_n) {
+            queue.writer_put_batch(batch);
+            batch.clear();
+          }
+        }
+        queue.writer_flush();
+      }
+    });
+  }
+
+  std::vector<int> next_value(threads_n);
+  int left = threads_n * queries_n;
+  while (left > 0) {
+    int cnt = queue.reader_wait();
+    CHECK(cnt > 0);
+    left -= cnt;
+    CHECK(left >= 0);
+    while (cnt-- > 0) {
+      auto x = queue.reader_get_unsafe();
+      auto thread_id = x % threads_n;
+      CHECK(next_value[thread_id] == x / threads_n);
+      next_value[thread_id]++;
+    }
+    queue.reader_flush();
+  }
+  CHECK(queue.reader_wait_nonblock() == 0);
+
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  queue.destroy();
+}
+
+TEST(MpscPollableQueue, multi_thread) {
+  test_mpsc_pollable_queue<td::MpscPollableQueue<int>>();
+}
+
+TEST(MpscPollableLinkQueue, multi_thread) {
+  test_mpsc_pollable_queue<td::MpscPollableLinkQueue<int>>();
+}
+#endif
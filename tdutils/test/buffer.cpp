@@ -0,0 +1,109 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2018
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/utils/buffer.h"
+#include "td/utils/common.h"
+#include "td/utils/filesystem.h"
+#include "td/utils/logging.h"
+#include "td/utils/port/Fd.h"
+#include "td/utils/port/FileFd.h"
+#include "td/utils/port/path.h"
+#include "td/utils/port/thread.h"
+#include "td/utils/Random.h"
+#include "td/utils/tests.h"
+
+static td::string make_data(size_t size, int seed) {
+  td::string data(size, '\0');
+  for (size_t i = 0; i < size; i++) {
+    data[i] = static_cast<char>((i * 7 + seed) & 255);
+  }
+  return data;
+}
+
+#if !TD_THREAD_UNSUPPORTED
+TEST(Buffer, cross_thread_free) {
+  auto start_mem = td::BufferAllocator::get_buffer_mem();
+  for (int iteration = 0; iteration < 3; iteration++) {
+    std::vector<td::ChainBufferReader> readers;
+    std::vector<td::BufferSlice> slices;
+    std::vector<td::string> expected;
+    td::thread producer([&] {
+      for (int i = 0; i < 200; i++) {
+        td::ChainBufferWriter writer;
+        auto reader = writer.extract_reader();
+        auto data = make_data(td::Random::fast(1, 1 << 17), i);
+        size_t pos = 0;
+        while (pos < data.size()) {
+          auto chunk_size = std::min(static_cast<size_t>(td::Random::fast(1, 5000)), data.size() - pos);
+          if (i % 2 == 0) {
+            writer.append(td::Slice(data).substr(pos, chunk_size));
+          } else {
+            writer.append(td::BufferSlice(td::Slice(data).substr(pos, chunk_size)));
+          }
+          pos += chunk_size;
+        }
+        reader.sync_with_writer();
+        readers.push_back(std::move(reader));
+        slices.push_back(td::BufferSlice(data));
+        expected.push_back(std::move(data));
+      }
+    });
+    producer.join();
+
+    td::thread consumer([&] {
+      for (size_t i = 0; i < readers.size(); i++) {
+        ASSERT_EQ(expected[i], readers[i].move_as_buffer_slice().as_slice().str());
+        ASSERT_EQ(expected[i], slices[i].as_slice().str());
+      }
+      readers.clear();
+      slices.clear();
+    });
+    consumer.join();
+  }
+  ASSERT_EQ(start_mem, td::BufferAllocator::get_buffer_mem());
+  ASSERT_TRUE(td::BufferAllocator::get_buffer_pool_mem() > 0);
+}
+#endif
+
+TEST(Buffer, prepare_readv) {
+  td::ChainBufferWriter writer;
+  auto reader = writer.extract_reader();
+  td::string expected;
+  for (int i = 0; i < 40; i++) {
+    auto data = make_data(td::Random::fast(1, 3000), i);
+    if (i % 3 == 0) {
+      writer.append(td::Slice(data));
+    } else {
+      writer.append(td::BufferSlice(data));
+    }
+    expected += data;
+  }
+  reader.sync_with_writer();
+
+  td::CSlice file_name = "prepare_readv.txt";
+  td::unlink(file_name).ignore();
+  auto file = td::FileFd::open(file_name, td::FileFd::Write | td::FileFd::Create).move_as_ok();
+  size_t total_slice_count = 0;
+  while (!reader.empty()) {
+    td::Slice slices[td::Fd::MAX_IO_SLICES];
+    auto slice_count = reader.prepare_readv(slices, td::Fd::MAX_IO_SLICES);
+    ASSERT_TRUE(slice_count > 0);
+    size_t slices_size = 0;
+    for (size_t i = 0; i < slice_count; i++) {
+      ASSERT_TRUE(!slices[i].empty());
+      slices_size += slices[i].size();
+    }
+    ASSERT_TRUE(slices_size <= reader.size());
+    total_slice_count += slice_count;
+    auto written = file.writev(slices, slice_count).move_as_ok();
+    ASSERT_EQ(slices_size, written);
+    reader.advance(written);
+  }
+  ASSERT_TRUE(total_slice_count > td::Fd::MAX_IO_SLICES);
+  file.close();
+  ASSERT_EQ(expected, td::read_file(file_name).move_as_ok().as_slice().str());
+  td::unlink(file_name).ignore();
+}
@@ -7,6 +7,7 @@
 #include "td/utils/base64.h"
 #include "td/utils/common.h"
 #include "td/utils/crypto.h"
+#include "td/utils/Random.h"
 #include "td/utils/Slice.h"
 #include "td/utils/tests.h"
 
@@ -61,6 +62,80 @@ TEST(Crypto, AesCtrState) {
   }
 }
 
+TEST(Crypto, aes_ige) {
+  td::vector<td::uint32> answers{0u,          2045698207u, 2423540300u, 4044029876u, 3897028079u,
+                                 4182604567u, 3630667437u, 3877562567u, 2594994308u};
+  td::vector<td::uint32> iv_answers{3572235416u, 1698301573u, 1847779105u, 3377071627u, 2321498546u,
+                                    775488800u,  162200855u,  716189660u,  3451774456u};
+
+  std::size_t i = 0;
+  for (auto length : {0, 16, 32, 48, 64, 80, 9984, 160000, 1000000}) {
+    td::uint32 seed = length;
+    td::string s(length, '\0');
+    for (auto &c : s) {
+      seed = seed * 123457567u + 987651241u;
+      c = static_cast<char>((seed >> 23) & 255);
+    }
+
+    td::UInt256 key;
+    for (auto &c : key.raw) {
+      seed = seed * 123457567u + 987651241u;
+      c = (seed >> 23) & 255;
+    }
+    td::UInt256 iv;
+    for (auto &c : iv.raw) {
+      seed = seed * 123457567u + 987651241u;
+      c = (seed >> 23) & 255;
+    }
+
+    td::string t(length, '\0');
+    td::UInt256 encrypt_iv = iv;
+    td::aes_ige_encrypt(key, &encrypt_iv, s, t);
+    ASSERT_EQ(answers[i], td::crc32(t));
+    ASSERT_EQ(iv_answers[i], td::crc32(td::Slice(encrypt_iv.raw, sizeof(encrypt_iv.raw))));
+
+    td::UInt256 decrypt_iv = iv;
+    td::aes_ige_decrypt(key, &decrypt_iv, t, t);
+    ASSERT_STREQ(s, t);
+    ASSERT_TRUE(decrypt_iv == encrypt_iv);
+
+    i++;
+  }
+
+  for (int test = 0; test < 100; test++) {
+    auto task_count = td::Random::fast(0, 20);
+    td::vector<td::UInt256> keys(task_count);
+    td::vector<td::UInt256> ivs(task_count);
+    td::vector<td::string> inputs(task_count);
+    td::vector<td::string> outputs(task_count);
+    td::vector<td::AesIgeTask> tasks;
+    for (int j = 0; j < task_count; j++) {
+      td::Random::secure_bytes(keys[j].raw, sizeof(keys[j].raw));
+      td::Random::secure_bytes(ivs[j].raw, sizeof(ivs[j].raw));
+      inputs[j] = td::rand_string('a', 'z', 16 * td::Random::fast(0, 20));
+      outputs[j] = td::string(inputs[j].size(), '\0');
+      tasks.push_back(td::AesIgeTask{&keys[j], &ivs[j], inputs[j], outputs[j]});
+    }
+    auto expected_ivs = ivs;
+    auto encrypt_flag = td::Random::fast(0, 1) == 1;
+    if (encrypt_flag) {
+      td::aes_ige_encrypt_batch(tasks.data(), tasks.size());
+    } else {
+      td::aes_ige_decrypt_batch(tasks.data(), tasks.size());
+    }
+    for (int j = 0; j < task_count; j++) {
+      td::string expected(inputs[j].size(), '\0');
+      if (encrypt_flag) {
+        td::aes_ige_encrypt(keys[j], &expected_ivs[j], inputs[j], expected);
+      } else {
+        td::aes_ige_decrypt(keys[j], &expected_ivs[j], inputs[j], expected);
+      }
+      ASSERT_STREQ(expected, outputs[j]);
+      ASSERT_TRUE(expected_ivs[j] == ivs[j]);
+    }
+  }
+}
+
 TEST(Crypto, Sha256State) {
   for (auto length : {0, 1, 31, 32, 33, 9999, 10000, 10001, 999999, 1000001}) {
     auto s = td::rand_string(std::numeric_limits<char>::min(), std::numeric_limits<char>::max(), length);
@@ -135,6 +210,33 @@ TEST(Crypto, sha256) {
   }
 }
 
+TEST(Crypto, sha256_batch) {
+  for (int test = 0; test < 1000; test++) {
+    auto count = td::Random::fast(0, 5);
+    td::vector<td::string> inputs;
+    td::vector<td::string> outputs(count, td::string(32, '\0'));
+    td::vector<td::Slice> data;
+    td::vector<td::MutableSlice> output;
+    for (int i = 0; i < count; i++) {
+      inputs.push_back(td::rand_string(std::numeric_limits<char>::min(), std::numeric_limits<char>::max(),
+                                       td::Random::fast(0, 300)));
+    }
+    for (int i = 0; i < count; i++) {
+      data.push_back(inputs[i]);
+      output.push_back(outputs[i]);
+    }
+    td::sha256_batch(data.data(), output.data(), count);
+    for (int i = 0; i < count; i++) {
+      td::string expected(32, '\0');
+      td::Sha256State state;
+      td::sha256_init(&state);
+      td::sha256_update(inputs[i], &state);
+      td::sha256_final(&state, expected);
+      ASSERT_STREQ(expected, outputs[i]);
+    }
+  }
+}
+
 TEST(Crypto, md5) {
   td::vector<td::Slice> answers{
       "1B2M2Y8AsgTpgAmY7PhCfg==", "xMpCOKC5I4INzFCab3WEmw==", "vwBninYbDRkgk+uA7GMiIQ==", "dwfWrk4CfHDuoqk1wilvIQ=="};
@@ -157,6 +259,14 @@ TEST(Crypto, crc32) {
 }
 #endif
 
+TEST(Crypto, crc32c) {
+  td::vector<td::uint32> answers{0u, 2432014819u, 1077264849u, 1131405888u};
+
+  for (std::size_t i = 0; i < strings.size(); i++) {
+    ASSERT_EQ(answers[i], td::crc32c(strings[i]));
+  }
+}
+
 TEST(Crypto, crc64) {
   td::vector<td::uint64> answers{0ull, 3039664240384658157ull, 17549519902062861804ull, 8794730974279819706ull};
 
@@ -164,3 +274,30 @@ TEST(Crypto, crc64) {
     ASSERT_EQ(answers[i], td::crc64(strings[i]));
   }
 }
+
+template <class T>
+static T naive_crc(td::Slice data, T reflected_poly) {
+  T crc = static_cast<T>(-1);
+  for (auto c : data) {
+    crc ^= static_cast<unsigned char>(c);
+    for (int i = 0; i < 8; i++) {
+      crc = (crc >> 1) ^ (reflected_poly & (0 - (crc & 1)));
+    }
+  }
+  return crc ^ static_cast<T>(-1);
+}
+
+TEST(Crypto, crc_lengths) {
+  td::string data(5000, '\0');
+  td::Random::secure_bytes(data);
+  for (std::size_t offset = 0; offset < 16; offset++) {
+    for (std::size_t length = 0; offset + length <= 4096; length += length < 300 ? 1 : 97) {
+      td::Slice slice(data.data() + offset, length);
+#if TD_HAVE_ZLIB
+      ASSERT_EQ(naive_crc<td::uint32>(slice, 0xedb88320u), td::crc32(slice));
+#endif
+      ASSERT_EQ(naive_crc<td::uint32>(slice, 0x82f63b78u), td::crc32c(slice));
+      ASSERT_EQ(naive_crc<td::uint64>(slice, 0xc96c5795d7870f42ull), td::crc64(slice));
+    }
+  }
+}
@@ -9,6 +9,7 @@
 #include "td/utils/Gzip.h"
 #include "td/utils/GzipByteFlow.h"
 #include "td/utils/logging.h"
+#include "td/utils/Random.h"
 #include "td/utils/Status.h"
 #include "td/utils/tests.h"
 
@@ -35,6 +36,44 @@ TEST(Gzip, gzencode_gzdecode) {
   encode_decode(str);
 }
 
+TEST(Gzip, reuse) {
+  for (int i = 0; i < 100; i++) {
+    auto str = td::rand_string('a', 'c', td::Random::fast(0, 100000));
+    encode_decode(str);
+
+    // a broken input must not affect subsequent calls
+    auto zip = td::gzencode(str + "a").as_slice().str();
+    zip.resize(zip.size() / 2);
+    ASSERT_TRUE(td::gzdecode(zip).empty());
+  }
+
+  td::Gzip gzip;
+  for (auto mode : {td::Gzip::Encode, td::Gzip::Encode, td::Gzip::Decode, td::Gzip::Encode, td::Gzip::Decode}) {
+    gzip.init(mode).ensure();
+    gzip.init(td::Gzip::Empty).ensure();
+  }
+  td::Gzip other = std::move(gzip);
+  other.init_decode().ensure();
+  gzip = std::move(other);
+}
+
+TEST(Gzip, forged_size) {
+  auto str = td::rand_string('a', 'z', 100000);
+  auto zip = td::gzencode(str).as_slice().str();
+  for (auto size : {0u, 1u, 100u, 99999u, 100001u, 1000000000u, 0xFFFFFFFFu}) {
+    auto forged_zip = zip;
+    for (int i = 0; i < 4; i++) {
+      forged_zip[forged_zip.size() - 4 + i] = static_cast<char>((size >> (8 * i)) & 255);
+    }
+    ASSERT_TRUE(td::gzdecode(forged_zip).empty());
+
+    // truncated stream with a trailer claiming a huge size
+    auto truncated_zip = zip.substr(0, zip.size() / 2) + forged_zip.substr(forged_zip.size() - 4);
+    ASSERT_TRUE(td::gzdecode(truncated_zip).empty());
+  }
+  ASSERT_EQ(str, td::gzdecode(zip).as_slice().str());
+}
+
 TEST(Gzip, flow) {
   auto str = td::rand_string('a', 'z', 1000000);
   auto parts = td::rand_split(str);
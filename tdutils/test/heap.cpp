@@ -10,6 +10,7 @@
 #include "td/utils/Heap.h"
 #include "td/utils/logging.h"
 #include "td/utils/Random.h"
+#include "td/utils/TimerWheel.h"
 
 #include <algorithm>
 #include <cstdio>
@@ -176,3 +177,51 @@ TEST(Heap, random_events) {
     // heap.check();
   }
 }
+
+TEST(Heap, timer_wheel_random_events) {
+  struct Node : public HeapNode {
+    int64 key = 0;
+  };
+  for (int64 max_timeout : {100ll, 10000ll, 10000000ll, 100000000000ll}) {
+    int n = 1000;
+    vector<Node> nodes(n);
+    std::set<std::pair<int64, int>> set_heap;
+    TimerWheel wheel(1.0);
+    int64 now = Random::fast(0, 1000000);
+    for (int i = 0; i < 100000; i++) {
+      int x = Random::fast(0, 9);
+      if (x < 6) {
+        int id = Random::fast(0, n - 1);
+        auto &node = nodes[id];
+        int64 key = now - 10 + static_cast<int64>(Random::fast_uint32()) * 1000 % max_timeout;
+        if (node.in_heap()) {
+          set_heap.erase(std::make_pair(node.key, id));
+          wheel.fix(static_cast<double>(key), &node);
+        } else {
+          wheel.insert(static_cast<double>(key), &node);
+        }
+        node.key = key;
+        set_heap.emplace(key, id);
+      } else if (x < 8) {
+        int id = Random::fast(0, n - 1);
+        auto &node = nodes[id];
+        if (node.in_heap()) {
+          set_heap.erase(std::make_pair(node.key, id));
+          wheel.erase(&node);
+        }
+      } else {
+        now += static_cast<int64>(Random::fast_uint32()) % (max_timeout / 10 + 1);
+        while (auto *heap_node = wheel.pop_expired(static_cast<double>(now))) {
+          auto *node = static_cast<Node *>(heap_node);
+          ASSERT_TRUE(node->key <= now);
+          ASSERT_TRUE(set_heap.erase(std::make_pair(node->key, static_cast<int>(node - &nodes[0]))) == 1);
+        }
+        ASSERT_TRUE(set_heap.empty() || set_heap.begin()->first > now);
+      }
+      ASSERT_EQ(set_heap.size(), wheel.size());
+      if (!set_heap.empty()) {
+        ASSERT_TRUE(wheel.next_key() <= static_cast<double>(std::max(set_heap.begin()->first, now)));
+      }
+    }
+  }
+}
@@ -84,3 +84,113 @@ TEST(JSON, kphp) {
       "{\"keyboard\":[[\"\\u2022 abcdefg\"],[\"\\u2022 hijklmnop\"],[\"\\u2022 "
       "qrstuvwxyz\"]],\"one_time_keyboard\":true}");
 }
+
+TEST(JSON, pull_parser) {
+  string str = " {\"a\" : [1, \"\\u0431\", true, null, {}],\"b\":{\"c\":-1.5e3} , \"d\\u0020e\":\"f\"}";
+  {
+    JsonPullParser parser(str);
+    ASSERT_TRUE(parser.peek_type() == JsonValue::Type::Object);
+    ASSERT_EQ("\"f\"", parser.find_object_field("d e").ok().str());
+    ASSERT_EQ("{\"c\":-1.5e3}", parser.find_object_field("b").ok().str());
+    ASSERT_TRUE(parser.find_object_field("c").ok().empty());
+
+    parser.enter_object().ensure();
+    MutableSlice name;
+    ASSERT_TRUE(parser.next_field(name).ok());
+    ASSERT_EQ("a", name);
+    parser.enter_array().ensure();
+    ASSERT_TRUE(parser.next_element().ok());
+    ASSERT_EQ("1", parser.read_number().ok());
+    ASSERT_TRUE(parser.next_element().ok());
+    ASSERT_EQ("\xd0\xb1", parser.read_string().ok());
+    ASSERT_TRUE(parser.next_element().ok());
+    ASSERT_EQ(true, parser.read_boolean().ok());
+    ASSERT_TRUE(parser.next_element().ok());
+    ASSERT_TRUE(parser.peek_type() == JsonValue::Type::Null);
+    parser.read_null().ensure();
+    ASSERT_TRUE(parser.next_element().ok());
+    parser.skip_value().ensure();
+    ASSERT_TRUE(!parser.next_element().ok());
+    ASSERT_TRUE(parser.next_field(name).ok());
+    ASSERT_EQ("b", name);
+    ASSERT_EQ("{\"c\":-1.5e3}", json_encode<string>(parser.read_value().ok()));
+    ASSERT_TRUE(parser.next_field(name).ok());
+    ASSERT_EQ("d e", name);
+    ASSERT_EQ("f", parser.read_string().ok());
+    ASSERT_TRUE(!parser.next_field(name).ok());
+    parser.finish().ensure();
+  }
+
+  auto skip_all = [](string str) {
+    JsonPullParser parser(str);
+    TRY_STATUS(parser.skip_value());
+    return parser.finish();
+  };
+  auto read_all = [](string str) {
+    JsonPullParser parser(str);
+    TRY_STATUS(parser.enter_array());
+    while (true) {
+      TRY_RESULT(has_element, parser.next_element());
+      if (!has_element) {
+        break;
+      }
+      TRY_STATUS(parser.skip_value());
+    }
+    return parser.finish();
+  };
+  for (auto bad_str : {"[1,]", "[1 2]", "[1,2", "[1]]", "[nul]"}) {
+    ASSERT_TRUE(skip_all(bad_str).is_error());
+    ASSERT_TRUE(read_all(bad_str).is_error());
+  }
+  for (auto good_str : {"[]", "[ ]", "[1,{}]", "[[],\"\"]"}) {
+    ASSERT_TRUE(skip_all(good_str).is_ok());
+    ASSERT_TRUE(read_all(good_str).is_ok());
+  }
+
+  string deep_str = string(200, '[') + string(200, ']');
+  JsonPullParser parser(deep_str);
+  Status status;
+  for (int i = 0; i < 200 && status.is_ok(); i++) {
+    status = parser.enter_array();
+  }
+  ASSERT_TRUE(status.is_error());
+}
+
+TEST(JSON, pull_parser_find_object_type) {
+  string str = "{\"a\":{\"b\":[{\"x\":1,\"@type\":\"c\"},{}],\"@type\":\"d\"},\"@type\" : \"e\",\"f\":{\"@type\":1}}";
+  JsonPullParser parser(str);
+  ASSERT_EQ("\"e\"", parser.find_object_type().ok().str());
+  parser.enter_object().ensure();
+  MutableSlice name;
+  ASSERT_TRUE(parser.next_field(name).ok());
+  ASSERT_EQ("a", name);
+  ASSERT_EQ("\"d\"", parser.find_object_type().ok().str());
+  parser.enter_object().ensure();
+  ASSERT_TRUE(parser.next_field(name).ok());
+  ASSERT_EQ("b", name);
+  parser.enter_array().ensure();
+  ASSERT_TRUE(parser.next_element().ok());
+  ASSERT_EQ("\"c\"", parser.find_object_type().ok().str());
+  parser.skip_value().ensure();
+  ASSERT_TRUE(parser.next_element().ok());
+  ASSERT_TRUE(parser.find_object_type().ok().empty());
+  parser.skip_value().ensure();
+  ASSERT_TRUE(!parser.next_element().ok());
+  ASSERT_TRUE(parser.next_field(name).ok());
+  ASSERT_EQ("@type", name);
+  ASSERT_EQ("d", parser.read_string().ok());
+  ASSERT_TRUE(!parser.next_field(name).ok());
+  ASSERT_TRUE(parser.next_field(name).ok());
+  ASSERT_EQ("@type", name);
+  ASSERT_EQ("e", parser.read_string().ok());
+  ASSERT_TRUE(parser.next_field(name).ok());
+  ASSERT_EQ("f", name);
+  ASSERT_EQ("1", parser.find_object_type().ok().str());
+  parser.skip_value().ensure();
+  ASSERT_TRUE(!parser.next_field(name).ok());
+  parser.finish().ensure();
+
+  string deep_str = "{\"a\":{\"b\":{\"c\":{}}},\"@type\":1}";
+  ASSERT_TRUE(JsonPullParser(deep_str, 2).find_object_type().is_error());
+  ASSERT_EQ("1", JsonPullParser(deep_str, 3).find_object_type().ok().str());
+}
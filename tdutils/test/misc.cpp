@@ -4,7 +4,10 @@
 // Distributed under the Boost Software License, Version 1.0. (See accompanying
 // file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 //
+#include "td/utils/Arena.h"
 #include "td/utils/base64.h"
+#include "td/utils/buffer.h"
+#include "td/utils/Hints.h"
 #include "td/utils/logging.h"
 #include "td/utils/misc.h"
 #include "td/utils/port/EventFd.h"
@@ -15,9 +18,16 @@
 #include "td/utils/port/thread.h"
 #include "td/utils/Random.h"
 #include "td/utils/tests.h"
+#include "td/utils/tl_parsers.h"
+#include "td/utils/tl_storers.h"
+#include "td/utils/utf8.h"
 
+#include <algorithm>
 #include <atomic>
+#include <cstdint>
+#include <cstring>
 #include <limits>
+#include <map>
 
 using namespace td;
 
@@ -163,3 +173,289 @@ TEST(Misc, to_integer) {
   ASSERT_EQ(to_integer_safe<uint64>("12345678910111213").ok(), 12345678910111213ull);
   ASSERT_TRUE(to_integer_safe<uint64>("-12345678910111213").is_error());
 }
+
+TEST(Misc, to_string) {
+  ASSERT_EQ("0", to_string(0));
+  ASSERT_EQ("-1234567", to_string(-1234567));
+  ASSERT_EQ("-2147483648", to_string(std::numeric_limits<int32>::min()));
+  ASSERT_EQ("4294967295", to_string(std::numeric_limits<uint32>::max()));
+  ASSERT_EQ("-9223372036854775808", to_string(std::numeric_limits<int64>::min()));
+  ASSERT_EQ("9223372036854775807", to_string(std::numeric_limits<int64>::max()));
+  ASSERT_EQ("18446744073709551615", to_string(std::numeric_limits<uint64>::max()));
+  for (int i = 0; i < 1000; i++) {
+    auto x = static_cast<int64>(Random::fast_uint64()) >> Random::fast(0, 63);
+    ASSERT_EQ(x, to_integer<int64>(to_string(x)));
+  }
+}
+
+TEST(Misc, arena) {
+  auto base_mem = Arena::get_arena_mem();
+  auto heap_ptr = Arena::allocate(10);
+  std::vector<void *> ptrs;
+  {
+    Arena::Guard guard;
+    for (int i = 0; i < 10000; i++) {
+      auto size = static_cast<size_t>(Random::fast(1, 1000));
+      auto ptr = Arena::allocate(size);
+      ASSERT_EQ(0u, reinterpret_cast<std::uintptr_t>(ptr) % 16);
+      std::memset(ptr, i & 255, size);
+      ptrs.push_back(ptr);
+    }
+    {
+      Arena::Guard nested_guard;
+      Arena::deallocate(Arena::allocate(1000));
+    }
+    Arena::deallocate(ptrs.back());
+    ptrs.pop_back();
+  }
+  ASSERT_TRUE(Arena::get_arena_mem() > base_mem);
+  Arena::deallocate(heap_ptr);
+
+  // the last object can be deallocated in another thread
+  auto last_ptr = ptrs.back();
+  ptrs.pop_back();
+  for (auto ptr : ptrs) {
+    Arena::deallocate(ptr);
+  }
+  ASSERT_TRUE(Arena::get_arena_mem() > base_mem);
+#if !TD_THREAD_UNSUPPORTED
+  thread([last_ptr] { Arena::deallocate(last_ptr); }).join();
+#else
+  Arena::deallocate(last_ptr);
+#endif
+  ASSERT_EQ(base_mem, Arena::get_arena_mem());
+}
+
+TEST(Misc, tl_parser_in_place) {
+  string long_string(300, 'a');
+  auto store = [&](auto &storer) {
+    storer.store_int(5);
+    storer.store_long(7);
+    storer.store_string(Slice(long_string));
+    storer.store_string(Slice("abc"));
+  };
+  TlStorerCalcLength calc_length;
+  store(calc_length);
+  BufferSlice packet(calc_length.get_length());
+  TlStorerUnsafe storer(packet.as_slice().begin());
+  store(storer);
+
+  for (size_t offset = 0; offset < 4; offset++) {
+    string unaligned(offset + packet.size(), '\0');
+    auto data = MutableSlice(unaligned).substr(offset);
+    data.copy_from(packet.as_slice());
+
+    TlParser parser(data);
+    ASSERT_EQ(5, parser.fetch_int());
+    ASSERT_EQ(7, parser.fetch_long());
+    auto long_string_slice = parser.fetch_string<Slice>();
+    ASSERT_EQ(long_string, long_string_slice.str());
+    ASSERT_TRUE(long_string_slice.begin() >= data.begin() && long_string_slice.end() <= data.end());
+    ASSERT_EQ("abc", parser.fetch_string<string>());
+    parser.fetch_end();
+    ASSERT_TRUE(parser.get_error() == nullptr);
+  }
+
+  TlBufferParser parser(&packet);
+  parser.fetch_int();
+  parser.fetch_long();
+  auto long_string_buffer = parser.fetch_string<BufferSlice>();
+  ASSERT_EQ(long_string, long_string_buffer.as_slice().str());
+  ASSERT_TRUE(long_string_buffer.as_slice().begin() >= packet.as_slice().begin() &&
+              long_string_buffer.as_slice().end() <= packet.as_slice().end());
+  ASSERT_EQ("abc", parser.fetch_string<BufferSlice>().as_slice().str());
+  parser.fetch_end();
+  ASSERT_TRUE(parser.get_error() == nullptr);
+}
+
+TEST(Misc, tl_storer_to_buffer_slice) {
+  string long_string(1000, 'a');
+  auto store = [&](auto &storer) {
+    for (int i = 0; i < 10; i++) {
+      storer.store_int(i);
+      storer.store_long(-i);
+      storer.store_string(Slice(long_string).substr(i * 50));
+      storer.store_string(Slice("abc"));
+    }
+  };
+  TlStorerCalcLength calc_length;
+  store(calc_length);
+  BufferSlice expected(calc_length.get_length());
+  TlStorerUnsafe storer(expected.as_slice().begin());
+  store(storer);
+
+  for (size_t capacity_hint :
+       {static_cast<size_t>(0), static_cast<size_t>(100), expected.size(), 2 * expected.size()}) {
+    TlStorerToBufferSlice buffer_storer(capacity_hint);
+    store(buffer_storer);
+    ASSERT_EQ(expected.size(), buffer_storer.get_length());
+    auto result = buffer_storer.move_as_buffer_slice();
+    ASSERT_EQ(expected.as_slice(), result.as_slice());
+  }
+}
+
+static bool check_utf8_naive(Slice str) {
+  size_t i = 0;
+  while (i < str.size()) {
+    uint32 c = static_cast<unsigned char>(str[i++]);
+    if (c < 0x80) {
+      continue;
+    }
+    size_t length;
+    uint32 min_code;
+    if ((c & 0xE0) == 0xC0) {
+      length = 1;
+      min_code = 0x80;
+      c &= 0x1F;
+    } else if ((c & 0xF0) == 0xE0) {
+      length = 2;
+      min_code = 0x800;
+      c &= 0x0F;
+    } else if ((c & 0xF8) == 0xF0) {
+      length = 3;
+      min_code = 0x10000;
+      c &= 0x07;
+    } else {
+      return false;
+    }
+    for (; length > 0; length--) {
+      if (i == str.size() || (static_cast<unsigned char>(str[i]) & 0xC0) != 0x80) {
+        return false;
+      }
+      c = (c << 6) | (static_cast<unsigned char>(str[i++]) & 0x3F);
+    }
+    if (c < min_code || c > 0x10FFFF || (0xD800 <= c && c <= 0xDFFF)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+TEST(Misc, utf8) {
+  const uint32 max_codes[] = {0x7F, 0x7FF, 0xFFFF, 0x10FFFF};
+  for (int test = 0; test < 10000; test++) {
+    string str;
+    size_t length = 0;
+    size_t utf16_length = 0;
+    auto max_code = max_codes[Random::fast(0, 3)];
+    auto char_count = Random::fast(0, 200);
+    for (int i = 0; i < char_count; i++) {
+      auto code = static_cast<uint32>(Random::fast(0, static_cast<int>(max_code)));
+      if (0xD800 <= code && code <= 0xDFFF) {
+        continue;
+      }
+      append_utf8_character(str, code);
+      length++;
+      utf16_length += code > 0xFFFF ? 2 : 1;
+    }
+    ASSERT_TRUE(check_utf8(str));
+    ASSERT_EQ(length, utf8_length(str));
+    ASSERT_EQ(utf16_length, utf8_utf16_length(str));
+
+    if (!str.empty()) {
+      auto mutation_count = Random::fast(1, 3);
+      for (int i = 0; i < mutation_count; i++) {
+        str[Random::fast(0, static_cast<int>(str.size()) - 1)] = static_cast<char>(Random::fast(0, 255));
+      }
+      ASSERT_EQ(check_utf8_naive(str), check_utf8(str));
+    }
+  }
+
+  for (auto str : {"\xC0\x80", "\xED\xA0\x80", "\xF4\x90\x80\x80", "\xE0\x9F\xBF", "\xF0\x8F\xBF\xBF", "\x80"}) {
+    string long_str = string(40, 'a') + str + string(40, 'a');
+    ASSERT_TRUE(!check_utf8(CSlice(str)));
+    ASSERT_TRUE(!check_utf8(long_str));
+    if (std::strlen(str) > 1) {
+      ASSERT_TRUE(!check_utf8(long_str.substr(0, 40 + std::strlen(str) - 1)));
+    }
+  }
+}
+
+TEST(Misc, hints) {
+  auto get_random_string = [] {
+    string str;
+    auto word_count = Random::fast(0, 3);
+    for (int i = 0; i < word_count; i++) {
+      if (i != 0) {
+        str += Random::fast(0, 1) ? ' ' : '-';
+      }
+      auto length = Random::fast(1, 4);
+      for (int j = 0; j < length; j++) {
+        str += static_cast<char>((Random::fast(0, 3) == 0 ? 'A' : 'a') + Random::fast(0, 2));
+      }
+    }
+    return str;
+  };
+
+  for (int test = 0; test < 30; test++) {
+    Hints hints;
+    std::map<int64, std::pair<string, vector<string>>> names;
+    std::map<int64, int64> ratings;
+    auto max_key = Random::fast(1, test < 20 ? 100 : 3000);
+    auto add = [&](int64 key, string name) {
+      hints.add(key, name);
+      if (name.empty()) {
+        names.erase(key);
+        ratings.erase(key);
+      } else {
+        auto words = detail::get_hints_words(name);
+        names[key] = {std::move(name), std::move(words)};
+      }
+    };
+    for (int64 key = -max_key; key <= max_key; key++) {
+      add(key, get_random_string());
+    }
+
+    for (int i = 0; i < 2000; i++) {
+      auto key = static_cast<int64>(Random::fast(-max_key, max_key));
+      auto action = Random::fast(0, 9);
+      if (action < 3) {
+        add(key, get_random_string());
+      } else if (action == 3) {
+        hints.remove(key);
+        names.erase(key);
+        ratings.erase(key);
+      } else if (action < 6) {
+        auto rating = static_cast<int64>(Random::fast(-5, 5));
+        hints.set_rating(key, rating);
+        ratings[key] = rating;
+      } else {
+        auto query = get_random_string();
+        auto limit = Random::fast(-1, 20);
+        auto return_all_for_empty_query = Random::fast(0, 1) == 1;
+        auto query_words = detail::get_hints_words(query);
+
+        vector<std::pair<int64, int64>> expected;
+        for (auto &it : names) {
+          if (query_words.empty() && !return_all_for_empty_query) {
+            break;
+          }
+          auto &words = it.second.second;
+          auto is_matched = std::all_of(query_words.begin(), query_words.end(), [&](const string &query_word) {
+            return std::any_of(words.begin(), words.end(),
+                               [&](const string &word) { return begins_with(word, query_word); });
+          });
+          if (is_matched) {
+            expected.emplace_back(ratings.count(it.first) ? ratings[it.first] : 0, it.first);
+          }
+        }
+        std::sort(expected.begin(), expected.end());
+
+        auto result = hints.search(query, limit, return_all_for_empty_query);
+        if (limit < 0) {
+          ASSERT_EQ(names.size(), result.first);
+          ASSERT_TRUE(result.second.empty());
+          continue;
+        }
+        ASSERT_EQ(expected.size(), result.first);
+        ASSERT_EQ(std::min(expected.size(), static_cast<size_t>(limit)), result.second.size());
+        for (size_t j = 0; j < result.second.size(); j++) {
+          ASSERT_EQ(expected[j].second, result.second[j]);
+        }
+      }
+      ASSERT_EQ(names.size(), hints.size());
+      ASSERT_EQ(names.count(key) != 0, hints.has_key(key));
+      ASSERT_EQ(names.count(key) ? names[key].first : string(), hints.key_to_string(key));
+    }
+  }
+}
@@ -474,4 +474,23 @@ TEST(MessageEntities, url) {
   check_url("https://t…", {});
   check_url("👉http://ab.com/cdefgh-1IJ", {"http://ab.com/cdefgh-1IJ"});
   check_url("...👉http://ab.com/cdefgh-1IJ", {});  // TODO
+  check_url("End of sentence. telegram.org. Another one.\nhttps://t.me/abc.\n(https://t.me.) \"t.me.\" 't.me.'",
+            {"telegram.org", "https://t.me/abc", "https://t.me", "t.me", "t.me"});
+}
+
+TEST(MessageEntities, find_entities_block_boundaries) {
+  // entities must be found regardless of their position relative to vectorized 16-byte blocks
+  for (auto text : {"@mention /command@botname #hashtag telegram.org test@example.com",
+                    "Привет, @mention! /start #тег https://t.me/username. 👍 mail@example.org.",
+                    "a.b @ab /a@b #1 .. ##tag @@mention //command http://"}) {
+    auto expected = find_entities(Slice(text), false);
+    ASSERT_TRUE(!expected.empty());
+    for (size_t prefix_size = 1; prefix_size <= 40; prefix_size++) {
+      auto entities = find_entities(string(prefix_size, ' ') + text, false);
+      for (auto &entity : entities) {
+        entity.offset -= static_cast<int32>(prefix_size);
+      }
+      ASSERT_TRUE(entities == expected);
+    }
+  }
 }
@@ -9,22 +9,38 @@
 #include "td/actor/actor.h"
 #include "td/actor/PromiseFuture.h"
 
+#include "td/mtproto/AuthKey.h"
 #include "td/mtproto/crypto.h"
+#include "td/mtproto/CryptoWorkerPool.h"
 #include "td/mtproto/Handshake.h"
 #include "td/mtproto/HandshakeActor.h"
 #include "td/mtproto/HandshakeConnection.h"
 #include "td/mtproto/PingConnection.h"
 #include "td/mtproto/RawConnection.h"
+#include "td/mtproto/Transport.h"
 
 #include "td/net/Socks5.h"
 
 #include "td/telegram/ConfigManager.h"
 #include "td/telegram/net/PublicRsaKeyShared.h"
 
+#include "td/utils/buffer.h"
+#include "td/utils/crypto.h"
 #include "td/utils/logging.h"
+#include "td/utils/port/Fd.h"
 #include "td/utils/port/IPAddress.h"
+#include "td/utils/port/ServerSocketFd.h"
+#include "td/utils/port/sleep.h"
 #include "td/utils/port/SocketFd.h"
+#include "td/utils/port/thread.h"
+#include "td/utils/Random.h"
+#include "td/utils/Slice.h"
 #include "td/utils/Status.h"
+#include "td/utils/Storer.h"
+
+#include <atomic>
+#include <memory>
+#include <utility>
 
 REGISTER_TESTS(mtproto);
 
@@ -337,3 +353,305 @@ TEST(Mtproto, socks5) {
   }
   sched.finish();
 }
+
+TEST(Mtproto, crypto_worker_pool) {
+  CryptoWorkerPool pool(3);
+
+  std::vector<std::atomic<int>> calls(1000);
+  for (auto &call : calls) {
+    call = 0;
+  }
+#if !TD_THREAD_UNSUPPORTED
+  std::vector<td::thread> threads;
+  for (int i = 0; i < 3; i++) {
+    threads.push_back(td::thread([&] {
+      for (int j = 0; j < 100; j++) {
+        pool.run(calls.size(), [&](size_t job_id) { calls[job_id]++; });
+      }
+    }));
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (auto &call : calls) {
+    ASSERT_EQ(300, call.load());
+  }
+#endif
+
+  // packets encrypted in the pool must be decryptable by the other side
+  string key(256, '\0');
+  Random::secure_bytes(key);
+  AuthKey auth_key(static_cast<uint64>(Random::secure_int64()), std::move(key));
+  std::vector<string> messages;
+  std::vector<BufferWriter> packets;
+  std::vector<PacketInfo> infos;
+  for (int i = 0; i < 50; i++) {
+    string message(4 + 4 * Random::fast(0, 1000), '\0');
+    Random::secure_bytes(message);
+    as<uint32>(&message[0]) = static_cast<uint32>(message.size() - 4);
+    auto storer = create_storer(message);
+
+    PacketInfo info;
+    info.type = PacketInfo::EndToEnd;
+    info.version = 2;
+    info.is_creator = true;
+    BufferWriter packet(Transport::write_unencrypted(storer, auth_key, &info), 0, 0);
+    Transport::write_unencrypted(storer, auth_key, &info, packet.as_slice());
+    messages.push_back(std::move(message));
+    packets.push_back(std::move(packet));
+    infos.push_back(info);
+  }
+  pool.run(packets.size(),
+           [&](size_t i) { Transport::encrypt_packet(auth_key, &infos[i], packets[i].as_slice()); });
+
+  for (size_t i = 0; i < packets.size(); i++) {
+    PacketInfo info;
+    info.type = PacketInfo::EndToEnd;
+    info.version = 2;
+    info.is_creator = false;
+    MutableSlice data;
+    int32 error_code = 0;
+    Transport::read(packets[i].as_slice(), auth_key, &info, &data, &error_code).ensure();
+    ASSERT_EQ(0, error_code);
+    ASSERT_EQ(infos[i].message_ack, info.message_ack);
+    ASSERT_EQ(messages[i], data.str());
+  }
+}
+
+#if TD_PORT_POSIX
+static std::pair<SocketFd, SocketFd> create_socket_pair() {
+  ServerSocketFd server_socket_fd;
+  int port = 0;
+  while (true) {
+    port = Random::fast(20000, 60000);
+    auto r_server_socket_fd = ServerSocketFd::open(port, "127.0.0.1");
+    if (r_server_socket_fd.is_ok()) {
+      server_socket_fd = r_server_socket_fd.move_as_ok();
+      break;
+    }
+  }
+
+  IPAddress address;
+  address.init_ipv4_port("127.0.0.1", port).ensure();
+  auto client_socket_fd = SocketFd::open(address).move_as_ok();
+  while (true) {
+    server_socket_fd.get_fd().update_flags(Fd::Read);
+    auto r_socket_fd = server_socket_fd.accept();
+    if (r_socket_fd.is_ok()) {
+      return std::make_pair(std::move(client_socket_fd), r_socket_fd.move_as_ok());
+    }
+    CHECK(r_socket_fd.error().code() == -1);
+    usleep_for(1000);
+  }
+}
+
+// the server side of MTProto 2.0, which is needed to exchange encrypted packets with a RawConnection
+static string decrypt_client_packet(const AuthKey &auth_key, Slice packet, uint32 *message_ack) {
+  CHECK(packet.size() > 24 && packet.size() % 16 == 8);
+  UInt128 message_key;
+  MutableSlice(message_key.raw, sizeof(message_key.raw)).copy_from(packet.substr(8, 16));
+  UInt256 aes_key;
+  UInt256 aes_iv;
+  KDF2(auth_key.key(), message_key, 0, &aes_key, &aes_iv);
+  string decrypted(packet.size() - 24, '\0');
+  aes_ige_decrypt(aes_key, &aes_iv, packet.substr(24), decrypted);
+
+  string message_key_large(32, '\0');
+  sha256(Slice(auth_key.key()).substr(88, 32).str() + decrypted, message_key_large);
+  CHECK(Slice(message_key_large).substr(8, 16) == Slice(message_key.raw, sizeof(message_key.raw)));
+  *message_ack = as<uint32>(message_key_large.data()) | (1u << 31);
+
+  // salt and session_id are followed by the prefix and the message data
+  auto data_size = as<CryptoPrefix>(decrypted.data() + 16).message_data_length + sizeof(CryptoPrefix);
+  return decrypted.substr(16, data_size);
+}
+
+static string encrypt_server_packet(const AuthKey &auth_key, Slice data) {
+  string decrypted(16, '\0');  // salt and session_id
+  decrypted += data.str();
+  decrypted.resize((decrypted.size() + 12 + 15) / 16 * 16);
+
+  string message_key_large(32, '\0');
+  sha256(Slice(auth_key.key()).substr(88 + 8, 32).str() + decrypted, message_key_large);
+  UInt128 message_key;
+  MutableSlice(message_key.raw, sizeof(message_key.raw)).copy_from(Slice(message_key_large).substr(8, 16));
+  UInt256 aes_key;
+  UInt256 aes_iv;
+  KDF2(auth_key.key(), message_key, 8, &aes_key, &aes_iv);
+
+  string packet(24 + decrypted.size(), '\0');
+  as<uint64>(&packet[0]) = auth_key.id();
+  MutableSlice(packet).substr(8, 16).copy_from(Slice(message_key.raw, sizeof(message_key.raw)));
+  aes_ige_encrypt(aes_key, &aes_iv, decrypted, MutableSlice(packet).substr(24));
+  return packet;
+}
+
+static string create_mtproto_message(uint64 message_id) {
+  string message(sizeof(CryptoPrefix) + 4 * Random::fast(0, 100), '\0');
+  Random::secure_bytes(message);
+  auto &prefix = as<CryptoPrefix>(&message[0]);
+  prefix.message_id = message_id;
+  prefix.seq_no = 0;
+  prefix.message_data_length = static_cast<uint32>(message.size() - sizeof(CryptoPrefix));
+  return message;
+}
+
+static string create_frame(uint32 header, Slice packet = Slice()) {
+  string frame(4, '\0');
+  as<uint32>(&frame[0]) = header;
+  return frame + packet.str();
+}
+
+class RawConnectionTestCallback : public RawConnection::Callback {
+ public:
+  std::vector<string> packets;
+  std::vector<uint64> quick_ack_tokens;
+
+  Status on_raw_packet(const PacketInfo &info, BufferSlice packet) override {
+    packets.push_back(packet.as_slice().str());
+    return Status::OK();
+  }
+  Status on_quick_ack(uint64 quick_ack_token) override {
+    quick_ack_tokens.push_back(quick_ack_token);
+    return Status::OK();
+  }
+};
+
+// returns the error, with which the connection has failed
+static string test_raw_connection(const AuthKey &main_auth_key, const AuthKey &other_auth_key,
+                                  std::shared_ptr<CryptoWorkerPool> crypto_worker_pool) {
+  const int packet_count = 12;
+  const int no_crypto_packet_pos = 10;
+  const int error_packet_pos = 7;
+  auto get_auth_key = [&](int i) -> const AuthKey & { return 5 <= i && i < 8 ? other_auth_key : main_auth_key; };
+  auto get_quick_ack_token = [](int i) -> uint64 { return i % 3 == 2 ? 0 : 100 + i; };
+
+  auto socket_fds = create_socket_pair();
+  RawConnection connection(std::move(socket_fds.first), TransportType::Tcp, nullptr);
+  if (crypto_worker_pool != nullptr) {
+    connection.set_crypto_worker_pool(std::move(crypto_worker_pool));
+  }
+  auto &server_socket_fd = socket_fds.second;
+  RawConnectionTestCallback callback;
+
+  // the packets must be sent in the original order, encrypted with the right key, even if the key changes
+  // or an unencrypted packet is sent in the middle
+  std::vector<string> messages;
+  for (int i = 0; i < packet_count; i++) {
+    if (i == no_crypto_packet_pos) {
+      auto message = create_mtproto_message(0);
+      connection.send_no_crypto(create_storer(message));
+      messages.push_back(std::move(message));
+    }
+    auto message = create_mtproto_message(i + 1);
+    connection.send_crypto(create_storer(message), 1, 2, get_auth_key(i), get_quick_ack_token(i));
+    messages.push_back(std::move(message));
+  }
+  connection.get_pollable().update_flags(Fd::Read | Fd::Write);
+  connection.flush(main_auth_key, callback).ensure();
+
+  string sent;
+  size_t sent_packet_count = 0;
+  std::vector<uint32> message_acks;
+  while (sent_packet_count <= static_cast<size_t>(packet_count)) {
+    char buf[1 << 14];
+    server_socket_fd.get_fd().update_flags(Fd::Read);
+    auto read_size = server_socket_fd.read(MutableSlice(buf, sizeof(buf))).move_as_ok();
+    if (read_size == 0) {
+      usleep_for(1000);
+      continue;
+    }
+    sent += Slice(buf, read_size).str();
+
+    while (true) {
+      Slice data = sent;
+      CHECK(data.size() >= 4);
+      ASSERT_EQ(0xeeeeeeee, as<uint32>(data.begin()));
+      data.remove_prefix(4);
+      for (size_t i = 0; i < sent_packet_count; i++) {
+        data.remove_prefix(4 + (as<uint32>(data.begin()) & ~(1u << 31)));
+      }
+      if (data.size() < 4 || data.size() < 4 + (as<uint32>(data.begin()) & ~(1u << 31))) {
+        break;
+      }
+      auto header = as<uint32>(data.begin());
+      auto packet = data.substr(4, header & ~(1u << 31));
+      auto &message = messages[sent_packet_count];
+      auto pos = static_cast<int>(sent_packet_count);
+      if (pos == no_crypto_packet_pos) {
+        ASSERT_EQ(0u, header & (1u << 31));
+        ASSERT_EQ(0u, as<uint64>(packet.begin()));
+        ASSERT_EQ(message, packet.substr(8).str());
+      } else {
+        auto i = pos < no_crypto_packet_pos ? pos : pos - 1;
+        auto &auth_key = get_auth_key(i);
+        ASSERT_EQ(auth_key.id(), as<uint64>(packet.begin()));
+        uint32 message_ack = 0;
+        ASSERT_EQ(message, decrypt_client_packet(auth_key, packet, &message_ack));
+        ASSERT_EQ(get_quick_ack_token(i) != 0, (header & (1u << 31)) != 0);
+        message_acks.push_back(message_ack);
+      }
+      sent_packet_count++;
+    }
+  }
+
+  // quick acks and received packets must be handled in the original order till the first invalid packet
+  std::vector<string> replies;
+  string received;
+  for (int i = 0; i < packet_count; i++) {
+    if (get_quick_ack_token(i) != 0) {
+      received += create_frame(message_acks[i]);
+    }
+    replies.push_back(create_mtproto_message(i + 1));
+    auto packet = encrypt_server_packet(main_auth_key, replies.back());
+    if (i == error_packet_pos) {
+      as<uint64>(&packet[0]) = other_auth_key.id();
+    }
+    received += create_frame(static_cast<uint32>(packet.size()), packet);
+  }
+  Slice to_write = received;
+  while (!to_write.empty()) {
+    server_socket_fd.get_fd().update_flags(Fd::Write);
+    to_write.remove_prefix(server_socket_fd.write(to_write).move_as_ok());
+  }
+
+  Status status;
+  for (int i = 0; i < 1000 && status.is_ok(); i++) {
+    connection.get_pollable().update_flags(Fd::Read);
+    status = connection.flush(main_auth_key, callback);
+    usleep_for(1000);
+  }
+  ASSERT_TRUE(status.is_error());
+
+  replies.resize(error_packet_pos);
+  ASSERT_EQ(replies.size(), callback.packets.size());
+  for (size_t i = 0; i < replies.size(); i++) {
+    ASSERT_EQ(replies[i], callback.packets[i]);
+  }
+  std::vector<uint64> quick_ack_tokens;
+  for (int i = 0; i <= error_packet_pos; i++) {
+    if (get_quick_ack_token(i) != 0) {
+      quick_ack_tokens.push_back(get_quick_ack_token(i));
+    }
+  }
+  ASSERT_EQ(quick_ack_tokens.size(), callback.quick_ack_tokens.size());
+  for (size_t i = 0; i < quick_ack_tokens.size(); i++) {
+    ASSERT_EQ(quick_ack_tokens[i], callback.quick_ack_tokens[i]);
+  }
+
+  connection.close();
+  return status.message().str();
+}
+
+TEST(Mtproto, raw_connection_crypto_worker_pool) {
+  string main_key(256, '\0');
+  string other_key(256, '\0');
+  Random::secure_bytes(main_key);
+  Random::secure_bytes(other_key);
+  AuthKey main_auth_key(static_cast<uint64>(Random::secure_int64()), std::move(main_key));
+  AuthKey other_auth_key(static_cast<uint64>(Random::secure_int64()), std::move(other_key));
+
+  auto error = test_raw_connection(main_auth_key, other_auth_key, nullptr);
+  ASSERT_EQ(error, test_raw_connection(main_auth_key, other_auth_key, std::make_shared<CryptoWorkerPool>(3)));
+}
+#endif